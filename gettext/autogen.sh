@@ -185,6 +185,7 @@ if ! $skip_gnulib; then
     setlocale
     sh-filename
     sh-quote
+    sha1
     sigpipe
     sigprocmask
     spawn-pipe
@@ -91,6 +91,7 @@ extern int errno;
 
 #include "gettextP.h"
 #include "plural-exp.h"
+#include "stats.h"
 #ifdef _LIBC
 # include <libintl.h>
 #else
@@ -564,6 +565,8 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
 
   if (foundp != NULL && (*foundp)->counter == _nl_msg_cat_cntr)
     {
+      STATS_ADD (STATS_CACHE_HITS, 1);
+
       /* Now deal with plural.  */
       if (plural)
 	retval = plural_lookup ((*foundp)->domain, n, (*foundp)->translation,
@@ -579,6 +582,8 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
       return retval;
     }
 
+  STATS_ADD (STATS_CACHE_MISSES, 1);
+
   /* See whether this is a SUID binary or not.  */
   DETERMINE_SECURE;
 
@@ -875,6 +880,7 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
 		      newp->translation_length = retlen;
 
 		      gl_rwlock_wrlock (tree_lock);
+		      STATS_ADD (STATS_EXCLUSIVE_LOCKS, 1);
 
 		      /* Insert the entry in the search tree.  */
 		      foundp = (struct known_translation_t **)
@@ -968,10 +974,13 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 {
   struct loaded_domain *domain;
   nls_uint32 nstrings;
+  unsigned long int hval1, hval2;
   size_t act;
   char *result;
   size_t resultlen;
 
+  STATS_ADD (STATS_CATALOG_SEARCHES, 1);
+
   if (domain_file->decided <= 0)
     _nl_load_domain (domain_file, domainbinding);
 
@@ -983,7 +992,60 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
   nstrings = domain->nstrings;
 
   /* Locate the MSGID and its translation.  */
-  if (domain->hash_tab != NULL)
+  if (domain->bloom != NULL || domain->phash_tab != NULL)
+    __hash_string_pair (msgid, &hval1, &hval2);
+
+  if (domain->bloom != NULL)
+    {
+      /* Use the Bloom filter.  It rejects most strings that are not in the
+	 catalog, without any string comparison.  */
+      const nls_uint32 *block =
+	domain->bloom
+	+ (hval1 % domain->n_bloom_blocks) * (MO_BLOOM_BLOCK_BITS / 32);
+      unsigned long int step = __hash_string_bloom_step (hval2);
+      unsigned long int bit = hval2;
+      int i;
+
+      for (i = 0; i < MO_BLOOM_NBITS; i++)
+	{
+	  nls_uint32 pos = bit % MO_BLOOM_BLOCK_BITS;
+
+	  if ((W (domain->must_swap, block[pos / 32])
+	       & ((nls_uint32) 1 << (pos % 32))) == 0)
+	    return NULL;
+	  bit = (bit + step) & 0xffffffffUL;
+	}
+    }
+
+  if (domain->phash_tab != NULL)
+    {
+      /* Use the perfect hash table.  It has exactly one candidate entry
+	 for every string.  */
+      nls_uint32 disp;
+      const struct phash_entry *entry;
+      nls_uint32 nstr;
+
+      STATS_ADD (STATS_CATALOG_PROBES, 1);
+      disp = W (domain->must_swap,
+		domain->phash_buckets[hval2 % domain->n_phash_buckets]);
+      entry = &domain->phash_tab[__hash_string_slot (hval1, disp, nstrings)];
+
+      if (W (domain->must_swap, entry->hash) != hval2)
+	return NULL;
+
+      nstr = W (domain->must_swap, entry->index);
+      if (nstr < nstrings
+	  && (strcmp (msgid,
+		      domain->data + W (domain->must_swap,
+					domain->orig_tab[nstr].offset))
+	      == 0))
+	{
+	  act = nstr;
+	  goto found;
+	}
+      return NULL;
+    }
+  else if (domain->hash_tab != NULL)
     {
       /* Use the hashing table.  */
       nls_uint32 len = strlen (msgid);
@@ -996,6 +1058,7 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	  nls_uint32 nstr =
 	    W (domain->must_swap_hash_tab, domain->hash_tab[idx]);
 
+	  STATS_ADD (STATS_CATALOG_PROBES, 1);
 	  if (nstr == 0)
 	    /* Hash table entry is empty.  */
 	    return NULL;
@@ -1039,6 +1102,7 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	{
 	  int cmp_val;
 
+	  STATS_ADD (STATS_CATALOG_PROBES, 1);
 	  act = (bottom + top) / 2;
 	  cmp_val = strcmp (msgid, (domain->data
 				    + W (domain->must_swap,
@@ -1108,6 +1172,7 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	{
 	  /* We have to allocate a new conversions table.  */
 	  gl_rwlock_wrlock (domain->conversions_lock);
+	  STATS_ADD (STATS_EXCLUSIVE_LOCKS, 1);
 	  nconversions = domain->nconversions;
 
 	  /* Maybe in the meantime somebody added the translation.
@@ -1296,6 +1361,7 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	  if (__builtin_expect (convd->conv_tab == NULL, 0))
 	    {
 	      __libc_lock_lock (lock);
+	      STATS_ADD (STATS_EXCLUSIVE_LOCKS, 1);
 	      if (convd->conv_tab == NULL)
 		{
 		  convd->conv_tab =
@@ -1333,6 +1399,7 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 # endif
 
 	      __libc_lock_lock (lock);
+	      STATS_ADD (STATS_EXCLUSIVE_LOCKS, 1);
 	    not_translated_yet:
 
 	      inbuf = (const unsigned char *) result;
@@ -1456,6 +1523,8 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 		 into the table of conversions.  */
 	      *(size_t *) freemem = outbuf - freemem - sizeof (size_t);
 	      convd->conv_tab[act] = (char *) freemem;
+	      STATS_ADD (STATS_CONVERSIONS, 1);
+	      STATS_ADD (STATS_CONVERSION_BYTES, outbuf - freemem);
 	      /* Shrink freemem, but keep it aligned.  */
 	      freemem_size -= outbuf - freemem;
 	      freemem = outbuf;
@@ -1491,6 +1560,7 @@ plural_lookup (struct loaded_l10nfile *domain, unsigned long int n,
   unsigned long int index;
   const char *p;
 
+  STATS_ADD (STATS_PLURAL_EVALUATIONS, 1);
   index = plural_eval (domaindata->plural, n);
   if (index >= domaindata->nplurals)
     /* This should never happen.  It means the plural expression and the
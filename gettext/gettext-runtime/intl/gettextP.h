@@ -189,6 +189,18 @@ struct loaded_domain
   /* 1 if the hash table uses a different endianness than this machine.  */
   int must_swap_hash_tab;
 
+  /* Number of buckets of the perfect hash table, or 0 if there is none.  */
+  nls_uint32 n_phash_buckets;
+  /* Pointer to the displacement values of the buckets.  */
+  const nls_uint32 *phash_buckets;
+  /* Pointer to the perfect hash table, with nstrings entries.  */
+  const struct phash_entry *phash_tab;
+
+  /* Number of blocks of the Bloom filter, or 0 if there is none.  */
+  nls_uint32 n_bloom_blocks;
+  /* Pointer to the Bloom filter.  */
+  const nls_uint32 *bloom;
+
   /* Cache of charset conversions of the translated strings.  */
   struct converted_domain *conversions;
   size_t nconversions;
@@ -100,6 +100,22 @@ struct mo_file_header
   nls_uint32 orig_sysdep_tab_offset;
   /* Offset of table with start offsets of translated sysdep strings.  */
   nls_uint32 trans_sysdep_tab_offset;
+
+  /* The following are only used in .mo files with minor revision >= 2.  */
+
+  /* The number of buckets of the perfect hash table, or 0.  */
+  nls_uint32 n_phash_buckets;
+  /* Offset of table with the displacement value of each bucket.  */
+  nls_uint32 phash_buckets_offset;
+  /* Offset of perfect hash table, with nstrings entries.  */
+  nls_uint32 phash_tab_offset;
+
+  /* The following are only used in .mo files with minor revision >= 3.  */
+
+  /* The number of blocks of the Bloom filter, or 0.  */
+  nls_uint32 n_bloom_blocks;
+  /* Offset of the Bloom filter, an array of 32-bit words.  */
+  nls_uint32 bloom_offset;
 };
 
 /* Descriptor for static string contained in the binary .mo file.  */
@@ -145,6 +161,27 @@ struct sysdep_string
    regardless whether 'int' is 16 bit, 32 bit, or 64 bit.  */
 #define SEGMENTS_END ((nls_uint32) ~0)
 
+/* The following are only used in .mo files with minor revision >= 2.  */
+
+/* Entry of the perfect hash table.  */
+struct phash_entry
+{
+  /* Second hash value of the original string, as a fingerprint.  */
+  nls_uint32 hash;
+  /* Index of the string pair in the orig_tab and trans_tab.  */
+  nls_uint32 index;
+};
+
+/* The following are only used in .mo files with minor revision >= 3.  */
+
+/* Number of bits in a block of the Bloom filter.  A string with hash values
+   hval1, hval2 belongs to the block hval1 % n_bloom_blocks, and sets the bits
+   (hval2 + i * step) % MO_BLOOM_BLOCK_BITS for 0 <= i < MO_BLOOM_NBITS, where
+   step is hval2 rotated by 16 bits, with the lowest bit set.  */
+#define MO_BLOOM_BLOCK_BITS 512
+/* Number of bits set in the Bloom filter for each string.  */
+#define MO_BLOOM_NBITS 6
+
 /* @@ begin of epilog @@ */
 
 #endif	/* gettext.h  */
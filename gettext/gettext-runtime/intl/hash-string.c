@@ -48,3 +48,32 @@ __hash_string (const char *str_param)
     }
   return hval;
 }
+
+
+/* Computes the FNV-1a hash function and Bob Jenkins' one-at-a-time hash
+   function of the given string, in a single pass.  */
+void
+__hash_string_pair (const char *str_param,
+		    unsigned long int *hval1p, unsigned long int *hval2p)
+{
+  unsigned long int hval1, hval2;
+  const char *str = str_param;
+
+  hval1 = 2166136261UL;
+  hval2 = 0;
+  while (*str != '\0')
+    {
+      unsigned char c = (unsigned char) *str++;
+
+      hval1 = ((hval1 ^ c) * 16777619UL) & 0xffffffffUL;
+      hval2 = (hval2 + c) & 0xffffffffUL;
+      hval2 = (hval2 + (hval2 << 10)) & 0xffffffffUL;
+      hval2 ^= hval2 >> 6;
+    }
+  hval2 = (hval2 + (hval2 << 3)) & 0xffffffffUL;
+  hval2 ^= hval2 >> 11;
+  hval2 = (hval2 + (hval2 << 15)) & 0xffffffffUL;
+
+  *hval1p = hval1;
+  *hval2p = hval2;
+}
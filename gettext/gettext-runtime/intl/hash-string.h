@@ -23,8 +23,14 @@
 #ifndef _LIBC
 # ifdef IN_LIBINTL
 #  define __hash_string libintl_hash_string
+#  define __hash_string_pair libintl_hash_string_pair
+#  define __hash_string_slot libintl_hash_string_slot
+#  define __hash_string_bloom_step libintl_hash_string_bloom_step
 # else
 #  define __hash_string hash_string
+#  define __hash_string_pair hash_string_pair
+#  define __hash_string_slot hash_string_slot
+#  define __hash_string_bloom_step hash_string_bloom_step
 # endif
 #endif
 
@@ -32,3 +38,37 @@
    [see Aho/Sethi/Ullman, COMPILERS: Principles, Techniques and Tools,
    1986, 1987 Bell Telephone Laboratories, Inc.]  */
 extern unsigned long int __hash_string (const char *str_param);
+
+/* Computes two independent 32-bit hash values of the given string, for the
+   perfect hash table of .mo files with minor revision >= 2.  */
+extern void __hash_string_pair (const char *str_param,
+				unsigned long int *hval1p,
+				unsigned long int *hval2p);
+
+/* Returns the index, in a perfect hash table with SIZE entries, of a string
+   with first hash value HVAL1, given the displacement value DISP of the
+   bucket of the string.  */
+static inline unsigned long int
+__hash_string_slot (unsigned long int hval1, unsigned long int disp,
+		    unsigned long int size)
+{
+  unsigned long int x = (hval1 + disp * 0x9e3779b1UL) & 0xffffffffUL;
+
+  /* The finalization step of MurmurHash3, so that different displacement
+     values yield unrelated positions.  */
+  x ^= x >> 16;
+  x = (x * 0x85ebca6bUL) & 0xffffffffUL;
+  x ^= x >> 13;
+  x = (x * 0xc2b2ae35UL) & 0xffffffffUL;
+  x ^= x >> 16;
+  return x % size;
+}
+
+/* Returns the distance between the bits that a string with second hash value
+   HVAL2 sets in a block of the Bloom filter of .mo files with minor
+   revision >= 3.  */
+static inline unsigned long int
+__hash_string_bloom_step (unsigned long int hval2)
+{
+  return (((hval2 >> 16) | (hval2 << 16)) & 0xffffffffUL) | 1;
+}
@@ -38,6 +38,7 @@
 #endif
 
 #include "loadinfo.h"
+#include "stats.h"
 
 /* On some strange systems still no definition of NULL is found.  Sigh!  */
 #ifndef NULL
@@ -293,6 +294,8 @@ _nl_make_l10nflist (struct loaded_l10nfile **l10nfile_list,
   retval->next = *lastp;
   *lastp = retval;
 
+  STATS_ADD (STATS_CATALOG_CANDIDATES, 1);
+
   entries = 0;
   /* Recurse to fill the inheritance list of RETVAL.
      If the DIRLIST is a real list (i.e. DIRLIST_COUNT > 1), the RETVAL
@@ -505,6 +505,34 @@ extern locale_t newlocale (int, const char *, locale_t);
 #endif
 
 
+/* Statistics about the message lookups.  */
+
+/* Counters of the work done by the gettext functions, summed over all
+   threads of the process.  They are collected only if the environment
+   variable GETTEXT_STATS is set to the name of a file; the totals are then
+   also appended to that file when the program exits.  */
+struct libintl_stats
+{
+  unsigned long cache_hits;         /* lookups answered from the cache */
+  unsigned long cache_misses;       /* lookups that searched the catalogs */
+  unsigned long catalog_searches;   /* searches in a single catalog */
+  unsigned long catalog_probes;     /* catalog entries looked at */
+  unsigned long catalogs_loaded;    /* catalogs loaded into memory */
+  unsigned long catalog_bytes;      /* size of the loaded catalogs */
+  unsigned long catalog_candidates; /* catalog file names considered */
+  unsigned long failed_opens;       /* catalog files that failed to open */
+  unsigned long conversions;        /* translations converted */
+  unsigned long conversion_bytes;   /* memory used by converted strings */
+  unsigned long exclusive_locks;    /* acquisitions of exclusive locks */
+  unsigned long plural_evaluations; /* evaluations of plural expressions */
+};
+
+/* Stores the current statistics in *STATS.  Returns 1 if statistics are
+   being collected, 0 otherwise.  */
+#define libintl_get_stats libintl_get_stats
+extern int libintl_get_stats (struct libintl_stats *__stats);
+
+
 /* Support for relocatable packages.  */
 
 /* Sets the original and the current installation prefix of the package.
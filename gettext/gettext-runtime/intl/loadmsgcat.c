@@ -85,6 +85,7 @@ char *alloca ();
 
 #include "gmo.h"
 #include "gettextP.h"
+#include "stats.h"
 #include "hash-string.h"
 #include "plural-exp.h"
 
@@ -723,6 +724,7 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
   size_t nullentrylen;
 
   __libc_lock_lock_recursive (lock);
+  STATS_ADD (STATS_EXCLUSIVE_LOCKS, 1);
   if (domain_file->decided != 0)
     {
       /* There are two possibilities:
@@ -753,7 +755,10 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
       /* Try to open the addressed file.  */
       fd = open (domain_file->filename, O_RDONLY | O_BINARY);
       if (fd == -1)
-        goto out;
+        {
+          STATS_ADD (STATS_FAILED_OPENS, 1);
+          goto out;
+        }
     }
 #if defined _WIN32 && !defined __CYGWIN__
   else if (domain_file->wfilename != NULL)
@@ -761,7 +766,10 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
       /* Try to open the addressed file.  */
       fd = _wopen (domain_file->wfilename, O_RDONLY | O_BINARY);
       if (fd == -1)
-        goto out;
+        {
+          STATS_ADD (STATS_FAILED_OPENS, 1);
+          goto out;
+        }
     }
 #endif
   else
@@ -775,7 +783,8 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
       __builtin_expect (fstat (fd, &st) != 0, 0)
 #endif
       || __builtin_expect ((size = (size_t) st.st_size) != st.st_size, 0)
-      || __builtin_expect (size < sizeof (struct mo_file_header), 0))
+      || __builtin_expect (size < offsetof (struct mo_file_header,
+					     n_phash_buckets), 0))
     /* Something went wrong.  */
     goto out;
 
@@ -883,6 +892,11 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 	   ((char *) data + W (domain->must_swap, data->hash_tab_offset))
 	 : NULL);
       domain->must_swap_hash_tab = domain->must_swap;
+      domain->n_phash_buckets = 0;
+      domain->phash_buckets = NULL;
+      domain->phash_tab = NULL;
+      domain->n_bloom_blocks = 0;
+      domain->bloom = NULL;
 
       /* Now dispatch on the minor revision.  */
       switch (revision & 0xffff)
@@ -1219,6 +1233,59 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 		domain->n_sysdep_strings = 0;
 		domain->orig_sysdep_tab = NULL;
 		domain->trans_sysdep_tab = NULL;
+
+		/* Minor revision >= 2 may contain a perfect hash table.  It
+		   is only valid if there are no system dependent strings.  */
+		if ((revision & 0xffff) >= 2
+		    && size >= offsetof (struct mo_file_header, n_bloom_blocks)
+		    && domain->nstrings > 0)
+		  {
+		    nls_uint32 n_phash_buckets =
+		      W (domain->must_swap, data->n_phash_buckets);
+		    nls_uint32 phash_buckets_offset =
+		      W (domain->must_swap, data->phash_buckets_offset);
+		    nls_uint32 phash_tab_offset =
+		      W (domain->must_swap, data->phash_tab_offset);
+
+		    if (n_phash_buckets > 0
+			&& phash_buckets_offset <= size
+			&& n_phash_buckets
+			   <= (size - phash_buckets_offset) / sizeof (nls_uint32)
+			&& phash_tab_offset <= size
+			&& domain->nstrings
+			   <= ((size - phash_tab_offset)
+			       / sizeof (struct phash_entry)))
+		      {
+			domain->n_phash_buckets = n_phash_buckets;
+			domain->phash_buckets = (const nls_uint32 *)
+			  ((char *) data + phash_buckets_offset);
+			domain->phash_tab = (const struct phash_entry *)
+			  ((char *) data + phash_tab_offset);
+		      }
+		  }
+
+		/* Minor revision >= 3 may contain a Bloom filter.  It is only
+		   valid if there are no system dependent strings.  */
+		if ((revision & 0xffff) >= 3
+		    && size >= (offsetof (struct mo_file_header, bloom_offset)
+				+ sizeof (nls_uint32)))
+		  {
+		    nls_uint32 n_bloom_blocks =
+		      W (domain->must_swap, data->n_bloom_blocks);
+		    nls_uint32 bloom_offset =
+		      W (domain->must_swap, data->bloom_offset);
+
+		    if (n_bloom_blocks > 0
+			&& bloom_offset <= size
+			&& n_bloom_blocks
+			   <= ((size - bloom_offset)
+			       / (MO_BLOOM_BLOCK_BITS / 8)))
+		      {
+			domain->n_bloom_blocks = n_bloom_blocks;
+			domain->bloom = (const nls_uint32 *)
+			  ((char *) data + bloom_offset);
+		      }
+		  }
 	      }
 	  }
 	  break;
@@ -1267,6 +1334,9 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
     }
   EXTRACT_PLURAL_EXPRESSION (nullentry, &domain->plural, &domain->nplurals);
 
+  STATS_ADD (STATS_CATALOGS_LOADED, 1);
+  STATS_ADD (STATS_CATALOG_BYTES, size);
+
  out:
   if (fd != -1)
     close (fd);
@@ -0,0 +1,291 @@
+/* Statistics about message lookups.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#include "gettextP.h"
+#include "stats.h"
+
+/* The statistics are enabled by setting the environment variable
+   GETTEXT_STATS to the name of a file.  The totals are appended to this
+   file when the program exits, and can be retrieved at any time through
+   libintl_get_stats.
+
+   Every thread counts in a block of its own, so that the threads don't
+   compete for the cache lines of the counters.  The blocks are summed when
+   the statistics are read.  When a thread terminates, its counts are added
+   to the totals of the terminated threads, and its block is freed.  With
+   thread libraries other than POSIX threads, the blocks are kept until the
+   process exits.  */
+
+/* Use thread-local storage where the compiler supports it.  Elsewhere, all
+   threads count in a single block, and the counts of concurrent threads are
+   approximate.  */
+#if defined __GNUC__ && defined __ELF__ \
+    && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 3))
+# define STATS_THREAD_LOCAL __thread
+#elif defined _MSC_VER
+# define STATS_THREAD_LOCAL __declspec (thread)
+#endif
+
+/* Use a thread-specific data key to free the block of a terminating
+   thread.  */
+#if defined STATS_THREAD_LOCAL && USE_POSIX_THREADS
+# define STATS_FREE_BLOCKS 1
+# if USE_POSIX_THREADS_WEAK
+#  pragma weak pthread_key_create
+#  pragma weak pthread_setspecific
+# endif
+#endif
+
+#ifndef HAVE_GETUID
+# define getuid() 0
+#endif
+#ifndef HAVE_GETGID
+# define getgid() 0
+#endif
+#ifndef HAVE_GETEUID
+# define geteuid() getuid()
+#endif
+#ifndef HAVE_GETEGID
+# define getegid() getgid()
+#endif
+
+struct stats_block
+{
+  struct stats_block *next;
+  unsigned long int counter[STATS_COUNT];
+};
+
+/* The block used by threads for which no block of their own could be
+   allocated.  */
+static struct stats_block shared_block;
+
+/* The list of all blocks.  */
+static struct stats_block *blocks = &shared_block;
+gl_lock_define_initialized (static, blocks_lock)
+
+#ifdef STATS_THREAD_LOCAL
+static STATS_THREAD_LOCAL struct stats_block *thread_block;
+#endif
+
+#ifdef STATS_FREE_BLOCKS
+/* The counts of the threads that have terminated.  Protected by
+   blocks_lock.  */
+static unsigned long int terminated_counter[STATS_COUNT];
+
+/* The key whose destructor frees the block of a terminating thread.  */
+static pthread_key_t stats_key;
+/* Nonzero if stats_key has been created.  */
+static int stats_key_created;
+#endif
+
+int _nl_stats_enabled;
+
+static const char *stats_filename;
+
+gl_once_define (static, stats_once)
+
+/* Sums the counters of all threads into SUM.  */
+static void
+stats_sum (unsigned long int sum[STATS_COUNT])
+{
+  struct stats_block *block;
+  int i;
+
+  for (i = 0; i < STATS_COUNT; i++)
+    sum[i] = 0;
+  gl_lock_lock (blocks_lock);
+  for (block = blocks; block != NULL; block = block->next)
+    for (i = 0; i < STATS_COUNT; i++)
+      sum[i] += block->counter[i];
+#ifdef STATS_FREE_BLOCKS
+  for (i = 0; i < STATS_COUNT; i++)
+    sum[i] += terminated_counter[i];
+#endif
+  gl_lock_unlock (blocks_lock);
+}
+
+#ifdef STATS_FREE_BLOCKS
+/* Destructor of stats_key.  Adds the counts of a terminating thread to
+   terminated_counter and frees its block.  */
+static void
+stats_block_free (void *arg)
+{
+  struct stats_block *block = (struct stats_block *) arg;
+  struct stats_block **blockp;
+  int i;
+
+  gl_lock_lock (blocks_lock);
+  for (blockp = &blocks; *blockp != NULL; blockp = &(*blockp)->next)
+    if (*blockp == block)
+      {
+        *blockp = block->next;
+        break;
+      }
+  for (i = 0; i < STATS_COUNT; i++)
+    terminated_counter[i] += block->counter[i];
+  gl_lock_unlock (blocks_lock);
+
+  /* If the thread counts again, in the destructor of another key, it gets
+     a new block.  */
+  thread_block = NULL;
+  free (block);
+}
+#endif
+
+/* The names of the counters in the report.  */
+static const char *const stats_names[STATS_COUNT] =
+{
+  "cache_hits",
+  "cache_misses",
+  "catalog_searches",
+  "catalog_probes",
+  "catalogs_loaded",
+  "catalog_bytes",
+  "catalog_candidates",
+  "failed_opens",
+  "conversions",
+  "conversion_bytes",
+  "exclusive_locks",
+  "plural_evaluations"
+};
+
+/* Appends the totals to the file named by GETTEXT_STATS.  */
+static void
+stats_report (void)
+{
+  unsigned long int sum[STATS_COUNT];
+  FILE *fp;
+  int i;
+
+  stats_sum (sum);
+  fp = fopen (stats_filename, "a");
+  if (fp == NULL)
+    return;
+#if defined HAVE_UNISTD_H
+  fprintf (fp, "# process %ld\n", (long) getpid ());
+#endif
+  for (i = 0; i < STATS_COUNT; i++)
+    fprintf (fp, "%s %lu\n", stats_names[i], sum[i]);
+  fclose (fp);
+}
+
+static void
+stats_init (void)
+{
+  const char *filename = getenv ("GETTEXT_STATS");
+
+  /* Don't let the environment of a SUID program create or modify files.  */
+  if (filename != NULL && filename[0] != '\0'
+      && getuid () == geteuid () && getgid () == getegid ())
+    {
+      char *copy = (char *) malloc (strlen (filename) + 1);
+
+      if (copy != NULL)
+        {
+          strcpy (copy, filename);
+          stats_filename = copy;
+          if (atexit (stats_report) == 0)
+            {
+#ifdef STATS_FREE_BLOCKS
+              if (pthread_in_use ()
+                  && pthread_key_create (&stats_key, stats_block_free) == 0)
+                stats_key_created = 1;
+#endif
+              _nl_stats_enabled = 1;
+              return;
+            }
+          free (copy);
+        }
+    }
+  _nl_stats_enabled = -1;
+}
+
+/* Returns the block of the current thread.  */
+static struct stats_block *
+stats_block (void)
+{
+#ifdef STATS_THREAD_LOCAL
+  struct stats_block *block = thread_block;
+
+  if (block == NULL)
+    {
+      block = (struct stats_block *) calloc (1, sizeof (struct stats_block));
+      if (block != NULL)
+        {
+          gl_lock_lock (blocks_lock);
+          block->next = blocks;
+          blocks = block;
+          gl_lock_unlock (blocks_lock);
+#ifdef STATS_FREE_BLOCKS
+          /* Without a key, the block is kept until the process exits.  */
+          if (stats_key_created)
+            pthread_setspecific (stats_key, block);
+#endif
+        }
+      else
+        block = &shared_block;
+      thread_block = block;
+    }
+  return block;
+#else
+  return &shared_block;
+#endif
+}
+
+void
+_nl_stats_add (int counter, unsigned long int n)
+{
+  if (_nl_stats_enabled == 0)
+    gl_once (stats_once, stats_init);
+  if (_nl_stats_enabled > 0)
+    stats_block ()->counter[counter] += n;
+}
+
+int
+libintl_get_stats (struct libintl_stats *stats)
+{
+  unsigned long int sum[STATS_COUNT];
+
+  if (_nl_stats_enabled == 0)
+    gl_once (stats_once, stats_init);
+  stats_sum (sum);
+
+  stats->cache_hits = sum[STATS_CACHE_HITS];
+  stats->cache_misses = sum[STATS_CACHE_MISSES];
+  stats->catalog_searches = sum[STATS_CATALOG_SEARCHES];
+  stats->catalog_probes = sum[STATS_CATALOG_PROBES];
+  stats->catalogs_loaded = sum[STATS_CATALOGS_LOADED];
+  stats->catalog_bytes = sum[STATS_CATALOG_BYTES];
+  stats->catalog_candidates = sum[STATS_CATALOG_CANDIDATES];
+  stats->failed_opens = sum[STATS_FAILED_OPENS];
+  stats->conversions = sum[STATS_CONVERSIONS];
+  stats->conversion_bytes = sum[STATS_CONVERSION_BYTES];
+  stats->exclusive_locks = sum[STATS_EXCLUSIVE_LOCKS];
+  stats->plural_evaluations = sum[STATS_PLURAL_EVALUATIONS];
+
+  return _nl_stats_enabled > 0;
+}
@@ -0,0 +1,56 @@
+/* Statistics about message lookups.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+/* The counters.  They correspond to the fields of struct libintl_stats.  */
+enum
+{
+  STATS_CACHE_HITS,		/* lookups found among the known translations */
+  STATS_CACHE_MISSES,		/* lookups that had to search the catalogs */
+  STATS_CATALOG_SEARCHES,	/* calls of _nl_find_msg */
+  STATS_CATALOG_PROBES,		/* catalog entries looked at by _nl_find_msg */
+  STATS_CATALOGS_LOADED,	/* catalogs loaded by _nl_load_domain */
+  STATS_CATALOG_BYTES,		/* size of these catalogs */
+  STATS_CATALOG_CANDIDATES,	/* file names created by _nl_make_l10nflist */
+  STATS_FAILED_OPENS,		/* catalog files that could not be opened */
+  STATS_CONVERSIONS,		/* translations converted to another charset */
+  STATS_CONVERSION_BYTES,	/* memory used by the converted translations */
+  STATS_EXCLUSIVE_LOCKS,	/* acquisitions of exclusive locks */
+  STATS_PLURAL_EVALUATIONS,	/* evaluations of a plural expression */
+  STATS_COUNT
+};
+
+#ifdef _LIBC
+# define STATS_ADD(counter, n) ((void) 0)
+#else
+/* > 0 if statistics are collected, < 0 if not, 0 if not yet known.  */
+extern int _nl_stats_enabled;
+
+/* Adds N to COUNTER in the statistics of the current thread.  */
+extern void _nl_stats_add (int counter, unsigned long int n);
+
+/* When statistics are not collected, a counter update costs a test of a
+   global variable.  */
+# define STATS_ADD(counter, n)					\
+  do								\
+    if (_nl_stats_enabled >= 0)					\
+      _nl_stats_add (counter, n);				\
+  while (0)
+#endif
+
+#endif /* _STATS_H */
@@ -1384,6 +1384,7 @@ m4_include([gnulib-m4/setenv.m4])
 m4_include([gnulib-m4/setlocale.m4])
 m4_include([gnulib-m4/setlocale_null.m4])
 m4_include([gnulib-m4/sh-filename.m4])
+m4_include([gnulib-m4/sha1.m4])
 m4_include([gnulib-m4/sig_atomic_t.m4])
 m4_include([gnulib-m4/sigaction.m4])
 m4_include([gnulib-m4/signal_h.m4])
@@ -128,6 +128,7 @@
 #  setlocale-null \
 #  sh-filename \
 #  sh-quote \
+#  sha1 \
 #  sigpipe \
 #  sigprocmask \
 #  snippet/arg-nonnull \
@@ -269,6 +270,7 @@ gl_MODULES([
   setlocale-null
   sh-filename
   sh-quote
+  sha1
   sigpipe
   sigprocmask
   snippet/arg-nonnull
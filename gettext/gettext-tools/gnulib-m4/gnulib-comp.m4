@@ -442,6 +442,7 @@ AC_DEFUN([gl_EARLY],
   # Code from module sh-filename:
   # Code from module sh-quote:
   # Code from module sh-quote-tests:
+  # Code from module sha1:
   # Code from module sigaction:
   # Code from module sigaction-tests:
   # Code from module signal-h:
@@ -1290,6 +1291,7 @@ AC_DEFUN([gl_INIT],
   fi
   gl_LOCALE_MODULE_INDICATOR([setlocale_null])
   gl_SH_FILENAME
+  gl_SHA1
   AC_REQUIRE([AC_C_RESTRICT])
   gl_SIGACTION
   if test $HAVE_SIGACTION = 0; then
@@ -2436,6 +2438,8 @@ AC_DEFUN([gl_FILE_LIST], [
   lib/setlocale_null.h
   lib/sh-quote.c
   lib/sh-quote.h
+  lib/sha1.c
+  lib/sha1.h
   lib/sig-handler.c
   lib/sig-handler.h
   lib/sigaction.c
@@ -2827,6 +2831,7 @@ AC_DEFUN([gl_FILE_LIST], [
   m4/setlocale.m4
   m4/setlocale_null.m4
   m4/sh-filename.m4
+  m4/sha1.m4
   m4/sig_atomic_t.m4
   m4/sigaction.m4
   m4/signal_h.m4
@@ -33,6 +33,7 @@
 #include "xalloc.h"
 #include "read-catalog.h"
 #include "read-po.h"
+#include "read-po-readonly.h"
 #include "write-catalog.h"
 #include "write-po.h"
 #include "error.h"
@@ -53,6 +54,8 @@ struct po_file
   const char *real_filename;
   const char *logical_filename;
   const char **domains;
+  /* Non-NULL for a file read by po_file_read_readonly.  */
+  po_readonly_storage_ty *storage;
 };
 
 struct po_message_iterator
@@ -84,6 +87,7 @@ po_file_create (void)
   file->real_filename = _("<unnamed>");
   file->logical_filename = file->real_filename;
   file->domains = NULL;
+  file->storage = NULL;
   return file;
 }
 
@@ -124,6 +128,7 @@ po_file_read (const char *filename, po_xerror_handler_t handler)
   file->mdlp = read_catalog_stream (fp, file->real_filename,
                                     file->logical_filename, &input_format_po);
   file->domains = NULL;
+  file->storage = NULL;
 
   /* Restore error handler.  */
   po_xerror  = textmode_xerror;
@@ -136,6 +141,78 @@ po_file_read (const char *filename, po_xerror_handler_t handler)
 }
 #undef po_file_read
 
+
+/* Read a PO file into memory, for read-only access.
+   Return its contents.  Upon failure, return NULL and set errno.  */
+
+po_file_t
+po_file_read_readonly (const char *filename, po_xerror_handler_t handler)
+{
+  FILE *fp;
+  po_file_t file;
+
+  if (strcmp (filename, "-") == 0 || strcmp (filename, "/dev/stdin") == 0)
+    {
+      filename = _("<stdin>");
+      fp = stdin;
+    }
+  else
+    {
+      fp = fopen (filename, "r");
+      if (fp == NULL)
+        return NULL;
+    }
+
+  /* Establish error handler around read_po_stream_readonly().  */
+  po_xerror =
+    (void (*) (int, const message_ty *, const char *, size_t, size_t, int, const char *))
+    handler->xerror;
+  po_xerror2 =
+    (void (*) (int, const message_ty *, const char *, size_t, size_t, int, const char *, const message_ty *, const char *, size_t, size_t, int, const char *))
+    handler->xerror2;
+  gram_max_allowed_errors = UINT_MAX;
+
+  file = XMALLOC (struct po_file);
+  file->real_filename = filename;
+  file->logical_filename = filename;
+  file->mdlp = read_po_stream_readonly (fp, file->real_filename,
+                                        file->logical_filename,
+                                        &file->storage);
+  file->domains = NULL;
+
+  /* Restore error handler.  */
+  po_xerror  = textmode_xerror;
+  po_xerror2 = textmode_xerror2;
+  gram_max_allowed_errors = 20;
+
+  if (fp != stdin)
+    fclose (fp);
+  return file;
+}
+
+
+/* Allow the messages of a PO file read by po_file_read_readonly to be
+   modified.  */
+
+void
+po_file_make_mutable (po_file_t file)
+{
+  if (file->storage != NULL)
+    readonly_storage_unshare (file->storage, false);
+}
+
+
+/* Prepare the message MP for being modified.  If it belongs to a PO file read
+   by po_file_read_readonly, give the messages of that file their own copies
+   of their strings.  The file's contents remain allocated until the file is
+   freed, because the caller's arguments may point into them.  */
+static void
+message_make_mutable (message_ty *mp)
+{
+  if (mp->readonly_storage != NULL)
+    readonly_storage_unshare (mp->readonly_storage, true);
+}
+
 #ifdef __cplusplus
 extern "C" po_file_t po_file_read_v2 (const char *filename, po_error_handler_t handler);
 #endif
@@ -170,6 +247,7 @@ po_file_read_v2 (const char *filename, po_error_handler_t handler)
   file->mdlp = read_catalog_stream (fp, file->real_filename,
                                     file->logical_filename, &input_format_po);
   file->domains = NULL;
+  file->storage = NULL;
 
   /* Restore error handler.  */
   po_error             = error;
@@ -211,6 +289,7 @@ po_file_read (const char *filename)
   file->mdlp = read_catalog_stream (fp, file->real_filename,
                                     file->logical_filename, &input_format_po);
   file->domains = NULL;
+  file->storage = NULL;
 
   if (fp != stdin)
     fclose (fp);
@@ -272,7 +351,10 @@ po_file_write (po_file_t file, const char *filename, po_error_handler_t handler)
 void
 po_file_free (po_file_t file)
 {
-  msgdomain_list_free (file->mdlp);
+  if (file->storage != NULL)
+    readonly_msgdomain_list_free (file->mdlp, file->storage);
+  else
+    msgdomain_list_free (file->mdlp);
   if (file->domains != NULL)
     free (file->domains);
   free (file);
@@ -542,6 +624,8 @@ po_message_set_msgctxt (po_message_t message, const char *msgctxt)
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (msgctxt != mp->msgctxt)
     {
       char *old_msgctxt = (char *) mp->msgctxt;
@@ -571,6 +655,8 @@ po_message_set_msgid (po_message_t message, const char *msgid)
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (msgid != mp->msgid)
     {
       char *old_msgid = (char *) mp->msgid;
@@ -602,6 +688,8 @@ po_message_set_msgid_plural (po_message_t message, const char *msgid_plural)
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (msgid_plural != mp->msgid_plural)
     {
       char *old_msgid_plural = (char *) mp->msgid_plural;
@@ -633,6 +721,8 @@ po_message_set_msgstr (po_message_t message, const char *msgstr)
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (msgstr != mp->msgstr)
     {
       char *old_msgstr = (char *) mp->msgstr;
@@ -680,6 +770,8 @@ po_message_set_msgstr_plural (po_message_t message, int index, const char *msgst
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (mp->msgid_plural != NULL && index >= 0)
     {
       char *p = (char *) mp->msgstr;
@@ -775,6 +867,8 @@ po_message_set_comments (po_message_t message, const char *comments)
   message_ty *mp = (message_ty *) message;
   string_list_ty *slp = string_list_alloc ();
 
+  message_make_mutable (mp);
+
   {
     char *copy = xstrdup (comments);
     char *rest;
@@ -830,6 +924,8 @@ po_message_set_extracted_comments (po_message_t message, const char *comments)
   message_ty *mp = (message_ty *) message;
   string_list_ty *slp = string_list_alloc ();
 
+  message_make_mutable (mp);
+
   {
     char *copy = xstrdup (comments);
     char *rest;
@@ -934,6 +1030,8 @@ po_message_set_prev_msgctxt (po_message_t message, const char *prev_msgctxt)
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (prev_msgctxt != mp->prev_msgctxt)
     {
       char *old_prev_msgctxt = (char *) mp->prev_msgctxt;
@@ -965,6 +1063,8 @@ po_message_set_prev_msgid (po_message_t message, const char *prev_msgid)
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (prev_msgid != mp->prev_msgid)
     {
       char *old_prev_msgid = (char *) mp->prev_msgid;
@@ -996,6 +1096,8 @@ po_message_set_prev_msgid_plural (po_message_t message, const char *prev_msgid_p
 {
   message_ty *mp = (message_ty *) message;
 
+  message_make_mutable (mp);
+
   if (prev_msgid_plural != mp->prev_msgid_plural)
     {
       char *old_prev_msgid_plural = (char *) mp->prev_msgid_plural;
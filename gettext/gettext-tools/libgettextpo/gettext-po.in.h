@@ -136,6 +136,18 @@ extern po_file_t po_file_create (void);
 extern po_file_t po_file_read (const char *filename,
                                po_xerror_handler_t handler);
 
+/* Read a PO file into memory, for read-only access.  The strings of the
+   messages are located in a private mapping of the file, which makes reading
+   faster and uses less memory.  The first po_message_set_* call on one of its
+   messages makes all of them mutable, like po_file_make_mutable does.
+   Return its contents.  Upon failure, call function from handler.  */
+extern po_file_t po_file_read_readonly (const char *filename,
+                                        po_xerror_handler_t handler);
+
+/* Allow the messages of a PO file read by po_file_read_readonly to be
+   modified, and free the file's contents.  */
+extern void po_file_make_mutable (po_file_t file);
+
 /* Write an in-memory PO file to a file.
    Upon failure, call function from handler.  */
 #define po_file_write po_file_write_v2
@@ -31,6 +31,9 @@
 #include "error.h"
 #include "exitfail.h"
 #include "xalloc.h"
+#include "kwset.h"
+#include "gettext.h"
+#define _(str) gettext (str)
 
 #if defined (STDC_HEADERS) || (!defined (isascii) && !defined (HAVE_ISASCII))
 # define IN_CTYPE_DOMAIN(c) 1
@@ -56,8 +59,58 @@ struct compiled_regex {
   /* The Regex compiled patterns.  */
   struct patterns *patterns;
   size_t pcount;
+
+  /* If every pattern matches only a fixed string, a keyword set of these
+     strings.  A line can only match if it contains one of them.  */
+  kwset_t kwset;
 };
 
+/* If the regular expression PATTERN of size LEN bytes matches only a fixed
+   string, possibly anchored at the beginning or end of the line, store that
+   string in BUF and return its length.  Otherwise, or if the string would be
+   empty, return 0.  BUF must have room for LEN bytes.
+   This is conservative: characters that are special in any of the supported
+   syntaxes are not considered part of a fixed string.  */
+static size_t
+fixed_string (const char *pattern, size_t len, char *buf)
+{
+  const char *p = pattern;
+  const char *pend = pattern + len;
+  size_t n = 0;
+
+  /* Strip the anchors.  A '$' is an anchor only if it is not escaped.  */
+  if (p < pend && *p == '^')
+    p++;
+  if (p < pend && pend[-1] == '$')
+    {
+      const char *q = pend - 1;
+
+      while (q > p && q[-1] == '\\')
+        q--;
+      if (((pend - 1) - q) % 2 == 0)
+        pend--;
+    }
+
+  while (p < pend)
+    {
+      char c = *p++;
+
+      if (c == '\\')
+        {
+          if (p == pend)
+            return 0;
+          c = *p++;
+          if (c == '\0' || strchr (".[]*^$\\", c) == NULL)
+            return 0;
+        }
+      else if (c == '\0' || strchr (".[]*^$+?{}()|", c) != NULL)
+        return 0;
+      buf[n++] = c;
+    }
+
+  return n;
+}
+
 static void *
 compile (const char *pattern, size_t pattern_size,
          bool match_icase, bool match_words, bool match_lines, char eolbyte,
@@ -115,6 +168,46 @@ compile (const char *pattern, size_t pattern_size,
     while (sep && total != 0);
   }
 
+  /* Set up the keyword set.  Case-insensitive matching would need a
+     translation table consistent with the regex matcher; don't bother.  */
+  if (!match_icase)
+    {
+      const char *motif = pattern;
+      const char *pattern_end = pattern + pattern_size;
+      char *buf = XNMALLOC (pattern_size + 1, char);
+      size_t i;
+
+      cregex->kwset = kwsalloc (NULL);
+      if (cregex->kwset == NULL)
+        error (exit_failure, 0, _("memory exhausted"));
+      for (i = 0; i < cregex->pcount; i++)
+        {
+          const char *sep =
+            (const char *) memchr (motif, '\n', pattern_end - motif);
+          size_t len = (sep != NULL ? sep : pattern_end) - motif;
+          size_t n = fixed_string (motif, len, buf);
+          const char *err;
+
+          if (n == 0)
+            {
+              kwsfree (cregex->kwset);
+              cregex->kwset = NULL;
+              break;
+            }
+          if ((err = kwsincr (cregex->kwset, buf, n)) != NULL)
+            error (exit_failure, 0, "%s", err);
+          motif += len + 1;
+        }
+      if (cregex->kwset != NULL)
+        {
+          const char *err;
+
+          if ((err = kwsprep (cregex->kwset)) != NULL)
+            error (exit_failure, 0, "%s", err);
+        }
+      free (buf);
+    }
+
   return cregex;
 }
 
@@ -160,6 +253,20 @@ EGexecute (const void *compiled_pattern,
     {
       size_t i;
 
+      if (cregex->kwset != NULL)
+        {
+          /* Skip the lines that contain none of the fixed strings.  */
+          struct kwsmatch kwsmatch;
+          size_t offset =
+            kwsexec (cregex->kwset, beg, buflim - beg, &kwsmatch);
+
+          if (offset == (size_t) -1)
+            break;
+          for (end = beg + offset; end > beg && end[-1] != eol; end--)
+            ;
+          beg = end;
+        }
+
       end = (const char *) memchr (beg, eol, buflim - beg);
       if (end == NULL)
         end = buflim;
@@ -244,6 +351,8 @@ EGfree (void *compiled_pattern)
 {
   struct compiled_regex *cregex = (struct compiled_regex *) compiled_pattern;
 
+  if (cregex->kwset != NULL)
+    kwsfree (cregex->kwset);
   free (cregex->patterns);
   free (cregex);
 }
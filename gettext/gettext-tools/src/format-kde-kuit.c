@@ -231,25 +231,36 @@ format_parse (const char *format, bool translated, char *fdi,
 #if FORMAT_KDE_KUIT_USE_LIBXML2
     {
       xmlDocPtr doc;
+      char *error_message = NULL;
+
+      /* libxml2 keeps global state, such as the last error, that is not
+         per-thread in all configurations.  */
+      #ifdef _OPENMP
+       #pragma omp critical (format_kde_kuit_libxml2)
+      #endif
+      {
+        doc = xmlReadMemory (buffer, strlen (buffer), "", NULL,
+                             XML_PARSE_NONET
+                             | XML_PARSE_NOWARNING
+                             | XML_PARSE_NOERROR
+                             | XML_PARSE_NOBLANKS);
+        if (doc == NULL)
+          {
+            xmlError *err = xmlGetLastError ();
+            error_message =
+              xasprintf (_("error while parsing: %s"),
+                         err->message);
+          }
+        else
+          xmlFreeDoc (doc);
+      }
 
-      doc = xmlReadMemory (buffer, strlen (buffer), "", NULL,
-                           XML_PARSE_NONET
-                           | XML_PARSE_NOWARNING
-                           | XML_PARSE_NOERROR
-                           | XML_PARSE_NOBLANKS);
+      free (buffer);
       if (doc == NULL)
         {
-          xmlError *err = xmlGetLastError ();
-          *invalid_reason =
-            xasprintf (_("error while parsing: %s"),
-                       err->message);
-          free (buffer);
-          xmlFreeDoc (doc);
+          *invalid_reason = error_message;
           return NULL;
         }
-
-      free (buffer);
-      xmlFreeDoc (doc);
     }
 #elif FORMAT_KDE_KUIT_USE_FALLBACK_MARKUP
     {
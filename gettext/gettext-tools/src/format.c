@@ -25,8 +25,12 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "message.h"
+#include "mem-hash-map.h"
+#include "xalloc.h"
+#include "xmalloca.h"
 #include "gettext.h"
 
 #define _(str) gettext (str)
@@ -66,6 +70,69 @@ struct formatstring_parser *formatstring_parsers[NFORMATS] =
   /* format_ycp */              &formatstring_ycp
 };
 
+/* Cache of the parsed msgid format strings.  A process that checks the
+   catalogs of many languages sees the same msgids many times.  The key is
+   the format type, as a single byte, followed by the format string.  The
+   value is the parser's descriptor, or NULL if the string is not a valid
+   format string of this type.  */
+static bool msgid_descr_cache_enabled;
+static hash_table msgid_descr_cache;
+
+void
+formatstring_cache_enable (void)
+{
+  if (!msgid_descr_cache_enabled)
+    {
+      hash_init (&msgid_descr_cache, 100);
+      msgid_descr_cache_enabled = true;
+    }
+}
+
+void
+formatstring_cache_disable (void)
+{
+  if (msgid_descr_cache_enabled)
+    {
+      void *iter = NULL;
+      const void *key;
+      size_t keylen;
+      void *data;
+
+      while (hash_iterate (&msgid_descr_cache, &iter, &key, &keylen, &data)
+             == 0)
+        if (data != NULL)
+          formatstring_parsers[*(const unsigned char *) key]->free (data);
+      hash_destroy (&msgid_descr_cache);
+      msgid_descr_cache_enabled = false;
+    }
+}
+
+/* Return the descriptor of the msgid format string STRING for format type
+   i, parsing it only the first time.  */
+static void *
+cached_msgid_descr (const char *string, size_t i)
+{
+  size_t length = strlen (string);
+  char *key = (char *) xmalloca (1 + length);
+  void *descr;
+
+  key[0] = (char) i;
+  memcpy (key + 1, string, length);
+  if (hash_find_entry (&msgid_descr_cache, key, 1 + length, &descr) != 0)
+    {
+      char *invalid_reason = NULL;
+
+      descr = formatstring_parsers[i]->parse (string, false, NULL,
+                                              &invalid_reason);
+      if (descr == NULL)
+        free (invalid_reason);
+      hash_insert_entry (&msgid_descr_cache, key, 1 + length, descr);
+    }
+  freea (key);
+
+  return descr;
+}
+
 /* Check whether both formats strings contain compatible format
    specifications for format type i (0 <= i < NFORMATS).  */
 int
@@ -91,9 +158,19 @@ check_msgid_msgstr_format_i (const char *msgid, const char *msgid_plural,
 
   struct formatstring_parser *parser = formatstring_parsers[i];
   char *invalid_reason = NULL;
-  void *msgid_descr =
-    parser->parse (msgid_plural != NULL ? msgid_plural : msgid, false, NULL,
-                   &invalid_reason);
+  void *msgid_descr;
+
+  if (msgid_descr_cache_enabled)
+    msgid_descr =
+      cached_msgid_descr (msgid_plural != NULL ? msgid_plural : msgid, i);
+  else
+    {
+      msgid_descr =
+        parser->parse (msgid_plural != NULL ? msgid_plural : msgid, false,
+                       NULL, &invalid_reason);
+      if (msgid_descr == NULL)
+        free (invalid_reason);
+    }
 
   if (msgid_descr != NULL)
     {
@@ -159,10 +236,9 @@ check_msgid_msgstr_format_i (const char *msgid, const char *msgid_plural,
             }
         }
 
-      parser->free (msgid_descr);
+      if (!msgid_descr_cache_enabled)
+        parser->free (msgid_descr);
     }
-  else
-    free (invalid_reason);
 
   return seen_errors;
 }
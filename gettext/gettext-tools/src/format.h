@@ -147,6 +147,16 @@ extern void
    string.  */
 extern unsigned int get_python_format_unnamed_arg_count (const char *string);
 
+/* Enable the caching of the parsed msgid format strings in
+   check_msgid_msgstr_format_i and check_msgid_msgstr_format, so that a
+   process that checks many catalogs with the same msgids parses each of
+   them only once.  */
+extern void formatstring_cache_enable (void);
+
+/* Disable the caching of the parsed msgid format strings, and free the
+   cache.  */
+extern void formatstring_cache_disable (void);
+
 /* Check whether both formats strings contain compatible format
    specifications for format type i (0 <= i < NFORMATS).
    Return the number of errors that were seen.  */
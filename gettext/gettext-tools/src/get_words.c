@@ -68,14 +68,17 @@ int main (int argc, char **argv) {
 
     const char* filename = argv[1];
 
-    message_list_ty *mlp = message_list_alloc (false);
-    read_mo_file (mlp, filename);
+    mo_file_ty *mfp = mo_file_open (filename);
+    size_t n = mo_file_nmessages (mfp);
 
     PGconn *conn = initPGconn();
-    for (int i = 0; i < mlp->nitems; i++) {
-	insert(conn, filename, mlp->item[i]->msgid, mlp->item[i]->msgstr);
+    for (size_t i = 0; i < n; i++) {
+	struct mo_message msg;
+	mo_file_get_message (mfp, i, &msg);
+	insert(conn, filename, msg.msgid, msg.msgstr);
     }
     PQfinish(conn);
+    mo_file_close (mfp);
 
     return 0;
 }
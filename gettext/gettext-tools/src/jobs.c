@@ -0,0 +1,64 @@
+/* Handling of the -j/--jobs option.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Specification.  */
+#include "jobs.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+#include "write-po.h"
+#include "error.h"
+#include "gettext.h"
+
+#define _(str) gettext (str)
+
+
+int
+jobs_parse (const char *arg)
+{
+  char *endp;
+  long int value;
+
+  errno = 0;
+  value = strtol (arg, &endp, 10);
+  if (endp == arg || *endp != '\0' || errno != 0
+      || value <= 0 || value > INT_MAX)
+    error (EXIT_FAILURE, 0, _("invalid jobs count: %s"), arg);
+  return value;
+}
+
+
+void
+jobs_init (int jobs)
+{
+#ifdef _OPENMP
+  openmp_init ();
+  if (jobs > 0)
+    omp_set_num_threads (jobs);
+  message_print_parallel (true);
+#else
+  (void) jobs;
+#endif
+}
@@ -0,0 +1,45 @@
+/* Handling of the -j/--jobs option.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef _JOBS_H
+#define _JOBS_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Parses the argument of the -j/--jobs option.  Returns the number of
+   threads.  Exits with an error message if ARG is not a positive
+   integer.  */
+extern int jobs_parse (const char *arg);
+
+/* Prepares the program for processing messages in several threads.
+   If JOBS > 0, at most JOBS threads are used.  Otherwise the number of
+   threads is determined by the OMP_NUM_THREADS environment variable and
+   the number of processors.  The PO output is then also formatted in
+   several threads.
+   Without OpenMP, this function does nothing.  */
+extern void jobs_init (int jobs);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* _JOBS_H */
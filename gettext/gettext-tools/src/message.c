@@ -152,6 +152,7 @@ message_alloc (const char *msgctxt,
   mp->prev_msgid_plural = NULL;
   mp->used = 0;
   mp->obsolete = false;
+  mp->readonly_storage = NULL;
   return mp;
 }
 
@@ -451,6 +452,54 @@ message_list_remove_if_not (message_list_ty *mlp,
 }
 
 
+void
+message_list_remove_if_not_parallel (message_list_ty *mlp,
+                                     message_predicate_ty *predicate)
+{
+  long int nn = mlp->nitems;
+  long int jj;
+  bool *keep = XNMALLOC (nn, bool);
+  size_t i, j;
+
+  /* Tell the OpenMP capable compiler to distribute this loop across
+     several threads.  The predicate is usually cheap, therefore hand out
+     the messages in groups.  */
+  #ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic, 64)
+  #endif
+  for (jj = 0; jj < nn; jj++)
+    keep[jj] = predicate (mlp->item[jj]);
+
+  for (j = 0, i = 0; j < mlp->nitems; j++)
+    if (keep[j])
+      mlp->item[i++] = mlp->item[j];
+  if (mlp->use_hashtable && i < mlp->nitems)
+    {
+      /* Our simple-minded hash tables don't support removal.  */
+      hash_destroy (&mlp->htable);
+      mlp->use_hashtable = false;
+    }
+  mlp->nitems = i;
+
+  free (keep);
+}
+
+
+void
+message_list_for_each_parallel (message_list_ty *mlp,
+                                message_action_ty *action, void *data)
+{
+  long int nn = mlp->nitems;
+  long int jj;
+
+  #ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic, 64)
+  #endif
+  for (jj = 0; jj < nn; jj++)
+    action (mlp->item[jj], data);
+}
+
+
 bool
 message_list_msgids_changed (message_list_ty *mlp)
 {
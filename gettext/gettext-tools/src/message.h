@@ -152,6 +152,8 @@ struct altstr
 };
 
 
+struct po_readonly_storage_ty;
+
 typedef struct message_ty message_ty;
 struct message_ty
 {
@@ -225,6 +227,10 @@ struct message_ty
   /* Used for combining alternative translations, in the msgcat program.  */
   int alternative_count;
   struct altstr *alternative;
+
+  /* For a message returned by read_po_stream_readonly, the storage in which
+     its strings are located, until they are copied.  Otherwise NULL.  */
+  struct po_readonly_storage_ty *readonly_storage;
 };
 
 extern message_ty *
@@ -278,6 +284,20 @@ typedef bool message_predicate_ty (const message_ty *mp);
 extern void
        message_list_remove_if_not (message_list_ty *mlp,
                                    message_predicate_ty *predicate);
+/* Like message_list_remove_if_not, except that PREDICATE may be called on
+   several messages at the same time, from different threads.  The order of
+   the remaining messages is preserved.  */
+extern void
+       message_list_remove_if_not_parallel (message_list_ty *mlp,
+                                            message_predicate_ty *predicate);
+/* Calls ACTION on each message of MLP, with DATA as second argument.
+   ACTION may be called on several messages at the same time, from different
+   threads.  Therefore it must not modify anything but the message it is
+   given.  */
+typedef void message_action_ty (message_ty *mp, void *data);
+extern void
+       message_list_for_each_parallel (message_list_ty *mlp,
+                                       message_action_ty *action, void *data);
 /* Recompute the hash table of a message list after the msgids or msgctxts
    changed.  */
 extern bool
@@ -38,6 +38,7 @@
 #include "relocatable.h"
 #include "basename-lgpl.h"
 #include "message.h"
+#include "jobs.h"
 #include "read-catalog.h"
 #include "read-po.h"
 #include "read-properties.h"
@@ -97,6 +98,7 @@ static const struct option long_options[] =
   { "help", no_argument, NULL, 'h' },
   { "ignore-file", required_argument, NULL, CHAR_MAX + 15 },
   { "indent", no_argument, NULL, 'i' },
+  { "jobs", required_argument, NULL, 'j' },
   { "no-escape", no_argument, NULL, 'e' },
   { "no-fuzzy", no_argument, NULL, CHAR_MAX + 3 },
   { "no-location", no_argument, NULL, CHAR_MAX + 22 },
@@ -150,6 +152,7 @@ main (int argc, char **argv)
   catalog_output_format_ty output_syntax = &output_format_po;
   bool sort_by_msgid = false;
   bool sort_by_filepos = false;
+  int jobs = 0;
 
   /* Set program name for messages.  */
   set_program_name (argv[0]);
@@ -174,7 +177,7 @@ main (int argc, char **argv)
   only_file = NULL;
   ignore_file = NULL;
 
-  while ((optchar = getopt_long (argc, argv, "D:eEFhino:pPsVw:", long_options,
+  while ((optchar = getopt_long (argc, argv, "D:eEFhij:no:pPsVw:", long_options,
                                  NULL)) != EOF)
     switch (optchar)
       {
@@ -205,6 +208,10 @@ main (int argc, char **argv)
         message_print_style_indent ();
         break;
 
+      case 'j':
+        jobs = jobs_parse (optarg);
+        break;
+
       case 'n':
         if (handle_filepos_comment_option (optarg))
           usage (EXIT_FAILURE);
@@ -380,6 +387,9 @@ There is NO WARRANTY, to the extent permitted by law.\n\
     error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
            "--sort-output", "--sort-by-file");
 
+  /* Initialize OpenMP.  */
+  jobs_init (jobs);
+
   /* Read input file.  */
   result = read_catalog_file (input_file, input_syntax);
 
@@ -487,6 +497,11 @@ Attribute manipulation:\n"));
       --obsolete              synonym for --only-obsolete --clear-obsolete\n"));
       printf ("\n");
       printf (_("\
+Operation modifiers:\n"));
+      printf (_("\
+  -j, --jobs=NUMBER           use at most NUMBER threads\n"));
+      printf ("\n");
+      printf (_("\
 Input file syntax:\n"));
       printf (_("\
   -P, --properties-input      input file is in Java .properties syntax\n"));
@@ -552,7 +567,8 @@ or by email to <%s>.\n"),
 }
 
 
-/* Return true if a message should be kept.  */
+/* Return true if a message should be kept.
+   Called from several threads.  */
 static bool
 is_message_selected (const message_ty *mp)
 {
@@ -582,81 +598,97 @@ is_message_selected (const message_ty *mp)
 }
 
 
+/* The files that limit the extent of the attribute changes.  */
+struct change_data
+{
+  message_list_ty *only_mlp;
+  message_list_ty *ignore_mlp;
+};
+
+/* Change the attributes of a message.
+   Called from several threads.  */
+static void
+change_attributes (message_ty *mp, void *data_)
+{
+  const struct change_data *data = (const struct change_data *) data_;
+
+  /* Attribute changes only affect messages listed in --only-file
+     and not listed in --ignore-file.  */
+  if ((data->only_mlp
+       ? message_list_search (data->only_mlp, mp->msgctxt, mp->msgid) != NULL
+       : true)
+      && (data->ignore_mlp
+          ? message_list_search (data->ignore_mlp, mp->msgctxt, mp->msgid)
+            == NULL
+          : true))
+    {
+      if (to_change & SET_FUZZY)
+        {
+          if ((to_change & ADD_PREV) && !is_header (mp)
+              && !mp->is_fuzzy && mp->msgstr[0] != '\0')
+            {
+              mp->prev_msgctxt =
+                (mp->msgctxt != NULL ? xstrdup (mp->msgctxt) : NULL);
+              mp->prev_msgid =
+                (mp->msgid != NULL ? xstrdup (mp->msgid) : NULL);
+              mp->prev_msgid_plural =
+                (mp->msgid_plural != NULL
+                 ? xstrdup (mp->msgid_plural)
+                 : NULL);
+            }
+          mp->is_fuzzy = true;
+        }
+
+      if (to_change & RESET_FUZZY)
+        {
+          if ((to_change & REMOVE_TRANSLATION)
+              && mp->is_fuzzy && !mp->obsolete)
+            {
+              unsigned long int nplurals = 0;
+              char *msgstr;
+              size_t pos;
+
+              for (pos = 0; pos < mp->msgstr_len; ++pos)
+                if (!mp->msgstr[pos])
+                  ++nplurals;
+              free ((char *) mp->msgstr);
+              msgstr = XNMALLOC (nplurals, char);
+              memset (msgstr, '\0', nplurals);
+              mp->msgstr = msgstr;
+              mp->msgstr_len = nplurals;
+            }
+          mp->is_fuzzy = false;
+        }
+      /* Always keep the header entry non-obsolete.  */
+      if ((to_change & SET_OBSOLETE) && !is_header (mp))
+        mp->obsolete = true;
+      if (to_change & RESET_OBSOLETE)
+        mp->obsolete = false;
+      if (to_change & REMOVE_PREV)
+        {
+          mp->prev_msgctxt = NULL;
+          mp->prev_msgid = NULL;
+          mp->prev_msgid_plural = NULL;
+        }
+    }
+}
+
+
 static void
 process_message_list (message_list_ty *mlp,
                       message_list_ty *only_mlp, message_list_ty *ignore_mlp)
 {
   /* Keep only the selected messages.  */
-  message_list_remove_if_not (mlp, is_message_selected);
+  message_list_remove_if_not_parallel (mlp, is_message_selected);
 
   /* Change the attributes.  */
   if (to_change)
     {
-      size_t j;
+      struct change_data data;
 
-      for (j = 0; j < mlp->nitems; j++)
-        {
-          message_ty *mp = mlp->item[j];
-
-          /* Attribute changes only affect messages listed in --only-file
-             and not listed in --ignore-file.  */
-          if ((only_mlp
-               ? message_list_search (only_mlp, mp->msgctxt, mp->msgid) != NULL
-               : true)
-              && (ignore_mlp
-                  ? message_list_search (ignore_mlp, mp->msgctxt, mp->msgid) == NULL
-                  : true))
-            {
-              if (to_change & SET_FUZZY)
-                {
-                  if ((to_change & ADD_PREV) && !is_header (mp)
-                      && !mp->is_fuzzy && mp->msgstr[0] != '\0')
-                    {
-                      mp->prev_msgctxt =
-                        (mp->msgctxt != NULL ? xstrdup (mp->msgctxt) : NULL);
-                      mp->prev_msgid =
-                        (mp->msgid != NULL ? xstrdup (mp->msgid) : NULL);
-                      mp->prev_msgid_plural =
-                        (mp->msgid_plural != NULL
-                         ? xstrdup (mp->msgid_plural)
-                         : NULL);
-                    }
-                  mp->is_fuzzy = true;
-                }
-
-              if (to_change & RESET_FUZZY)
-                {
-                  if ((to_change & REMOVE_TRANSLATION)
-                      && mp->is_fuzzy && !mp->obsolete)
-                    {
-                      unsigned long int nplurals = 0;
-                      char *msgstr;
-                      size_t pos;
-
-                      for (pos = 0; pos < mp->msgstr_len; ++pos)
-                        if (!mp->msgstr[pos])
-                          ++nplurals;
-                      free ((char *) mp->msgstr);
-                      msgstr = XNMALLOC (nplurals, char);
-                      memset (msgstr, '\0', nplurals);
-                      mp->msgstr = msgstr;
-                      mp->msgstr_len = nplurals;
-                    }
-                  mp->is_fuzzy = false;
-                }
-              /* Always keep the header entry non-obsolete.  */
-              if ((to_change & SET_OBSOLETE) && !is_header (mp))
-                mp->obsolete = true;
-              if (to_change & RESET_OBSOLETE)
-                mp->obsolete = false;
-              if (to_change & REMOVE_PREV)
-                {
-                  mp->prev_msgctxt = NULL;
-                  mp->prev_msgid = NULL;
-                  mp->prev_msgid_plural = NULL;
-                }
-            }
-        }
+      data.only_mlp = only_mlp;
+      data.ignore_mlp = ignore_mlp;
+      message_list_for_each_parallel (mlp, change_attributes, &data);
     }
 }
 
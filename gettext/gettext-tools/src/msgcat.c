@@ -39,6 +39,7 @@
 #include "relocatable.h"
 #include "basename-lgpl.h"
 #include "message.h"
+#include "jobs.h"
 #include "read-catalog.h"
 #include "read-po.h"
 #include "read-properties.h"
@@ -72,7 +73,9 @@ static const struct option long_options[] =
   { "force-po", no_argument, &force_po, 1 },
   { "help", no_argument, NULL, 'h' },
   { "indent", no_argument, NULL, 'i' },
+  { "jobs", required_argument, NULL, 'j' },
   { "lang", required_argument, NULL, CHAR_MAX + 7 },
+  { "low-memory", no_argument, NULL, CHAR_MAX + 9 },
   { "no-escape", no_argument, NULL, 'e' },
   { "no-location", no_argument, NULL, CHAR_MAX + 8 },
   { "no-wrap", no_argument, NULL, CHAR_MAX + 2 },
@@ -117,6 +120,7 @@ main (int argc, char **argv)
   bool sort_by_filepos = false;
   /* Language (ISO-639 code) and optional territory (ISO-3166 code).  */
   const char *catalogname = NULL;
+  int jobs = 0;
 
   /* Set program name for messages.  */
   set_program_name (argv[0]);
@@ -142,7 +146,7 @@ main (int argc, char **argv)
   less_than = INT_MAX;
   use_first = false;
 
-  while ((optchar = getopt_long (argc, argv, "<:>:D:eEf:Fhino:pPst:uVw:",
+  while ((optchar = getopt_long (argc, argv, "<:>:D:eEf:Fhij:no:pPst:uVw:",
                                  long_options, NULL)) != EOF)
     switch (optchar)
       {
@@ -197,6 +201,10 @@ main (int argc, char **argv)
         message_print_style_indent ();
         break;
 
+      case 'j':
+        jobs = jobs_parse (optarg);
+        break;
+
       case 'n':
         if (handle_filepos_comment_option (optarg))
           usage (EXIT_FAILURE);
@@ -277,6 +285,10 @@ main (int argc, char **argv)
         message_print_style_filepos (filepos_comment_none);
         break;
 
+      case CHAR_MAX + 9: /* --low-memory */
+        low_memory = true;
+        break;
+
       default:
         usage (EXIT_FAILURE);
         /* NOTREACHED */
@@ -319,6 +331,9 @@ There is NO WARRANTY, to the extent permitted by law.\n\
            _("impossible selection criteria specified (%d < n < %d)"),
            more_than, less_than);
 
+  /* Initialize OpenMP.  */
+  jobs_init (jobs);
+
   /* Determine list of files we have to process.  */
   if (files_from != NULL)
     file_list = read_names_from_file (files_from);
@@ -390,6 +405,11 @@ Input file location:\n"));
       printf (_("\
   -D, --directory=DIRECTORY   add DIRECTORY to list for input files search\n"));
       printf (_("\
+      --low-memory            read each input file twice, keeping only one\n\
+                              of them in memory at a time; slower, and saves\n\
+                              memory only if most input translations are\n\
+                              dropped, e.g. with --use-first\n"));
+      printf (_("\
 If input file is -, standard input is read.\n"));
       printf ("\n");
       printf (_("\
@@ -413,6 +433,11 @@ Message selection:\n"));
                               that only unique messages be printed\n"));
       printf ("\n");
       printf (_("\
+Operation modifiers:\n"));
+      printf (_("\
+  -j, --jobs=NUMBER           use at most NUMBER threads\n"));
+      printf ("\n");
+      printf (_("\
 Input file syntax:\n"));
       printf (_("\
   -P, --properties-input      input files are in Java .properties syntax\n"));
@@ -73,6 +73,7 @@ static const struct option long_options[] =
   { "force-po", no_argument, &force_po, 1 },
   { "help", no_argument, NULL, 'h' },
   { "indent", no_argument, NULL, 'i' },
+  { "low-memory", no_argument, NULL, CHAR_MAX + 8 },
   { "no-escape", no_argument, NULL, 'e' },
   { "no-location", no_argument, NULL, CHAR_MAX + 7 },
   { "no-wrap", no_argument, NULL, CHAR_MAX + 2 },
@@ -268,6 +269,10 @@ main (int argc, char *argv[])
         message_print_style_filepos (filepos_comment_none);
         break;
 
+      case CHAR_MAX + 8: /* --low-memory */
+        low_memory = true;
+        break;
+
       default:
         usage (EXIT_FAILURE);
         /* NOTREACHED */
@@ -381,6 +386,11 @@ Input file location:\n"));
       printf (_("\
   -D, --directory=DIRECTORY   add DIRECTORY to list for input files search\n"));
       printf (_("\
+      --low-memory            read each input file twice, keeping only one\n\
+                              of them in memory at a time; slower, and saves\n\
+                              memory only if most input messages are not\n\
+                              common enough to be output\n"));
+      printf (_("\
 If input file is -, standard input is read.\n"));
       printf ("\n");
       printf (_("\
@@ -38,6 +38,7 @@
 #include "relocatable.h"
 #include "basename-lgpl.h"
 #include "message.h"
+#include "jobs.h"
 #include "read-catalog.h"
 #include "read-po.h"
 #include "read-properties.h"
@@ -67,6 +68,7 @@ static const struct option long_options[] =
   { "force-po", no_argument, &force_po, 1 },
   { "help", no_argument, NULL, 'h' },
   { "indent", no_argument, NULL, 'i' },
+  { "jobs", required_argument, NULL, 'j' },
   { "lang", required_argument, NULL, CHAR_MAX + 4 },
   { "no-escape", no_argument, NULL, 'e' },
   { "no-location", no_argument, NULL, CHAR_MAX + 7 },
@@ -104,6 +106,7 @@ main (int argc, char **argv)
   bool sort_by_msgid = false;
   /* Language (ISO-639 code) and optional territory (ISO-3166 code).  */
   const char *catalogname = NULL;
+  int jobs = 0;
 
   /* Set program name for messages.  */
   set_program_name (argv[0]);
@@ -126,7 +129,7 @@ main (int argc, char **argv)
   output_file = NULL;
 
   while ((opt = getopt_long (argc, argv,
-                             "D:eEFhin:o:pPsVw:",
+                             "D:eEFhij:n:o:pPsVw:",
                              long_options, NULL)) != EOF)
     switch (opt)
       {
@@ -157,6 +160,10 @@ main (int argc, char **argv)
         message_print_style_indent ();
         break;
 
+      case 'j':
+        jobs = jobs_parse (optarg);
+        break;
+
       case 'n':
         if (handle_filepos_comment_option (optarg))
           usage (EXIT_FAILURE);
@@ -267,6 +274,9 @@ There is NO WARRANTY, to the extent permitted by law.\n\
     error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
            "--sort-output", "--sort-by-file");
 
+  /* Initialize OpenMP.  */
+  jobs_init (jobs);
+
   /* Read input file.  */
   result = read_catalog_file (argv[optind], input_syntax);
 
@@ -332,6 +342,11 @@ The results are written to standard output if no output file is specified\n\
 or if it is -.\n"));
       printf ("\n");
       printf (_("\
+Operation modifiers:\n"));
+      printf (_("\
+  -j, --jobs=NUMBER           use at most NUMBER threads\n"));
+      printf ("\n");
+      printf (_("\
 Input file syntax:\n"));
       printf (_("\
   -P, --properties-input      input file is in Java .properties syntax\n"));
@@ -74,12 +74,16 @@ static int sub_argc;
 
 static bool newline;
 
+/* Invoke the subprogram only once, feeding it a stream of records.  */
+static bool batch;
+
 /* Maximum exit code encountered.  */
 static int exitcode;
 
 /* Long options.  */
 static const struct option long_options[] =
 {
+  { "batch", no_argument, NULL, CHAR_MAX + 3 },
   { "directory", required_argument, NULL, 'D' },
   { "help", no_argument, NULL, 'h' },
   { "input", required_argument, NULL, 'i' },
@@ -169,6 +173,10 @@ main (int argc, char **argv)
         newline = true;
         break;
 
+      case CHAR_MAX + 3: /* --batch */
+        batch = true;
+        break;
+
       default:
         usage (EXIT_FAILURE);
         break;
@@ -242,6 +250,9 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   exitcode = 0; /* = EXIT_SUCCESS */
 
   /* Apply the subprogram.  */
+  /* The built-in command "0" does not need a subprocess.  */
+  if (strcmp (sub_name, "0") == 0)
+    batch = false;
   process_msgdomain_list (result);
 
   exit (exitcode);
@@ -280,6 +291,9 @@ null byte.  The output of \"msgexec 0\" is suitable as input for \"xargs -0\".\n
 Command input:\n"));
       printf (_("\
   --newline                   add newline at the end of input\n"));
+      printf (_("\
+  --batch                     invoke COMMAND only once, and pass it all\n\
+                                translations as a stream of records\n"));
       printf ("\n");
       printf (_("\
 Mandatory arguments to long options are mandatory for short options too.\n"));
@@ -445,6 +459,100 @@ process_string (const message_ty *mp, const char *str, size_t len)
 }
 
 
+/* Output buffer for the stream of records in --batch mode.  */
+static int batch_fd;
+static char batch_buffer[16384];
+static size_t batch_buflen;
+/* True once the subprogram has stopped reading.  */
+static bool batch_broken;
+
+/* Write out the contents of batch_buffer.  */
+static void
+batch_flush (void)
+{
+  if (batch_buflen > 0 && !batch_broken)
+    {
+      if (full_write (batch_fd, batch_buffer, batch_buflen) < batch_buflen)
+        {
+          if (errno != EPIPE)
+            error (EXIT_FAILURE, errno,
+                   _("write to %s subprocess failed"), sub_name);
+          batch_broken = true;
+        }
+    }
+  batch_buflen = 0;
+}
+
+/* Append LEN bytes at DATA to the stream of records.  */
+static void
+batch_write (const char *data, size_t len)
+{
+  while (len > 0)
+    {
+      size_t n;
+
+      if (batch_buflen == sizeof (batch_buffer))
+        batch_flush ();
+      n = sizeof (batch_buffer) - batch_buflen;
+      if (n > len)
+        n = len;
+      memcpy (batch_buffer + batch_buflen, data, n);
+      batch_buflen += n;
+      data += n;
+      len -= n;
+    }
+}
+
+/* Append a field NAME=VALUE to the stream of records.  */
+static void
+batch_write_field (const char *name, const char *value)
+{
+  batch_write (name, strlen (name));
+  batch_write ("=", 1);
+  batch_write (value, strlen (value) + 1);
+}
+
+/* Append a record for the plural form K of MP, whose translation is the
+   string STR of size LEN bytes, to the stream of records.
+   The fields of a record have the same names and values as the environment
+   variables of a regular invocation, plus MSGEXEC_MSGSTR.  Each field is
+   terminated by a NUL byte, and the record is terminated by an empty field.
+ */
+static void
+batch_write_record (const message_ty *mp, size_t k, const char *str,
+                    size_t len)
+{
+  char *location;
+
+  if (mp->msgctxt != NULL)
+    batch_write_field ("MSGEXEC_MSGCTXT", mp->msgctxt);
+  batch_write_field ("MSGEXEC_MSGID", mp->msgid);
+  if (mp->msgid_plural != NULL)
+    {
+      char *plural_form_string = xasprintf ("%lu", (unsigned long) k);
+
+      batch_write_field ("MSGEXEC_MSGID_PLURAL", mp->msgid_plural);
+      batch_write_field ("MSGEXEC_PLURAL_FORM", plural_form_string);
+      free (plural_form_string);
+    }
+  location = xasprintf ("%s:%ld", mp->pos.file_name,
+                        (long) mp->pos.line_number);
+  batch_write_field ("MSGEXEC_LOCATION", location);
+  free (location);
+  if (mp->prev_msgctxt != NULL)
+    batch_write_field ("MSGEXEC_PREV_MSGCTXT", mp->prev_msgctxt);
+  if (mp->prev_msgid != NULL)
+    batch_write_field ("MSGEXEC_PREV_MSGID", mp->prev_msgid);
+  if (mp->prev_msgid_plural != NULL)
+    batch_write_field ("MSGEXEC_PREV_MSGID_PLURAL", mp->prev_msgid_plural);
+  batch_write ("MSGEXEC_MSGSTR=", 15);
+  batch_write (str, len);
+  if (newline)
+    batch_write ("\n", 1);
+  batch_write ("\0\0", 2);
+}
+
+
 static void
 process_message (const message_ty *mp)
 {
@@ -458,6 +566,13 @@ process_message (const message_ty *mp)
     {
       size_t length = strlen (p);
 
+      if (batch)
+        {
+          batch_write_record (mp, k, p, length);
+          p += length + 1;
+          continue;
+        }
+
       if (mp->msgid_plural != NULL)
         {
           char *plural_form_string = xasprintf ("%lu", (unsigned long) k);
@@ -489,6 +604,46 @@ process_msgdomain_list (const msgdomain_list_ty *mdlp)
 {
   size_t k;
 
+  if (batch)
+    {
+      /* Invoke the subprogram once, and feed it all records.  */
+      pid_t child;
+      int fd[1];
+      void (*orig_sigpipe_handler)(int);
+      int exitstatus;
+
+      unsetenv ("MSGEXEC_MSGCTXT");
+      unsetenv ("MSGEXEC_MSGID");
+      unsetenv ("MSGEXEC_MSGID_PLURAL");
+      unsetenv ("MSGEXEC_LOCATION");
+      unsetenv ("MSGEXEC_PLURAL_FORM");
+      unsetenv ("MSGEXEC_PREV_MSGCTXT");
+      unsetenv ("MSGEXEC_PREV_MSGID");
+      unsetenv ("MSGEXEC_PREV_MSGID_PLURAL");
+
+      child = create_pipe_out (sub_name, sub_path, sub_argv, NULL, false, true,
+                               true, fd);
+      batch_fd = fd[0];
+
+      /* Ignore SIGPIPE here.  We don't care if the subprocess terminates
+         successfully without having read all of the input that we feed it.  */
+      orig_sigpipe_handler = signal (SIGPIPE, SIG_IGN);
+
+      for (k = 0; k < mdlp->nitems; k++)
+        process_message_list (mdlp->item[k]->messages);
+      batch_flush ();
+
+      close (fd[0]);
+
+      signal (SIGPIPE, orig_sigpipe_handler);
+
+      exitstatus =
+        wait_subprocess (child, sub_name, false, false, true, true, NULL);
+      if (exitcode < exitstatus)
+        exitcode = exitstatus;
+      return;
+    }
+
   for (k = 0; k < mdlp->nitems; k++)
     process_message_list (mdlp->item[k]->messages);
 }
@@ -85,6 +85,9 @@ static int sub_argc;
 
 static bool newline;
 
+/* Feed all translations to a single subprogram, separated by NUL bytes.  */
+static bool null_data;
+
 /* Filter function.  */
 static void (*filter) (const char *str, size_t len, char **resultp, size_t *lengthp);
 
@@ -104,6 +107,7 @@ static const struct option long_options[] =
   { "no-escape", no_argument, NULL, CHAR_MAX + 2 },
   { "no-location", no_argument, NULL, CHAR_MAX + 8 },
   { "no-wrap", no_argument, NULL, CHAR_MAX + 3 },
+  { "null-data", no_argument, NULL, CHAR_MAX + 10 },
   { "output-file", required_argument, NULL, 'o' },
   { "properties-input", no_argument, NULL, 'P' },
   { "properties-output", no_argument, NULL, 'p' },
@@ -272,6 +276,10 @@ main (int argc, char **argv)
         newline = true;
         break;
 
+      case CHAR_MAX + 10: /* --null-data */
+        null_data = true;
+        break;
+
       default:
         usage (EXIT_FAILURE);
         break;
@@ -445,7 +453,10 @@ and writes a modified translation to standard output.\n\
 Filter input and output:\n"));
       printf (_("\
   --newline                   add a newline at the end of input and\n\
-                                remove a newline from the end of output"));
+                                remove a newline from the end of output\n"));
+      printf (_("\
+  --null-data                 invoke FILTER only once, separating the\n\
+                                translations by NUL bytes\n"));
       printf ("\n");
       printf (_("\
 Useful FILTER-OPTIONs when the FILTER is 'sed':\n"));
@@ -789,11 +800,166 @@ process_message_list (message_list_ty *mlp)
 }
 
 
+/* Process all translations through a single invocation of the subprogram.
+   Each translation - each plural form separately - is passed to it
+   terminated by a NUL byte, and it is expected to output one NUL terminated
+   result per translation, in the same order.  The subprogram runs
+   concurrently with the writing and the reading, therefore it does not
+   need to flush its output after each record.  */
+static void
+process_msgdomain_list_null_data (msgdomain_list_ty *mdlp)
+{
+  struct locals l;
+  char *input;
+  size_t input_length;
+  size_t nrecords;
+  char *q;
+  const char *record;
+  const char *output_end;
+  size_t k;
+  size_t j;
+
+  /* Concatenate the input records.  */
+  input_length = 0;
+  nrecords = 0;
+  for (k = 0; k < mdlp->nitems; k++)
+    {
+      message_list_ty *mlp = mdlp->item[k]->messages;
+
+      for (j = 0; j < mlp->nitems; j++)
+        {
+          message_ty *mp = mlp->item[j];
+          const char *p;
+
+          if (is_header (mp) && keep_header)
+            continue;
+
+          for (p = mp->msgstr;
+               p < mp->msgstr + mp->msgstr_len;
+               p += strlen (p) + 1, nrecords++)
+            input_length += strlen (p) + (newline ? 2 : 1);
+        }
+    }
+  if (nrecords == 0)
+    return;
+
+  input = XNMALLOC (input_length, char);
+  q = input;
+  for (k = 0; k < mdlp->nitems; k++)
+    {
+      message_list_ty *mlp = mdlp->item[k]->messages;
+
+      for (j = 0; j < mlp->nitems; j++)
+        {
+          message_ty *mp = mlp->item[j];
+          const char *p;
+
+          if (is_header (mp) && keep_header)
+            continue;
+
+          for (p = mp->msgstr; p < mp->msgstr + mp->msgstr_len; )
+            {
+              size_t len = strlen (p);
+
+              memcpy (q, p, len);
+              q += len;
+              if (newline)
+                *q++ = '\n';
+              *q++ = '\0';
+              p += len + 1;
+            }
+        }
+    }
+
+  /* Run the subprogram once.  */
+  l.str = input;
+  l.len = input_length;
+  l.allocated = input_length + (input_length >> 2) + 1;
+  l.result = XNMALLOC (l.allocated, char);
+  l.length = 0;
+
+  pipe_filter_ii_execute (sub_name, sub_path, sub_argv, false, true,
+                          prepare_write, done_write, prepare_read, done_read,
+                          &l);
+
+  free (input);
+
+  /* Split the output into records and distribute them among the messages.
+     The NUL byte after the last record is optional.  */
+  record = l.result;
+  output_end = l.result + l.length;
+  for (k = 0; k < mdlp->nitems; k++)
+    {
+      message_list_ty *mlp = mdlp->item[k]->messages;
+
+      for (j = 0; j < mlp->nitems; j++)
+        {
+          message_ty *mp = mlp->item[j];
+          const char *p;
+          char *msgstr;
+          size_t msgstr_len;
+
+          if (is_header (mp) && keep_header)
+            continue;
+
+          msgstr = NULL;
+          msgstr_len = 0;
+          for (p = mp->msgstr;
+               p < mp->msgstr + mp->msgstr_len;
+               p += strlen (p) + 1)
+            {
+              const char *record_end;
+              size_t len;
+
+              if (record == output_end)
+                error (EXIT_FAILURE, 0,
+                       _("filter output does not contain one NUL terminated record per translation"));
+              record_end =
+                (const char *) memchr (record, '\0', output_end - record);
+              if (record_end == NULL)
+                record_end = output_end;
+              len = record_end - record;
+
+              if (newline)
+                {
+                  if (len > 0 && record[len - 1] == '\n')
+                    len--;
+                  else
+                    error (0, 0,
+                           _("filter output is not terminated with a newline"));
+                }
+
+              msgstr = (char *) xrealloc (msgstr, msgstr_len + len + 1);
+              memcpy (msgstr + msgstr_len, record, len);
+              msgstr[msgstr_len + len] = '\0';
+              msgstr_len += len + 1;
+
+              record = (record_end < output_end ? record_end + 1 : output_end);
+            }
+
+          mp->msgstr = msgstr;
+          mp->msgstr_len = msgstr_len;
+        }
+    }
+  if (record != output_end)
+    error (EXIT_FAILURE, 0,
+           _("filter output does not contain one NUL terminated record per translation"));
+
+  free (l.result);
+}
+
+
 static msgdomain_list_ty *
 process_msgdomain_list (msgdomain_list_ty *mdlp)
 {
   size_t k;
 
+  if (null_data && filter == generic_filter)
+    {
+      process_msgdomain_list_null_data (mdlp);
+      return mdlp;
+    }
+
   for (k = 0; k < mdlp->nitems; k++)
     process_message_list (mdlp->item[k]->messages);
 
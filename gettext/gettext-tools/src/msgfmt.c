@@ -30,6 +30,10 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <assert.h>
+#include <errno.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 #include "noreturn.h"
 #include "closeout.h"
@@ -43,6 +47,10 @@
 #include "xerror.h"
 #include "xvasprintf.h"
 #include "xalloc.h"
+#include "read-file.h"
+#include "supersede.h"
+#include "fwriteerror.h"
+#include "sha1.h"
 #include "msgfmt.h"
 #include "write-mo.h"
 #include "write-java.h"
@@ -60,8 +68,10 @@
 #include "read-properties.h"
 #include "read-stringtable.h"
 #include "read-desktop.h"
+#include "po-error.h"
 #include "po-charset.h"
 #include "msgl-check.h"
+#include "format.h"
 #include "msgl-iconv.h"
 #include "concat-filename.h"
 #include "its.h"
@@ -85,6 +95,12 @@ static bool include_untranslated = false;
 /* Specifies name of the output file.  */
 static const char *output_file_name;
 
+/* Bulk .mo mode: base directory of the .po files and of the output files.  */
+static const char *mo_base_directory;
+
+/* Directory of previously compiled .mo files, or NULL.  */
+static const char *cache_directory;
+
 /* Java mode output file specification.  */
 static bool java_mode;
 static bool assume_java2;
@@ -92,6 +108,7 @@ static const char *java_resource_name;
 static const char *java_locale_name;
 static const char *java_class_directory;
 static bool java_output_source;
+static bool java_class_directly;
 
 /* C# mode output file specification.  */
 static bool csharp_mode;
@@ -181,6 +198,8 @@ static int do_statistics;
 static const struct option long_options[] =
 {
   { "alignment", required_argument, NULL, 'a' },
+  { "bloom-filter", no_argument, NULL, CHAR_MAX + 19 },
+  { "cache-dir", required_argument, NULL, CHAR_MAX + 17 },
   { "check", no_argument, NULL, 'c' },
   { "check-accelerators", optional_argument, NULL, CHAR_MAX + 1 },
   { "check-compatibility", no_argument, NULL, 'C' },
@@ -199,7 +218,9 @@ static const struct option long_options[] =
   { "language", required_argument, NULL, 'L' },
   { "locale", required_argument, NULL, 'l' },
   { "no-hash", no_argument, NULL, CHAR_MAX + 6 },
+  { "no-javac", no_argument, NULL, CHAR_MAX + 20 },
   { "output-file", required_argument, NULL, 'o' },
+  { "perfect-hash", no_argument, NULL, CHAR_MAX + 18 },
   { "properties-input", no_argument, NULL, 'P' },
   { "qt", no_argument, NULL, CHAR_MAX + 9 },
   { "resource", required_argument, NULL, 'r' },
@@ -233,6 +254,14 @@ static int msgfmt_xml_bulk (const char *directory,
                             const char *template_file_name,
                             its_rule_list_ty *its_rules,
                             const char *file_name);
+static int msgfmt_mo_bulk (const char *directory);
+static bool msgfmt_cache_key (char **files, int nfiles,
+                              catalog_input_format_ty input_syntax,
+                              bool strict_uniforum, char *key);
+static bool msgfmt_cache_retrieve (const char *key, const char *file_name);
+static void msgfmt_cache_watch_warnings (void);
+static bool msgfmt_cache_warnings_seen (void);
+static void msgfmt_cache_store (const char *key, const char *file_name);
 
 
 int
@@ -246,6 +275,9 @@ main (int argc, char *argv[])
   int arg_i;
   const char *canon_encoding;
   struct msg_domain *domain;
+  bool mo_bulk_mode;
+  char cache_key[2 * SHA1_DIGEST_SIZE + 1];
+  bool use_cache = false;
 
   /* Set default value for global variables.  */
   alignment = DEFAULT_OUTPUT_ALIGNMENT;
@@ -298,6 +330,7 @@ main (int argc, char *argv[])
         tcl_base_directory = optarg;
         desktop_base_directory = optarg;
         xml_base_directory = optarg;
+        mo_base_directory = optarg;
         break;
       case 'D':
         dir_list_append (optarg);
@@ -428,6 +461,18 @@ main (int argc, char *argv[])
         desktop_template_name = optarg;
         xml_template_name = optarg;
         break;
+      case CHAR_MAX + 17: /* --cache-dir=DIRECTORY */
+        cache_directory = optarg;
+        break;
+      case CHAR_MAX + 18: /* --perfect-hash */
+        perfect_hash_table = true;
+        break;
+      case CHAR_MAX + 19: /* --bloom-filter */
+        bloom_filter = true;
+        break;
+      case CHAR_MAX + 20: /* --no-javac */
+        java_class_directly = true;
+        break;
       default:
         usage (EXIT_FAILURE);
         break;
@@ -453,10 +498,17 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   if (do_help)
     usage (EXIT_SUCCESS);
 
+  /* In the default .mo mode, the -d option selects the bulk mode.  */
+  mo_bulk_mode =
+    (mo_base_directory != NULL
+     && !java_mode && !csharp_mode && !csharp_resources_mode && !tcl_mode
+     && !qt_mode && !desktop_mode && !xml_mode);
+
   /* Test whether we have a .po file name as argument.  */
   if (optind >= argc
       && !(desktop_mode && desktop_base_directory)
-      && !(xml_mode && xml_base_directory))
+      && !(xml_mode && xml_base_directory)
+      && !mo_bulk_mode)
     {
       error (EXIT_SUCCESS, 0, _("no input file given"));
       usage (EXIT_FAILURE);
@@ -470,6 +522,13 @@ There is NO WARRANTY, to the extent permitted by law.\n\
              desktop_mode ? "--desktop" : "--xml", "-d");
       usage (EXIT_FAILURE);
     }
+  if (optind < argc && mo_bulk_mode)
+    {
+      error (EXIT_SUCCESS, 0,
+             _("no input file should be given if %s is specified"),
+             "-d");
+      usage (EXIT_FAILURE);
+    }
 
   /* Check for contradicting options.  */
   {
@@ -509,6 +568,11 @@ There is NO WARRANTY, to the extent permitted by law.\n\
           error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
                  "--java", "--output-file");
         }
+      if (java_output_source && java_class_directly)
+        {
+          error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
+                 "--source", "--no-javac");
+        }
       if (java_class_directory == NULL)
         {
           error (EXIT_SUCCESS, 0,
@@ -631,12 +695,43 @@ There is NO WARRANTY, to the extent permitted by law.\n\
                  "--locale", "--java", "--csharp", "--tcl");
           usage (EXIT_FAILURE);
         }
-      if (java_class_directory != NULL)
+      if (java_class_directory != NULL && !mo_bulk_mode)
         {
           error (EXIT_SUCCESS, 0, _("%s is only valid with %s, %s or %s"),
                  "-d", "--java", "--csharp", "--tcl");
           usage (EXIT_FAILURE);
         }
+      if (mo_bulk_mode && output_file_name != NULL)
+        {
+          error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
+                 "-d", "--output-file");
+        }
+    }
+
+  if (cache_directory != NULL)
+    {
+      /* The cache is only supported for a single .mo file output.  */
+      if (java_mode || csharp_mode || csharp_resources_mode || tcl_mode
+          || qt_mode || desktop_mode || xml_mode)
+        error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
+               "--cache-dir",
+               java_mode ? "--java" :
+               csharp_mode ? "--csharp" :
+               csharp_resources_mode ? "--csharp-resources" :
+               tcl_mode ? "--tcl" :
+               qt_mode ? "--qt" :
+               desktop_mode ? "--desktop" :
+               "--xml");
+      if (mo_bulk_mode)
+        error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
+               "--cache-dir", "-d");
+      if (output_file_name == NULL)
+        {
+          error (EXIT_SUCCESS, 0,
+                 _("%s requires a \"-o file\" specification"),
+                 "--cache-dir");
+          usage (EXIT_FAILURE);
+        }
     }
 
   if (desktop_mode && desktop_default_keywords)
@@ -721,6 +816,19 @@ There is NO WARRANTY, to the extent permitted by law.\n\
       exit (exit_status);
     }
 
+  /* Bulk processing mode for .mo files.
+     Process all .po files in mo_base_directory.  */
+  if (mo_bulk_mode)
+    {
+      /* Initialize OpenMP.  */
+      #ifdef _OPENMP
+      openmp_init ();
+      #endif
+
+      exit_status = msgfmt_mo_bulk (mo_base_directory);
+      exit (exit_status);
+    }
+
   /* The -o option determines the name of the domain and therefore
      the output file.  */
   if (output_file_name != NULL)
@@ -730,6 +838,21 @@ There is NO WARRANTY, to the extent permitted by law.\n\
                   ? add_mo_suffix (output_file_name)
                   : output_file_name);
 
+  /* Reuse a previously compiled .mo file for the same input, if possible.
+     A cache hit skips the compilation, therefore don't use the cache when
+     the compilation is expected to print something.  */
+  if (cache_directory != NULL && strcmp (output_file_name, "-") != 0
+      && !do_statistics && !verbose)
+    {
+      use_cache = msgfmt_cache_key (argv + optind, argc - optind,
+                                    input_syntax, strict_uniforum, cache_key);
+      if (use_cache
+          && msgfmt_cache_retrieve (cache_key, current_domain->file_name))
+        exit (exit_status);
+      if (use_cache)
+        msgfmt_cache_watch_warnings ();
+    }
+
   /* Process all given .po files.  */
   for (arg_i = optind; arg_i < argc; arg_i++)
     {
@@ -785,7 +908,7 @@ There is NO WARRANTY, to the extent permitted by law.\n\
           if (msgdomain_write_java (domain->mlp, canon_encoding,
                                     java_resource_name, java_locale_name,
                                     java_class_directory, assume_java2,
-                                    java_output_source))
+                                    java_output_source, java_class_directly))
             exit_status = EXIT_FAILURE;
         }
       else if (csharp_mode)
@@ -840,6 +963,9 @@ There is NO WARRANTY, to the extent permitted by law.\n\
           if (msgdomain_write_mo (domain->mlp, domain->domain_name,
                                   domain->file_name))
             exit_status = EXIT_FAILURE;
+          else if (use_cache && exit_status == EXIT_SUCCESS
+                   && !msgfmt_cache_warnings_seen ())
+            msgfmt_cache_store (cache_key, domain->file_name);
         }
 
       /* List is not used anymore.  */
@@ -951,6 +1077,9 @@ Output file location:\n"));
       --strict                enable strict Uniforum mode\n"));
       printf (_("\
 If output file is -, output is written to standard output.\n"));
+      printf (_("\
+  -d DIRECTORY                compile each DIRECTORY/LL.po listed in\n\
+                                DIRECTORY/LINGUAS into DIRECTORY/LL.gmo\n"));
       printf ("\n");
       printf (_("\
 Output file location in Java mode:\n"));
@@ -961,6 +1090,9 @@ Output file location in Java mode:\n"));
       printf (_("\
       --source                produce a .java file, instead of a .class file\n"));
       printf (_("\
+      --no-javac              write the .class file directly, without a Java\n\
+                              compiler\n"));
+      printf (_("\
   -d DIRECTORY                base directory of classes directory hierarchy\n"));
       printf (_("\
 The class name is determined by appending the locale name to the resource name,\n\
@@ -1060,6 +1192,15 @@ Output details:\n"));
                                 (big or little, default depends on platform)\n"));
       printf (_("\
       --no-hash               binary file will not include the hash table\n"));
+      printf (_("\
+      --perfect-hash          binary file will include a perfect hash table,\n\
+                                for faster lookups\n"));
+      printf (_("\
+      --bloom-filter          binary file will include a Bloom filter, for\n\
+                                faster lookups of untranslated messages\n"));
+      printf (_("\
+      --cache-dir=DIRECTORY   reuse the .mo files compiled earlier from the\n\
+                                same input with the same options\n"));
       printf ("\n");
       printf (_("\
 Informative output:\n"));
@@ -1200,7 +1341,8 @@ msgfmt_set_domain (default_catalog_reader_ty *this, char *name)
   /* If no output file was given, we change it with each 'domain'
      directive.  */
   if (!java_mode && !csharp_mode && !csharp_resources_mode && !tcl_mode
-      && !qt_mode && !desktop_mode && !xml_mode && output_file_name == NULL)
+      && !qt_mode && !desktop_mode && !xml_mode && output_file_name == NULL
+      && mo_base_directory == NULL)
     {
       size_t correct;
 
@@ -1561,6 +1703,10 @@ msgfmt_operand_list_add_from_directory (msgfmt_operand_list_ty *operands,
   saved_dir_list = dir_list_save_reset ();
   dir_list_append (directory);
 
+  /* The catalogs share their msgids.  Parse their format strings only
+     once.  */
+  formatstring_cache_enable ();
+
   /* Read all .po files.  */
   for (i = 0; i < languages.nitems; i++)
     {
@@ -1615,6 +1761,7 @@ msgfmt_operand_list_add_from_directory (msgfmt_operand_list_ty *operands,
       msgfmt_operand_list_append (operands, language, mlp);
     }
 
+  formatstring_cache_disable ();
   string_list_destroy (&languages);
   dir_list_restore (saved_dir_list);
 
@@ -1688,3 +1835,310 @@ msgfmt_xml_bulk (const char *directory,
 
   return status;
 }
+
+/* Helper function to support 'bulk' operation mode of .mo output.
+   This reads all .po files in DIRECTORY and compiles each LL.po into
+   LL.gmo in the same directory, in a single process.  The .po files are
+   read and checked one after the other, because the parser and the checks
+   use global state.  The .mo files are then written in parallel.
+   Currently it does not support some options available in 'iterative'
+   mode, such as --statistics.  */
+static int
+msgfmt_mo_bulk (const char *directory)
+{
+  string_list_ty languages;
+  void *saved_dir_list;
+  message_list_ty **mlps;
+  int retval = 0;
+  size_t i;
+
+  string_list_init (&languages);
+  get_languages (&languages, directory);
+
+  /* Reset the directory search list so only .po files under DIRECTORY
+     will be read.  */
+  saved_dir_list = dir_list_save_reset ();
+  dir_list_append (directory);
+
+  /* The catalogs share their msgids.  Parse their format strings only
+     once.  */
+  formatstring_cache_enable ();
+
+  mlps = XNMALLOC (languages.nitems, message_list_ty *);
+  for (i = 0; i < languages.nitems; i++)
+    {
+      const char *language = languages.item[i];
+      message_list_ty *mlp;
+      char *input_file_name;
+      int nerrors;
+
+      current_domain = new_domain (MESSAGE_DOMAIN_DEFAULT,
+                                   add_mo_suffix (MESSAGE_DOMAIN_DEFAULT));
+
+      input_file_name = xconcatenated_filename ("", language, ".po");
+      read_catalog_file_msgfmt (input_file_name, &input_format_po);
+      free (input_file_name);
+
+      /* The domain directive is not supported in the bulk execution mode.
+         Thus, domain_list should always contain a single domain.  */
+      assert (current_domain == domain_list && domain_list->next == NULL);
+      mlp = current_domain->mlp;
+      free (current_domain);
+      current_domain = domain_list = NULL;
+
+      /* Remove obsolete messages.  They were only needed for duplicate
+         checking.  */
+      message_list_remove_if_not (mlp, is_nonobsolete);
+
+      /* Perform all kinds of checks: plural expressions, format
+         strings, ...  */
+      nerrors =
+        check_message_list (mlp,
+                            /* Untranslated and fuzzy messages have already
+                               been dealt with during parsing, see below in
+                               msgfmt_frob_new_message.  */
+                            0, 0,
+                            1, check_format_strings, check_header,
+                            check_compatibility,
+                            check_accelerators, accelerator_char);
+
+      if (nerrors > 0)
+        {
+          error (0, 0,
+                 ngettext ("found %d fatal error", "found %d fatal errors",
+                           nerrors),
+                 nerrors);
+          retval = 1;
+          message_list_free (mlp, 0);
+          mlp = NULL;
+        }
+
+      mlps[i] = mlp;
+    }
+
+  formatstring_cache_disable ();
+
+  /* The catalogs are independent from each other, and msgdomain_write_mo
+     modifies only the message list it is given.  Tell the OpenMP capable
+     compiler to distribute this loop across several threads.  The schedule
+     is dynamic, because the catalogs can differ a lot in size.  */
+  {
+    long int nn = languages.nitems;
+    long int jj;
+    int nfailures = 0;
+
+    #ifdef _OPENMP
+     #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (jj = 0; jj < nn; jj++)
+      if (mlps[jj] != NULL)
+        {
+          char *mo_file_name =
+            xconcatenated_filename (directory, languages.item[jj], ".gmo");
+
+          if (msgdomain_write_mo (mlps[jj], MESSAGE_DOMAIN_DEFAULT,
+                                  mo_file_name))
+            {
+              #ifdef _OPENMP
+               #pragma omp atomic
+              #endif
+              nfailures++;
+            }
+          free (mo_file_name);
+
+          message_list_free (mlps[jj], 0);
+        }
+
+    if (nfailures > 0)
+      retval = 1;
+  }
+
+  free (mlps);
+  string_list_destroy (&languages);
+  dir_list_restore (saved_dir_list);
+
+  return (retval ? EXIT_FAILURE : exit_status);
+}
+
+
+/* Support for the --cache-dir option.
+   A cache entry is a file whose name is the SHA-1 digest, in hexadecimal,
+   of a description of the input, and that contains the .mo file compiled
+   from it.  An entry is only stored if the compilation produced neither
+   errors nor warnings, so that a cache hit, which does not read the input,
+   changes nothing that the user sees.  */
+
+/* Computes the cache key for compiling the FILES[0..NFILES-1] into a
+   single .mo file: the SHA-1 digest of a description of all options that
+   influence the output or the success of the compilation, followed by the
+   file names and SHA-1 digests of the input files.  Stores it in KEY, as
+   a NUL-terminated string of 2 * SHA1_DIGEST_SIZE hexadecimal digits.
+   Returns false if the input cannot be cached, namely when it is read
+   from standard input.  */
+static bool
+msgfmt_cache_key (char **files, int nfiles,
+                  catalog_input_format_ty input_syntax,
+                  bool strict_uniforum, char *key)
+{
+  struct sha1_ctx ctx;
+  unsigned char digest[SHA1_DIGEST_SIZE];
+  char *options;
+  int i;
+
+  for (i = 0; i < nfiles; i++)
+    if (strcmp (files[i], "-") == 0)
+      return false;
+
+  sha1_init_ctx (&ctx);
+
+  options =
+    xasprintf ("msgfmt %s\n"
+               "syntax=%s fuzzy=%d untranslated=%d alignment=%lu byteswap=%d"
+               " no-hash=%d perfect-hash=%d bloom-filter=%d strict=%d\n"
+               "check-format=%d check-header=%d check-domain=%d"
+               " check-compatibility=%d check-accelerators=%d%c\n",
+               VERSION,
+               (input_syntax == &input_format_properties ? "properties" :
+                input_syntax == &input_format_stringtable ? "stringtable" :
+                "po"),
+               include_fuzzies, include_untranslated,
+               (unsigned long) alignment, byteswap, no_hash_table,
+               perfect_hash_table, bloom_filter, strict_uniforum,
+               check_format_strings, check_header, check_domain,
+               check_compatibility, check_accelerators, accelerator_char);
+  sha1_process_bytes (options, strlen (options), &ctx);
+  free (options);
+
+  for (i = 0; i < nfiles; i++)
+    {
+      char *real_filename;
+      FILE *fp = open_catalog_file (files[i], &real_filename, true);
+
+      if (sha1_stream (fp, digest) != 0)
+        error (EXIT_FAILURE, errno, _("error while reading \"%s\""),
+               real_filename);
+      fclose (fp);
+
+      sha1_process_bytes ("file ", 5, &ctx);
+      sha1_process_bytes (files[i], strlen (files[i]) + 1, &ctx);
+      sha1_process_bytes (digest, SHA1_DIGEST_SIZE, &ctx);
+      free (real_filename);
+    }
+
+  sha1_finish_ctx (&ctx, digest);
+  for (i = 0; i < SHA1_DIGEST_SIZE; i++)
+    sprintf (key + 2 * i, "%02x", digest[i]);
+  return true;
+}
+
+/* Returns the file name of the cache entry for the given KEY.  */
+static char *
+cache_entry_file_name (const char *key)
+{
+  return xconcatenated_filename (cache_directory, key, ".mo");
+}
+
+/* Looks up the .mo file compiled from the input described by KEY in the
+   cache, and writes it to FILE_NAME.  Returns true if found.  */
+static bool
+msgfmt_cache_retrieve (const char *key, const char *file_name)
+{
+  char *entry_file_name = cache_entry_file_name (key);
+  size_t contents_length;
+  char *contents = read_file (entry_file_name, RF_BINARY, &contents_length);
+  bool found = false;
+
+  if (contents != NULL)
+    {
+      struct supersede_final_action action;
+      FILE *output_file;
+
+      /* Supersede, don't overwrite, the output file, like
+         msgdomain_write_mo does.  */
+      output_file = fopen_supersede (file_name, "wb", true, true, &action);
+      if (output_file == NULL)
+        error (EXIT_FAILURE, errno,
+               _("error while opening \"%s\" for writing"), file_name);
+      fwrite (contents, contents_length, 1, output_file);
+      if (fwriteerror_supersede (output_file, &action))
+        error (EXIT_FAILURE, errno, _("error while writing \"%s\" file"),
+               file_name);
+      found = true;
+      free (contents);
+    }
+
+  free (entry_file_name);
+  return found;
+}
+
+/* The po_multiline_warning handler that was installed before
+   msgfmt_cache_watch_warnings was called.  */
+static void (*cache_saved_multiline_warning) (char *prefix, char *message);
+
+/* The number of errors and warnings emitted through error() and
+   error_at_line() before msgfmt_cache_watch_warnings was called.  */
+static unsigned int cache_saved_error_message_count;
+
+/* Whether a warning has been emitted through po_multiline_warning since
+   msgfmt_cache_watch_warnings was called.  */
+static bool cache_multiline_warning_seen;
+
+static void
+cache_multiline_warning (char *prefix, char *message)
+{
+  cache_multiline_warning_seen = true;
+  cache_saved_multiline_warning (prefix, message);
+}
+
+/* Starts recording whether the compilation emits warnings.  */
+static void
+msgfmt_cache_watch_warnings (void)
+{
+  cache_saved_error_message_count = error_message_count;
+  cache_multiline_warning_seen = false;
+  cache_saved_multiline_warning = po_multiline_warning;
+  po_multiline_warning = cache_multiline_warning;
+}
+
+/* Returns true if the compilation has emitted warnings or errors since
+   msgfmt_cache_watch_warnings was called.  */
+static bool
+msgfmt_cache_warnings_seen (void)
+{
+  return (error_message_count != cache_saved_error_message_count
+          || cache_multiline_warning_seen);
+}
+
+/* Stores the .mo file FILE_NAME, compiled from the input described by KEY,
+   in the cache.  Failures are not fatal: the cache is only an
+   optimization.  */
+static void
+msgfmt_cache_store (const char *key, const char *file_name)
+{
+  size_t contents_length;
+  char *contents = read_file (file_name, RF_BINARY, &contents_length);
+
+  if (contents != NULL)
+    {
+      char *entry_file_name = cache_entry_file_name (key);
+      struct supersede_final_action action;
+      /* Create the cache entry atomically, so that concurrent msgfmt
+         processes never see a partially written entry.  */
+      FILE *fp =
+        fopen_supersede (entry_file_name, "wb", true, true, &action);
+
+      if (fp != NULL)
+        {
+          fwrite (contents, contents_length, 1, fp);
+          if (fwriteerror_supersede (fp, &action))
+            error (0, errno, _("error while writing \"%s\" file"),
+                   entry_file_name);
+        }
+      else
+        error (0, errno, _("error while opening \"%s\" for writing"),
+               entry_file_name);
+
+      free (entry_file_name);
+      free (contents);
+    }
+}
@@ -30,6 +30,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 #include <unistd.h>
 #if defined _MSC_VER || defined __MINGW32__
@@ -49,6 +52,7 @@
 #include "relocatable.h"
 #include "basename-lgpl.h"
 #include "message.h"
+#include "jobs.h"
 #include "read-catalog.h"
 #include "read-po.h"
 #include "read-properties.h"
@@ -87,7 +91,9 @@ struct grep_task {
   char *patterns;
   size_t patterns_size;
   bool case_insensitive;
-  void *compiled_patterns;
+  /* The compiled patterns, one copy for each thread, because a compiled
+     pattern cannot be used by several threads at the same time.  */
+  void **compiled_patterns;
 };
 static struct grep_task grep_task[5];
 
@@ -109,6 +115,7 @@ static const struct option long_options[] =
   { "ignore-case", no_argument, NULL, 'i' },
   { "indent", no_argument, NULL, CHAR_MAX + 2 },
   { "invert-match", no_argument, NULL, 'v' },
+  { "jobs", required_argument, NULL, 'j' },
   { "location", required_argument, NULL, 'N' },
   { "msgctxt", no_argument, NULL, 'J' },
   { "msgid", no_argument, NULL, 'K' },
@@ -152,6 +159,8 @@ main (int argc, char **argv)
   catalog_output_format_ty output_syntax = &output_format_po;
   bool sort_by_filepos = false;
   bool sort_by_msgid = false;
+  int jobs = 0;
+  int nthreads;
   size_t i;
 
   /* Set program name for messages.  */
@@ -189,7 +198,7 @@ main (int argc, char **argv)
       gt->case_insensitive = false;
     }
 
-  while ((opt = getopt_long (argc, argv, "CD:e:Ef:FhiJKM:n:N:o:pPTvVw:X",
+  while ((opt = getopt_long (argc, argv, "CD:e:Ef:Fhij:JKM:n:N:o:pPTvVw:X",
                              long_options, NULL))
          != EOF)
     switch (opt)
@@ -291,6 +300,10 @@ main (int argc, char **argv)
         grep_task[grep_pass].case_insensitive = true;
         break;
 
+      case 'j':
+        jobs = jobs_parse (optarg);
+        break;
+
       case 'J':
         grep_pass = 0;
         break;
@@ -440,6 +453,14 @@ There is NO WARRANTY, to the extent permitted by law.\n\
     error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
            "--sort-output", "--sort-by-file");
 
+  /* Initialize OpenMP.  */
+  jobs_init (jobs);
+  #ifdef _OPENMP
+  nthreads = omp_get_max_threads ();
+  #else
+  nthreads = 1;
+  #endif
+
   /* Compile the patterns.  */
   for (grep_pass = 0; grep_pass < 5; grep_pass++)
     {
@@ -447,15 +468,19 @@ There is NO WARRANTY, to the extent permitted by law.\n\
 
       if (gt->pattern_count > 0)
         {
+          int t;
+
           if (gt->patterns_size > 0)
             {
               /* Strip trailing newline.  */
               assert (gt->patterns[gt->patterns_size - 1] == '\n');
               gt->patterns_size--;
             }
-          gt->compiled_patterns =
-            gt->matcher->compile (gt->patterns, gt->patterns_size,
-                                  gt->case_insensitive, false, false, '\n');
+          gt->compiled_patterns = XNMALLOC (nthreads, void *);
+          for (t = 0; t < nthreads; t++)
+            gt->compiled_patterns[t] =
+              gt->matcher->compile (gt->patterns, gt->patterns_size,
+                                    gt->case_insensitive, false, false, '\n');
         }
     }
 
@@ -577,6 +602,11 @@ expressions if -E is given, or fixed strings if -F is given.\n\
 "));
       printf ("\n");
       printf (_("\
+Operation modifiers:\n"));
+      printf (_("\
+  -j, --jobs=NUMBER           use at most NUMBER threads\n"));
+      printf ("\n");
+      printf (_("\
 Input file syntax:\n"));
       printf (_("\
   -P, --properties-input      input file is in Java .properties syntax\n"));
@@ -688,11 +718,16 @@ is_string_selected (int grep_pass, const char *str, size_t len)
 
   if (gt->pattern_count > 0)
     {
+      #ifdef _OPENMP
+      int thread = omp_get_thread_num ();
+      #else
+      int thread = 0;
+      #endif
       size_t match_size;
       size_t match_offset;
 
       match_offset =
-        gt->matcher->execute (gt->compiled_patterns, str, len,
+        gt->matcher->execute (gt->compiled_patterns[thread], str, len,
                               &match_size, false);
       return (match_offset != (size_t) -1);
     }
@@ -816,7 +851,8 @@ is_message_selected_no_invert (const message_ty *mp)
 }
 
 
-/* Return true if a message matches.  */
+/* Return true if a message matches.
+   Called from several threads.  */
 static bool
 is_message_selected (const message_ty *mp)
 {
@@ -843,7 +879,7 @@ process_message_list (const char *domain, message_list_ty *mlp)
     ;
   else
     /* Keep only the selected messages.  */
-    message_list_remove_if_not (mlp, is_message_selected);
+    message_list_remove_if_not_parallel (mlp, is_message_selected);
 }
 
 
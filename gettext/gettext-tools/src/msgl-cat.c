@@ -30,6 +30,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include "error.h"
 #include "xerror.h"
@@ -40,6 +41,7 @@
 #include "msgl-ascii.h"
 #include "msgl-equal.h"
 #include "msgl-iconv.h"
+#include "po-xerror.h"
 #include "xalloc.h"
 #include "xmalloca.h"
 #include "c-strstr.h"
@@ -65,6 +67,11 @@ bool msgcomm_mode = false;
    If false, keep the header entry present in the input.  */
 bool omit_header = false;
 
+/* If true, keep only one input file in memory at a time, and read each
+   input file twice.
+   If false, read each input file once.  */
+bool low_memory = false;
+
 
 static bool
 is_message_selected (const message_ty *tmp)
@@ -104,247 +111,401 @@ is_message_first_needed (const message_ty *mp)
 }
 
 
-msgdomain_list_ty *
-catenate_msgdomain_list (string_list_ty *file_list,
-                         catalog_input_format_ty input_syntax,
-                         const char *to_code)
+/* Determines the canonical name of the encoding of each domain of MDLP,
+   which was read from FILENAME.  */
+static const char **
+catalog_canon_charsets (msgdomain_list_ty *mdlp, const char *filename)
 {
-  const char * const *files = file_list->item;
-  size_t nfiles = file_list->nitems;
-  msgdomain_list_ty **mdlps;
-  const char ***canon_charsets;
-  const char ***identifications;
-  msgdomain_list_ty *total_mdlp;
-  const char *canon_to_code;
-  size_t n, j;
-
-  /* Read input files.  */
-  mdlps = XNMALLOC (nfiles, msgdomain_list_ty *);
-  for (n = 0; n < nfiles; n++)
-    mdlps[n] = read_catalog_file (files[n], input_syntax);
+  const char **canon_charsets;
+  size_t k, j;
 
-  /* Determine the canonical name of each input file's encoding.  */
-  canon_charsets = XNMALLOC (nfiles, const char **);
-  for (n = 0; n < nfiles; n++)
+  canon_charsets = XNMALLOC (mdlp->nitems, const char *);
+  for (k = 0; k < mdlp->nitems; k++)
     {
-      msgdomain_list_ty *mdlp = mdlps[n];
-      size_t k;
+      message_list_ty *mlp = mdlp->item[k]->messages;
+      const char *canon_from_code = NULL;
 
-      canon_charsets[n] = XNMALLOC (mdlp->nitems, const char *);
-      for (k = 0; k < mdlp->nitems; k++)
+      if (mlp->nitems > 0)
         {
-          message_list_ty *mlp = mdlp->item[k]->messages;
-          const char *canon_from_code = NULL;
+          for (j = 0; j < mlp->nitems; j++)
+            if (is_header (mlp->item[j]) && !mlp->item[j]->obsolete)
+              {
+                const char *header = mlp->item[j]->msgstr;
 
-          if (mlp->nitems > 0)
-            {
-              for (j = 0; j < mlp->nitems; j++)
-                if (is_header (mlp->item[j]) && !mlp->item[j]->obsolete)
+                if (header != NULL)
                   {
-                    const char *header = mlp->item[j]->msgstr;
+                    const char *charsetstr = c_strstr (header, "charset=");
 
-                    if (header != NULL)
+                    if (charsetstr != NULL)
                       {
-                        const char *charsetstr = c_strstr (header, "charset=");
-
-                        if (charsetstr != NULL)
+                        size_t len;
+                        char *charset;
+                        const char *canon_charset;
+
+                        charsetstr += strlen ("charset=");
+                        len = strcspn (charsetstr, " \t\n");
+                        charset = (char *) xmalloca (len + 1);
+                        memcpy (charset, charsetstr, len);
+                        charset[len] = '\0';
+
+                        canon_charset = po_charset_canonicalize (charset);
+                        if (canon_charset == NULL)
                           {
-                            size_t len;
-                            char *charset;
-                            const char *canon_charset;
-
-                            charsetstr += strlen ("charset=");
-                            len = strcspn (charsetstr, " \t\n");
-                            charset = (char *) xmalloca (len + 1);
-                            memcpy (charset, charsetstr, len);
-                            charset[len] = '\0';
-
-                            canon_charset = po_charset_canonicalize (charset);
-                            if (canon_charset == NULL)
-                              {
-                                /* Don't give an error for POT files, because
-                                   POT files usually contain only ASCII
-                                   msgids.  */
-                                const char *filename = files[n];
-                                size_t filenamelen = strlen (filename);
-
-                                if (filenamelen >= 4
-                                    && memcmp (filename + filenamelen - 4,
-                                               ".pot", 4) == 0
-                                    && strcmp (charset, "CHARSET") == 0)
-                                  canon_charset = po_charset_ascii;
-                                else
-                                  error (EXIT_FAILURE, 0,
-                                         _("present charset \"%s\" is not a portable encoding name"),
-                                         charset);
-                              }
-
-                            freea (charset);
-
-                            if (canon_from_code == NULL)
-                              canon_from_code = canon_charset;
-                            else if (canon_from_code != canon_charset)
+                            /* Don't give an error for POT files, because
+                               POT files usually contain only ASCII
+                               msgids.  */
+                            size_t filenamelen = strlen (filename);
+
+                            if (filenamelen >= 4
+                                && memcmp (filename + filenamelen - 4,
+                                           ".pot", 4) == 0
+                                && strcmp (charset, "CHARSET") == 0)
+                              canon_charset = po_charset_ascii;
+                            else
                               error (EXIT_FAILURE, 0,
-                                     _("two different charsets \"%s\" and \"%s\" in input file"),
-                                     canon_from_code, canon_charset);
+                                     _("present charset \"%s\" is not a portable encoding name"),
+                                     charset);
                           }
+
+                        freea (charset);
+
+                        if (canon_from_code == NULL)
+                          canon_from_code = canon_charset;
+                        else if (canon_from_code != canon_charset)
+                          error (EXIT_FAILURE, 0,
+                                 _("two different charsets \"%s\" and \"%s\" in input file"),
+                                 canon_from_code, canon_charset);
                       }
                   }
-              if (canon_from_code == NULL)
+              }
+          if (canon_from_code == NULL)
+            {
+              if (is_ascii_message_list (mlp))
+                canon_from_code = po_charset_ascii;
+              else if (mdlp->encoding != NULL)
+                canon_from_code = mdlp->encoding;
+              else
                 {
-                  if (is_ascii_message_list (mlp))
-                    canon_from_code = po_charset_ascii;
-                  else if (mdlp->encoding != NULL)
-                    canon_from_code = mdlp->encoding;
+                  if (k == 0)
+                    error (EXIT_FAILURE, 0,
+                           _("input file '%s' doesn't contain a header entry with a charset specification"),
+                           filename);
                   else
-                    {
-                      if (k == 0)
-                        error (EXIT_FAILURE, 0,
-                               _("input file '%s' doesn't contain a header entry with a charset specification"),
-                               files[n]);
-                      else
-                        error (EXIT_FAILURE, 0,
-                               _("domain \"%s\" in input file '%s' doesn't contain a header entry with a charset specification"),
-                               mdlp->item[k]->domain, files[n]);
-                    }
+                    error (EXIT_FAILURE, 0,
+                           _("domain \"%s\" in input file '%s' doesn't contain a header entry with a charset specification"),
+                           mdlp->item[k]->domain, filename);
                 }
             }
-          canon_charsets[n][k] = canon_from_code;
         }
+      canon_charsets[k] = canon_from_code;
     }
 
-  /* Determine textual identifications of each file/domain combination.  */
-  identifications = XNMALLOC (nfiles, const char **);
-  for (n = 0; n < nfiles; n++)
+  return canon_charsets;
+}
+
+
+/* Determines textual identifications of each domain of MDLP, which was read
+   from FILENAME.  */
+static const char **
+catalog_identifications (msgdomain_list_ty *mdlp, const char *filename)
+{
+  const char **identifications;
+  size_t k, j;
+
+  filename = last_component (filename);
+
+  identifications = XNMALLOC (mdlp->nitems, const char *);
+  for (k = 0; k < mdlp->nitems; k++)
     {
-      const char *filename = last_component (files[n]);
-      msgdomain_list_ty *mdlp = mdlps[n];
-      size_t k;
+      const char *domain = mdlp->item[k]->domain;
+      message_list_ty *mlp = mdlp->item[k]->messages;
+      char *project_id = NULL;
 
-      identifications[n] = XNMALLOC (mdlp->nitems, const char *);
-      for (k = 0; k < mdlp->nitems; k++)
-        {
-          const char *domain = mdlp->item[k]->domain;
-          message_list_ty *mlp = mdlp->item[k]->messages;
-          char *project_id = NULL;
+      for (j = 0; j < mlp->nitems; j++)
+        if (is_header (mlp->item[j]) && !mlp->item[j]->obsolete)
+          {
+            const char *header = mlp->item[j]->msgstr;
 
-          for (j = 0; j < mlp->nitems; j++)
-            if (is_header (mlp->item[j]) && !mlp->item[j]->obsolete)
+            if (header != NULL)
               {
-                const char *header = mlp->item[j]->msgstr;
+                const char *cp = c_strstr (header, "Project-Id-Version:");
 
-                if (header != NULL)
+                if (cp != NULL)
                   {
-                    const char *cp = c_strstr (header, "Project-Id-Version:");
+                    const char *endp;
 
-                    if (cp != NULL)
-                      {
-                        const char *endp;
+                    cp += sizeof ("Project-Id-Version:") - 1;
 
-                        cp += sizeof ("Project-Id-Version:") - 1;
+                    endp = strchr (cp, '\n');
+                    if (endp == NULL)
+                      endp = cp + strlen (cp);
 
-                        endp = strchr (cp, '\n');
-                        if (endp == NULL)
-                          endp = cp + strlen (cp);
+                    while (cp < endp && *cp == ' ')
+                      cp++;
 
-                        while (cp < endp && *cp == ' ')
-                          cp++;
-
-                        if (cp < endp)
-                          {
-                            size_t len = endp - cp;
-                            project_id = XNMALLOC (len + 1, char);
-                            memcpy (project_id, cp, len);
-                            project_id[len] = '\0';
-                          }
-                        break;
+                    if (cp < endp)
+                      {
+                        size_t len = endp - cp;
+                        project_id = XNMALLOC (len + 1, char);
+                        memcpy (project_id, cp, len);
+                        project_id[len] = '\0';
                       }
+                    break;
                   }
               }
+          }
 
-          identifications[n][k] =
-            (project_id != NULL
-             ? (k > 0 ? xasprintf ("%s:%s (%s)", filename, domain, project_id)
-                      : xasprintf ("%s (%s)", filename, project_id))
-             : (k > 0 ? xasprintf ("%s:%s", filename, domain)
-                      : xasprintf ("%s", filename)));
-        }
+      identifications[k] =
+        (project_id != NULL
+         ? (k > 0 ? xasprintf ("%s:%s (%s)", filename, domain, project_id)
+                  : xasprintf ("%s (%s)", filename, project_id))
+         : (k > 0 ? xasprintf ("%s:%s", filename, domain)
+                  : xasprintf ("%s", filename)));
     }
 
-  /* Create list of resulting messages, but don't fill it.  Only count
-     the number of translations for each message.
-     If for a message, there is at least one non-fuzzy, non-empty translation,
-     use only the non-fuzzy, non-empty translations.  Otherwise use the
-     fuzzy or empty translations as well.  */
-  total_mdlp = msgdomain_list_alloc (true);
-  for (n = 0; n < nfiles; n++)
+  return identifications;
+}
+
+
+/* Adds the messages of MDLP to the list of resulting messages TOTAL_MDLP,
+   but doesn't fill them.  Only counts the number of translations for each
+   message.
+   If for a message, there is at least one non-fuzzy, non-empty translation,
+   use only the non-fuzzy, non-empty translations.  Otherwise use the
+   fuzzy or empty translations as well.
+   If COPY_KEYS is true, the resulting messages get their own copy of the
+   msgctxt, msgid and msgid_plural, so that MDLP can be freed afterwards.  */
+static void
+count_translations (msgdomain_list_ty *mdlp, msgdomain_list_ty *total_mdlp,
+                    bool copy_keys)
+{
+  size_t k, j;
+
+  for (k = 0; k < mdlp->nitems; k++)
     {
-      msgdomain_list_ty *mdlp = mdlps[n];
-      size_t k;
+      const char *domain = mdlp->item[k]->domain;
+      message_list_ty *mlp = mdlp->item[k]->messages;
+      message_list_ty *total_mlp;
 
-      for (k = 0; k < mdlp->nitems; k++)
-        {
-          const char *domain = mdlp->item[k]->domain;
-          message_list_ty *mlp = mdlp->item[k]->messages;
-          message_list_ty *total_mlp;
+      total_mlp = msgdomain_list_sublist (total_mdlp, domain, true);
 
-          total_mlp = msgdomain_list_sublist (total_mdlp, domain, true);
+      for (j = 0; j < mlp->nitems; j++)
+        {
+          message_ty *mp = mlp->item[j];
+          message_ty *tmp;
+          size_t i;
 
-          for (j = 0; j < mlp->nitems; j++)
+          tmp = message_list_search (total_mlp, mp->msgctxt, mp->msgid);
+          if (tmp != NULL)
             {
-              message_ty *mp = mlp->item[j];
-              message_ty *tmp;
-              size_t i;
-
-              tmp = message_list_search (total_mlp, mp->msgctxt, mp->msgid);
-              if (tmp != NULL)
+              if ((tmp->msgid_plural != NULL) != (mp->msgid_plural != NULL))
                 {
-                  if ((tmp->msgid_plural != NULL) != (mp->msgid_plural != NULL))
-                    {
-                      char *errormsg =
-                        xasprintf (_("msgid '%s' is used without plural and with plural."),
-                                   mp->msgid);
-                      multiline_error (xstrdup (""),
-                                       xasprintf ("%s\n", errormsg));
-                    }
+                  char *errormsg =
+                    xasprintf (_("msgid '%s' is used without plural and with plural."),
+                               mp->msgid);
+                  multiline_error (xstrdup (""),
+                                   xasprintf ("%s\n", errormsg));
                 }
+            }
+          else
+            {
+              if (copy_keys)
+                tmp = message_alloc (mp->msgctxt != NULL
+                                     ? xstrdup (mp->msgctxt) : NULL,
+                                     xstrdup (mp->msgid),
+                                     mp->msgid_plural != NULL
+                                     ? xstrdup (mp->msgid_plural) : NULL,
+                                     NULL, 0, &mp->pos);
               else
-                {
-                  tmp = message_alloc (mp->msgctxt, mp->msgid, mp->msgid_plural,
-                                       NULL, 0, &mp->pos);
-                  tmp->is_fuzzy = true; /* may be set to false later */
-                  for (i = 0; i < NFORMATS; i++)
-                    tmp->is_format[i] = undecided; /* may be set to yes/no later */
-                  tmp->range.min = - INT_MAX;
-                  tmp->range.max = - INT_MAX;
-                  tmp->do_wrap = yes; /* may be set to no later */
-                  for (i = 0; i < NSYNTAXCHECKS; i++)
-                    tmp->do_syntax_check[i] = undecided; /* may be set to yes/no later */
-                  tmp->obsolete = true; /* may be set to false later */
-                  tmp->alternative_count = 0;
-                  tmp->alternative = NULL;
-                  message_list_append (total_mlp, tmp);
-                }
+                tmp = message_alloc (mp->msgctxt, mp->msgid, mp->msgid_plural,
+                                     NULL, 0, &mp->pos);
+              tmp->is_fuzzy = true; /* may be set to false later */
+              for (i = 0; i < NFORMATS; i++)
+                tmp->is_format[i] = undecided; /* may be set to yes/no later */
+              tmp->range.min = - INT_MAX;
+              tmp->range.max = - INT_MAX;
+              tmp->do_wrap = yes; /* may be set to no later */
+              for (i = 0; i < NSYNTAXCHECKS; i++)
+                tmp->do_syntax_check[i] = undecided; /* may be set to yes/no later */
+              tmp->obsolete = true; /* may be set to false later */
+              tmp->alternative_count = 0;
+              tmp->alternative = NULL;
+              message_list_append (total_mlp, tmp);
+            }
 
-              if (!msgcomm_mode
-                  && ((!is_header (mp) && mp->is_fuzzy)
-                      || mp->msgstr[0] == '\0'))
-                /* Weak translation.  Counted as negative tmp->used.  */
-                {
-                  if (tmp->used <= 0)
-                    tmp->used--;
-                }
-              else
-                /* Good translation.  Counted as positive tmp->used.  */
-                {
-                  if (tmp->used < 0)
-                    tmp->used = 0;
-                  tmp->used++;
-                }
-              mp->tmp = tmp;
+          if (!msgcomm_mode
+              && ((!is_header (mp) && mp->is_fuzzy)
+                  || mp->msgstr[0] == '\0'))
+            /* Weak translation.  Counted as negative tmp->used.  */
+            {
+              if (tmp->used <= 0)
+                tmp->used--;
+            }
+          else
+            /* Good translation.  Counted as positive tmp->used.  */
+            {
+              if (tmp->used < 0)
+                tmp->used = 0;
+              tmp->used++;
+            }
+          mp->tmp = tmp;
+        }
+    }
+}
+
+
+/* The error logger that was in use before quiet_xerror was installed.  */
+static void (*noisy_po_xerror) (int, const struct message_ty *, const char *,
+                                size_t, size_t, int, const char *);
+
+/* An error logger that drops everything except fatal errors.  */
+static void
+quiet_xerror (int severity,
+              const struct message_ty *message,
+              const char *filename, size_t lineno, size_t column,
+              int multiline_p, const char *message_text)
+{
+  if (severity == PO_SEVERITY_FATAL_ERROR)
+    noisy_po_xerror (severity, message, filename, lineno, column,
+                     multiline_p, message_text);
+}
+
+
+/* Reads FILENAME a second time, after count_translations has been applied
+   to its first reading, which had NDOMAINS domains.  */
+static msgdomain_list_ty *
+reread_catalog_file (const char *filename,
+                     catalog_input_format_ty input_syntax,
+                     size_t ndomains, msgdomain_list_ty *total_mdlp)
+{
+  msgdomain_list_ty *mdlp;
+  size_t k, j;
+
+  /* The warnings have already been shown during the first reading.  */
+  noisy_po_xerror = po_xerror;
+  po_xerror = quiet_xerror;
+
+  mdlp = read_catalog_file (filename, input_syntax);
+
+  po_xerror = noisy_po_xerror;
+
+  if (mdlp->nitems != ndomains)
+    error (EXIT_FAILURE, 0, _("input file '%s' changed while being read"),
+           filename);
+  for (k = 0; k < mdlp->nitems; k++)
+    {
+      message_list_ty *mlp = mdlp->item[k]->messages;
+      message_list_ty *total_mlp =
+        msgdomain_list_sublist (total_mdlp, mdlp->item[k]->domain, false);
+
+      for (j = 0; j < mlp->nitems; j++)
+        {
+          message_ty *mp = mlp->item[j];
+
+          mp->tmp = (total_mlp != NULL
+                     ? message_list_search (total_mlp, mp->msgctxt, mp->msgid)
+                     : NULL);
+          if (mp->tmp == NULL)
+            error (EXIT_FAILURE, 0,
+                   _("input file '%s' changed while being read"),
+                   filename);
+        }
+    }
+
+  return mdlp;
+}
+
+
+/* Like message_list_remove_if_not, but also frees the removed messages.  */
+static void
+message_list_free_if_not (message_list_ty *mlp,
+                          message_predicate_ty *predicate)
+{
+  size_t nitems = mlp->nitems;
+  message_ty **items = XNMALLOC (nitems, message_ty *);
+  size_t i, j;
+
+  memcpy (items, mlp->item, nitems * sizeof (message_ty *));
+  message_list_remove_if_not (mlp, predicate);
+  for (j = 0, i = 0; j < nitems; j++)
+    if (i < mlp->nitems && mlp->item[i] == items[j])
+      i++;
+    else
+      message_free (items[j]);
+  free (items);
+}
+
+
+msgdomain_list_ty *
+catenate_msgdomain_list (string_list_ty *file_list,
+                         catalog_input_format_ty input_syntax,
+                         const char *to_code)
+{
+  const char * const *files = file_list->item;
+  size_t nfiles = file_list->nitems;
+  msgdomain_list_ty **mdlps;
+  const char ***canon_charsets;
+  const char ***identifications;
+  msgdomain_list_ty *total_mdlp;
+  const char *canon_to_code;
+  size_t *ndomains = NULL;
+  size_t n, j;
+
+  mdlps = XNMALLOC (nfiles, msgdomain_list_ty *);
+  canon_charsets = XNMALLOC (nfiles, const char **);
+  identifications = XNMALLOC (nfiles, const char **);
+  total_mdlp = msgdomain_list_alloc (true);
+
+  if (low_memory)
+    {
+      /* Read the input files one at a time.  Keep only the list of resulting
+         messages and the header information in memory.  */
+      ndomains = XNMALLOC (nfiles, size_t);
+
+      for (n = 0; n < nfiles; n++)
+        {
+          struct stat statbuf;
+          /* Only a regular file can be read twice.  Keep anything else, such
+             as standard input, a pipe or a FIFO, in memory.  */
+          bool keep =
+            (strcmp (files[n], "-") == 0
+             || strcmp (files[n], "/dev/stdin") == 0
+             || !(stat (files[n], &statbuf) == 0
+                  && S_ISREG (statbuf.st_mode)));
+          msgdomain_list_ty *mdlp = read_catalog_file (files[n], input_syntax);
+
+          canon_charsets[n] = catalog_canon_charsets (mdlp, files[n]);
+          identifications[n] = catalog_identifications (mdlp, files[n]);
+          count_translations (mdlp, total_mdlp, !keep);
+          ndomains[n] = mdlp->nitems;
+          if (keep)
+            mdlps[n] = mdlp;
+          else
+            {
+              msgdomain_list_free (mdlp);
+              mdlps[n] = NULL;
             }
         }
     }
+  else
+    {
+      /* Read input files.  */
+      for (n = 0; n < nfiles; n++)
+        mdlps[n] = read_catalog_file (files[n], input_syntax);
+
+      /* Determine the canonical name of each input file's encoding.  */
+      for (n = 0; n < nfiles; n++)
+        canon_charsets[n] = catalog_canon_charsets (mdlps[n], files[n]);
+
+      /* Determine textual identifications of each file/domain combination.  */
+      for (n = 0; n < nfiles; n++)
+        identifications[n] = catalog_identifications (mdlps[n], files[n]);
+
+      /* Create list of resulting messages, but don't fill it.  Only count
+         the number of translations for each message.  */
+      for (n = 0; n < nfiles; n++)
+        count_translations (mdlps[n], total_mdlp, false);
+    }
 
   /* Remove messages that are not used and need not be converted.  */
   for (n = 0; n < nfiles; n++)
@@ -352,14 +513,19 @@ catenate_msgdomain_list (string_list_ty *file_list,
       msgdomain_list_ty *mdlp = mdlps[n];
       size_t k;
 
+      /* In low-memory mode, read the file again, now that the number of
+         translations of each message is known.  */
+      if (mdlp == NULL)
+        mdlp = mdlps[n] =
+          reread_catalog_file (files[n], input_syntax, ndomains[n],
+                               total_mdlp);
+
       for (k = 0; k < mdlp->nitems; k++)
         {
           message_list_ty *mlp = mdlp->item[k]->messages;
 
-          message_list_remove_if_not (mlp,
-                                      use_first
-                                      ? is_message_first_needed
-                                      : is_message_needed);
+          (low_memory ? message_list_free_if_not : message_list_remove_if_not)
+            (mlp, use_first ? is_message_first_needed : is_message_needed);
 
           /* If no messages are remaining, drop the charset.  */
           if (mlp->nitems == 0)
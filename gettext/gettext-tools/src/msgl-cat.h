@@ -46,6 +46,11 @@ extern DLL_VARIABLE bool msgcomm_mode;
    If false, keep the header entry present in the input.  */
 extern DLL_VARIABLE bool omit_header;
 
+/* If true, keep only one input file in memory at a time, and read each
+   input file twice.
+   If false, read each input file once.  */
+extern DLL_VARIABLE bool low_memory;
+
 extern msgdomain_list_ty *
        catenate_msgdomain_list (string_list_ty *file_list,
                                 catalog_input_format_ty input_syntax,
@@ -28,43 +28,43 @@
 #include "xalloc.h"
 
 
-msgdomain_list_ty *
-msgdomain_list_english (msgdomain_list_ty *mdlp)
+/* Fills in the English translation of the message MP, if it is untranslated.
+   Called from several threads.  */
+static void
+message_english (message_ty *mp, void *data)
 {
-  size_t j, k;
-
-  for (k = 0; k < mdlp->nitems; k++)
+  if (mp->msgid_plural == NULL)
     {
-      message_list_ty *mlp = mdlp->item[k]->messages;
-
-      for (j = 0; j < mlp->nitems; j++)
+      if (mp->msgstr_len == 1 && mp->msgstr[0] == '\0')
         {
-          message_ty *mp = mlp->item[j];
-
-          if (mp->msgid_plural == NULL)
-            {
-              if (mp->msgstr_len == 1 && mp->msgstr[0] == '\0')
-                {
-                  mp->msgstr = mp->msgid; /* no need for xstrdup */
-                  mp->msgstr_len = strlen (mp->msgid) + 1;
-                }
-            }
-          else
-            {
-              if (mp->msgstr_len == 2
-                  && mp->msgstr[0] == '\0' && mp->msgstr[1] == '\0')
-                {
-                  size_t len0 = strlen (mp->msgid) + 1;
-                  size_t len1 = strlen (mp->msgid_plural) + 1;
-                  char *cp = XNMALLOC (len0 + len1, char);
-                  memcpy (cp, mp->msgid, len0);
-                  memcpy (cp + len0, mp->msgid_plural, len1);
-                  mp->msgstr = cp;
-                  mp->msgstr_len = len0 + len1;
-                }
-            }
+          mp->msgstr = mp->msgid; /* no need for xstrdup */
+          mp->msgstr_len = strlen (mp->msgid) + 1;
         }
     }
+  else
+    {
+      if (mp->msgstr_len == 2
+          && mp->msgstr[0] == '\0' && mp->msgstr[1] == '\0')
+        {
+          size_t len0 = strlen (mp->msgid) + 1;
+          size_t len1 = strlen (mp->msgid_plural) + 1;
+          char *cp = XNMALLOC (len0 + len1, char);
+          memcpy (cp, mp->msgid, len0);
+          memcpy (cp + len0, mp->msgid_plural, len1);
+          mp->msgstr = cp;
+          mp->msgstr_len = len0 + len1;
+        }
+    }
+}
+
+msgdomain_list_ty *
+msgdomain_list_english (msgdomain_list_ty *mdlp)
+{
+  size_t k;
+
+  for (k = 0; k < mdlp->nitems; k++)
+    message_list_for_each_parallel (mdlp->item[k]->messages,
+                                    message_english, NULL);
 
   return mdlp;
 }
@@ -182,6 +182,239 @@ convert_msgstr (const iconveh_t *cd, message_ty *mp,
   conversion_error (context);
 }
 
+
+/* Bulk conversion of a message list.
+   Converting each string separately has a high overhead per string.  Instead,
+   all strings of a message list are concatenated, separated by NUL bytes,
+   and converted in a single call.  Strings that consist only of ASCII
+   characters are left out if the conversion maps ASCII to itself.  If the
+   bulk conversion fails, the caller falls back to converting each string
+   separately, in order to report the failing message accurately.  */
+
+/* A string that is subject to the conversion.  */
+struct conversion_slot
+{
+  const char **stringp;
+  /* For a msgstr, which consists of one or more NUL terminated strings,
+     the address of its length.  NULL otherwise.  */
+  size_t *lengthp;
+};
+
+/* The strings of a message list that are subject to the conversion.  */
+struct conversion_batch
+{
+  struct conversion_slot *slots;
+  size_t nslots;
+  size_t nslots_allocated;
+  /* Total size of these strings, including all NUL bytes.  */
+  size_t total_size;
+  /* Total number of NUL bytes in these strings.  */
+  size_t total_nuls;
+  /* Whether to leave out strings that consist only of ASCII characters.  */
+  bool skip_ascii;
+};
+
+/* Tests whether the conversion CD maps every ASCII character to itself.
+   This is not the case, for example, for SHIFT_JIS and JOHAB in some
+   iconv implementations.  */
+static bool
+is_ascii_transparent (const iconveh_t *cd)
+{
+  char ascii[128];
+  char *result = NULL;
+  size_t resultlen = 0;
+  bool transparent;
+  int i;
+
+  for (i = 0; i < 127; i++)
+    ascii[i] = i + 1;
+  ascii[127] = '\0';
+
+  transparent =
+    (xmem_cd_iconveh (ascii, sizeof (ascii), cd, iconveh_error, NULL,
+                      &result, &resultlen) == 0
+     && resultlen == sizeof (ascii)
+     && memcmp (result, ascii, sizeof (ascii)) == 0);
+  free (result);
+  return transparent;
+}
+
+static void
+batch_add (struct conversion_batch *batch,
+           const char **stringp, size_t *lengthp)
+{
+  const char *string = *stringp;
+  size_t length = (lengthp != NULL ? *lengthp : strlen (string) + 1);
+  size_t nuls = 1;
+
+  if (lengthp != NULL)
+    {
+      const char *p;
+
+      if (!(length > 0 && string[length - 1] == '\0'))
+        abort ();
+      for (p = string, nuls = 0; p < string + length; p += strlen (p) + 1)
+        nuls++;
+    }
+
+  if (batch->skip_ascii)
+    {
+      const char *p;
+
+      for (p = string; p < string + length; p++)
+        if ((unsigned char) *p >= 0x80)
+          break;
+      if (p == string + length)
+        return;
+    }
+
+  if (batch->nslots == batch->nslots_allocated)
+    {
+      batch->nslots_allocated = 2 * batch->nslots_allocated + 64;
+      batch->slots =
+        (struct conversion_slot *)
+        xrealloc (batch->slots,
+                  batch->nslots_allocated * sizeof (struct conversion_slot));
+    }
+  batch->slots[batch->nslots].stringp = stringp;
+  batch->slots[batch->nslots].lengthp = lengthp;
+  batch->nslots++;
+  batch->total_size += length;
+  batch->total_nuls += nuls;
+}
+
+static void
+batch_add_string_list (struct conversion_batch *batch, string_list_ty *slp)
+{
+  size_t i;
+
+  if (slp != NULL)
+    for (i = 0; i < slp->nitems; i++)
+      batch_add (batch, &slp->item[i], NULL);
+}
+
+/* Collects the strings of MLP, in the same order as the per-message
+   conversion.  */
+static void
+batch_add_message_list (struct conversion_batch *batch, message_list_ty *mlp)
+{
+  size_t j;
+
+  for (j = 0; j < mlp->nitems; j++)
+    {
+      message_ty *mp = mlp->item[j];
+
+      batch_add_string_list (batch, mp->comment);
+      batch_add_string_list (batch, mp->comment_dot);
+      if (mp->prev_msgctxt != NULL)
+        batch_add (batch, &mp->prev_msgctxt, NULL);
+      if (mp->prev_msgid != NULL)
+        batch_add (batch, &mp->prev_msgid, NULL);
+      if (mp->prev_msgid_plural != NULL)
+        batch_add (batch, &mp->prev_msgid_plural, NULL);
+      if (mp->msgctxt != NULL)
+        batch_add (batch, &mp->msgctxt, NULL);
+      batch_add (batch, &mp->msgid, NULL);
+      if (mp->msgid_plural != NULL)
+        batch_add (batch, &mp->msgid_plural, NULL);
+      batch_add (batch, &mp->msgstr, &mp->msgstr_len);
+    }
+}
+
+/* Converts the strings of the message list MLP through CD, all at once.
+   If STORE is true, replaces them with their converted form.
+   Returns false if the bulk conversion failed; nothing has been stored
+   in this case.  */
+static bool
+iconv_message_list_bulk (const iconveh_t *cd, message_list_ty *mlp,
+                         bool store)
+{
+  struct conversion_batch batch;
+  char *input;
+  char *result;
+  size_t resultlen;
+  bool ok;
+
+  batch.slots = NULL;
+  batch.nslots = 0;
+  batch.nslots_allocated = 0;
+  batch.total_size = 0;
+  batch.total_nuls = 0;
+  batch.skip_ascii = is_ascii_transparent (cd);
+  batch_add_message_list (&batch, mlp);
+
+  if (batch.nslots == 0)
+    return true;
+
+  /* Concatenate the strings.  */
+  input = XNMALLOC (batch.total_size, char);
+  {
+    char *q = input;
+    size_t i;
+
+    for (i = 0; i < batch.nslots; i++)
+      {
+        const struct conversion_slot *slot = &batch.slots[i];
+        size_t length =
+          (slot->lengthp != NULL
+           ? *slot->lengthp
+           : strlen (*slot->stringp) + 1);
+
+        memcpy (q, *slot->stringp, length);
+        q += length;
+      }
+  }
+
+  result = NULL;
+  resultlen = 0;
+  ok = (xmem_cd_iconveh (input, batch.total_size, cd, iconveh_error, NULL,
+                         &result, &resultlen) == 0);
+  free (input);
+
+  /* Verify that the result has the same number of NUL bytes, the last one
+     at the end.  Then each string corresponds to a piece of the result.  */
+  if (ok)
+    {
+      const char *p;
+      size_t nuls;
+
+      ok = (resultlen > 0 && result[resultlen - 1] == '\0');
+      for (p = result, nuls = 0; ok && p < result + resultlen; nuls++)
+        p += strlen (p) + 1;
+      ok = ok && (nuls == batch.total_nuls);
+    }
+
+  if (ok && store)
+    {
+      const char *p = result;
+      size_t i;
+
+      for (i = 0; i < batch.nslots; i++)
+        {
+          const struct conversion_slot *slot = &batch.slots[i];
+          const char *piece = p;
+
+          if (slot->lengthp != NULL)
+            {
+              /* A msgstr: as many NUL terminated strings as before.  */
+              const char *orig = *slot->stringp;
+              const char *orig_end = orig + *slot->lengthp;
+
+              for (; orig < orig_end; orig += strlen (orig) + 1)
+                p += strlen (p) + 1;
+              *slot->lengthp = p - piece;
+            }
+          else
+            p += strlen (p) + 1;
+          *slot->stringp = (char *) xmemdup (piece, p - piece);
+        }
+    }
+
+  free (result);
+  free (batch.slots);
+  return ok;
+}
+
 #endif
 
 
@@ -311,14 +544,21 @@ iconv_message_list_internal (message_list_ty *mlp,
           if ((mp->msgctxt != NULL && !is_ascii_string (mp->msgctxt))
               || !is_ascii_string (mp->msgid))
             msgids_changed = true;
-          context.message = mp;
-          convert_string_list (&cd, mp->comment, &context);
-          convert_string_list (&cd, mp->comment_dot, &context);
-          convert_prev_msgid (&cd, mp, &context);
-          convert_msgid (&cd, mp, &context);
-          convert_msgstr (&cd, mp, &context);
         }
 
+      if (!iconv_message_list_bulk (&cd, mlp, true))
+        for (j = 0; j < mlp->nitems; j++)
+          {
+            message_ty *mp = mlp->item[j];
+
+            context.message = mp;
+            convert_string_list (&cd, mp->comment, &context);
+            convert_string_list (&cd, mp->comment_dot, &context);
+            convert_prev_msgid (&cd, mp, &context);
+            convert_msgid (&cd, mp, &context);
+            convert_msgstr (&cd, mp, &context);
+          }
+
       iconveh_close (&cd);
 
       if (msgids_changed)
@@ -561,17 +801,18 @@ is_message_list_iconvable (message_list_ty *mlp,
         /* iconv() doesn't support this conversion.  */
         return false;
 
-      for (j = 0; j < mlp->nitems; j++)
-        {
-          message_ty *mp = mlp->item[j];
-
-          if (!(iconvable_string_list (&cd, mp->comment)
-                && iconvable_string_list (&cd, mp->comment_dot)
-                && iconvable_prev_msgid (&cd, mp)
-                && iconvable_msgid (&cd, mp)
-                && iconvable_msgstr (&cd, mp)))
-            return false;
-        }
+      if (!iconv_message_list_bulk (&cd, mlp, false))
+        for (j = 0; j < mlp->nitems; j++)
+          {
+            message_ty *mp = mlp->item[j];
+
+            if (!(iconvable_string_list (&cd, mp->comment)
+                  && iconvable_string_list (&cd, mp->comment_dot)
+                  && iconvable_prev_msgid (&cd, mp)
+                  && iconvable_msgid (&cd, mp)
+                  && iconvable_msgstr (&cd, mp)))
+              return false;
+          }
 
       iconveh_close (&cd);
 #else
@@ -28,9 +28,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <locale.h>
-#ifdef _OPENMP
-# include <omp.h>
-#endif
 
 #include <textstyle.h>
 
@@ -43,6 +40,7 @@
 #include "relocatable.h"
 #include "basename-lgpl.h"
 #include "message.h"
+#include "jobs.h"
 #include "read-catalog.h"
 #include "read-po.h"
 #include "read-properties.h"
@@ -67,6 +65,7 @@
 #include "plural-count.h"
 #include "msgl-check.h"
 #include "po-xerror.h"
+#include "time-report.h"
 #include "backupfile.h"
 #include "copy-file.h"
 #include "propername.h"
@@ -150,6 +149,7 @@ static const struct option long_options[] =
   { "stringtable-output", no_argument, NULL, CHAR_MAX + 6 },
   { "style", required_argument, NULL, CHAR_MAX + 10 },
   { "suffix", required_argument, NULL, CHAR_MAX + 3 },
+  { "time-report", optional_argument, NULL, CHAR_MAX + 13 },
   { "update", no_argument, NULL, 'U' },
   { "verbose", no_argument, NULL, 'v' },
   { "version", no_argument, NULL, 'V' },
@@ -356,6 +356,17 @@ main (int argc, char **argv)
         for_msgfmt = true;
         break;
 
+      case CHAR_MAX + 13: /* --time-report */
+        {
+          enum time_report_format format;
+
+          if (!time_report_parse_format (optarg, &format))
+            error (EXIT_FAILURE, 0, _("time report format '%s' unknown"),
+                   optarg);
+          time_report_request (format);
+        }
+        break;
+
       default:
         usage (EXIT_FAILURE);
         break;
@@ -461,18 +472,20 @@ There is NO WARRANTY, to the extent permitted by law.\n\
     }
 
   /* Initialize OpenMP.  */
-  #ifdef _OPENMP
-  openmp_init ();
-  #endif
+  jobs_init (0);
 
   /* Merge the two files.  */
   result = merge (argv[optind], argv[optind + 1], input_syntax, &def);
 
   /* Sort the results.  */
+  time_report_begin ("sort");
   if (sort_by_filepos)
     msgdomain_list_sort_by_filepos (result);
   else if (sort_by_msgid)
     msgdomain_list_sort_by_msgid (result);
+  time_report_end ("sort");
+
+  time_report_begin ("output");
 
   if (update_mode)
     {
@@ -522,6 +535,8 @@ There is NO WARRANTY, to the extent permitted by law.\n\
                             for_msgfmt || force_po, false);
     }
 
+  time_report_end ("output");
+
   exit (EXIT_SUCCESS);
 }
 
@@ -669,6 +684,9 @@ Informative output:\n"));
   -v, --verbose               increase verbosity level\n"));
       printf (_("\
   -q, --quiet, --silent       suppress progress indicators\n"));
+      printf (_("\
+      --time-report[=FORMAT]  report the time spent in each phase at exit;\n\
+                              FORMAT may be 'text' (default) or 'json'\n"));
       printf ("\n");
       /* TRANSLATORS: The first placeholder is the web address of the Savannah
          project of this package.  The second placeholder is the bug-reporting
@@ -692,7 +710,9 @@ compendium (const char *filename)
   msgdomain_list_ty *mdlp;
   size_t k;
 
+  time_report_begin ("parse");
   mdlp = read_catalog_file (filename, &input_format_po);
+  time_report_end ("parse");
   if (compendiums == NULL)
     {
       compendiums = message_list_list_alloc ();
@@ -780,6 +800,11 @@ struct definitions_ty
   /* The canonical encoding of the definitions and the compendiums.
      Only used for fuzzy matching.  */
   const char *canon_charset;
+
+  /* The time spent building fuzzy indices, and their number, since the last
+     call to definitions_report_findex.  Used only if time_report_enabled.  */
+  double findex_time;
+  unsigned long findex_count;
 };
 
 static inline void
@@ -794,6 +819,8 @@ definitions_init (definitions_ty *definitions, const char *canon_charset)
   definitions->comp_findex = NULL;
   gl_lock_init (definitions->comp_findex_init_lock);
   definitions->canon_charset = canon_charset;
+  definitions->findex_time = 0.0;
+  definitions->findex_count = 0;
 }
 
 /* Return the current list of non-compendium messages.  */
@@ -823,9 +850,19 @@ definitions_init_curr_findex (definitions_ty *definitions)
   /* Protect against concurrent execution.  */
   gl_lock_lock (definitions->curr_findex_init_lock);
   if (definitions->curr_findex == NULL)
-    definitions->curr_findex =
-      message_fuzzy_index_alloc (definitions_current_list (definitions),
-                                 definitions->canon_charset);
+    {
+      double start_time = (time_report_enabled ? time_report_clock () : 0.0);
+
+      definitions->curr_findex =
+        message_fuzzy_index_alloc (definitions_current_list (definitions),
+                                   definitions->canon_charset);
+
+      if (time_report_enabled)
+        {
+          definitions->findex_time += time_report_clock () - start_time;
+          definitions->findex_count++;
+        }
+    }
   gl_lock_unlock (definitions->curr_findex_init_lock);
 }
 
@@ -842,6 +879,7 @@ definitions_init_comp_findex (definitions_ty *definitions)
          bother checking for duplicates.  */
       message_list_ty *all_compendium;
       size_t i;
+      double start_time = (time_report_enabled ? time_report_clock () : 0.0);
 
       all_compendium = message_list_alloc (false);
       for (i = 0; i < compendiums->nitems; i++)
@@ -856,10 +894,29 @@ definitions_init_comp_findex (definitions_ty *definitions)
       /* Create the fuzzy index from it.  */
       definitions->comp_findex =
         message_fuzzy_index_alloc (all_compendium, definitions->canon_charset);
+
+      if (time_report_enabled)
+        {
+          definitions->findex_time += time_report_clock () - start_time;
+          definitions->findex_count++;
+        }
     }
   gl_lock_unlock (definitions->comp_findex_init_lock);
 }
 
+/* Reports the time spent building fuzzy indices since the last call, and
+   returns it.  Used only if time_report_enabled.  */
+static inline double
+definitions_report_findex (definitions_ty *definitions)
+{
+  double findex_time = definitions->findex_time;
+
+  time_report_add ("index build", findex_time, definitions->findex_count);
+  definitions->findex_time = 0.0;
+  definitions->findex_count = 0;
+  return findex_time;
+}
+
 /* Exact search.  */
 static inline message_ty *
 definitions_search (const definitions_ty *definitions,
@@ -1453,6 +1510,8 @@ match_domain (const char *fn1, const char *fn2,
   untranslated_plural_msgstr = XNMALLOC (nplurals, char);
   memset (untranslated_plural_msgstr, '\0', nplurals);
 
+  time_report_begin ("format checks");
+
   /* Determine the plural distribution of the plural_expr formula.  */
   {
     /* Disable error output temporarily.  */
@@ -1473,6 +1532,8 @@ match_domain (const char *fn1, const char *fn2,
     po_xerror = old_po_xerror;
   }
 
+  time_report_end ("format checks");
+
   /* Most of the time is spent in definitions_search_fuzzy.
      Perform it in a separate loop that can be parallelized by an OpenMP
      capable compiler.  */
@@ -1480,6 +1541,10 @@ match_domain (const char *fn1, const char *fn2,
   {
     long int nn = refmlp->nitems;
     long int jj;
+    /* The time spent in the searches, summed over all threads.  */
+    double exact_time = 0.0;
+    double fuzzy_time = 0.0;
+    long int fuzzy_count = 0;
 
     /* Tell the OpenMP capable compiler to distribute this loop across
        several threads.  The schedule is dynamic, because for some messages
@@ -1488,12 +1553,14 @@ match_domain (const char *fn1, const char *fn2,
        Note: The Sun Workshop 6.2 C compiler does not allow a space between
        '#' and 'pragma'.  */
     #ifdef _OPENMP
-     #pragma omp parallel for schedule(dynamic)
+     #pragma omp parallel for schedule(dynamic) \
+      reduction(+:exact_time,fuzzy_time,fuzzy_count)
     #endif
     for (jj = 0; jj < nn; jj++)
       {
         message_ty *refmsg = refmlp->item[jj];
         message_ty *defmsg;
+        double start_time = 0.0;
 
         /* Because merging can take a while we print something to signal
            we are not dead.  */
@@ -1504,9 +1571,21 @@ match_domain (const char *fn1, const char *fn2,
         #endif
         (*processed)++;
 
+        if (time_report_enabled)
+          start_time = time_report_clock ();
+
         /* See if it is in the other file.  */
         defmsg =
           definitions_search (definitions, refmsg->msgctxt, refmsg->msgid);
+
+        if (time_report_enabled)
+          {
+            double end_time = time_report_clock ();
+
+            exact_time += end_time - start_time;
+            start_time = end_time;
+          }
+
         if (defmsg != NULL)
           {
             search_results[jj].found = defmsg;
@@ -1516,20 +1595,36 @@ match_domain (const char *fn1, const char *fn2,
                  /* If the message was not defined at all, try to find a very
                     similar message, it could be a typo, or the suggestion may
                     help.  */
-                 && use_fuzzy_matching
-                 && ((defmsg =
-                        definitions_search_fuzzy (definitions,
-                                                  refmsg->msgctxt,
-                                                  refmsg->msgid)) != NULL))
+                 && use_fuzzy_matching)
           {
+            defmsg =
+              definitions_search_fuzzy (definitions,
+                                        refmsg->msgctxt, refmsg->msgid);
+
+            if (time_report_enabled)
+              {
+                fuzzy_time += time_report_clock () - start_time;
+                fuzzy_count++;
+              }
+
             search_results[jj].found = defmsg;
             search_results[jj].fuzzy = true;
           }
         else
           search_results[jj].found = NULL;
       }
+
+    if (time_report_enabled)
+      {
+        /* The fuzzy indices are built lazily, during the fuzzy search.  */
+        fuzzy_time -= definitions_report_findex (definitions);
+        time_report_add ("exact search", exact_time, nn);
+        time_report_add ("fuzzy search", fuzzy_time, fuzzy_count);
+      }
   }
 
+  time_report_begin ("merge");
+
   for (j = 0; j < refmlp->nitems; j++)
     {
       message_ty *refmsg = refmlp->item[j];
@@ -1731,6 +1826,8 @@ match_domain (const char *fn1, const char *fn2,
           mp->prev_msgid_plural = NULL;
         }
     }
+
+  time_report_end ("merge");
 }
 
 static msgdomain_list_ty *
@@ -1749,12 +1846,17 @@ merge (const char *fn1, const char *fn2, catalog_input_format_ty input_syntax,
 
   stats.merged = stats.fuzzied = stats.missing = stats.obsolete = 0;
 
+  time_report_begin ("parse");
+
   /* This is the definitions file, created by a human.  */
   def = read_catalog_file (fn1, input_syntax);
 
   /* This is the references file, created by groping the sources with
      the xgettext program.  */
   ref = read_catalog_file (fn2, input_syntax);
+
+  time_report_end ("parse");
+
   /* Add a dummy header entry, if the references file contains none.  */
   for (k = 0; k < ref->nitems; k++)
     if (message_list_search (ref->item[k]->messages, NULL, "") == NULL)
@@ -1765,6 +1867,8 @@ merge (const char *fn1, const char *fn2, catalog_input_format_ty input_syntax,
         message_list_prepend (ref->item[k]->messages, refheader);
       }
 
+  time_report_begin ("charset conversion");
+
   /* The references file can be either in ASCII or in UTF-8.  If it is
      in UTF-8, we have to convert the definitions and the compendiums to
      UTF-8 as well.  */
@@ -1953,6 +2057,8 @@ merge (const char *fn1, const char *fn2, catalog_input_format_ty input_syntax,
       }
   }
 
+  time_report_end ("charset conversion");
+
   /* Determine canonicalized encoding name of the definitions now, after
      conversion.  Only used for fuzzy matching.  */
   if (use_fuzzy_matching)
@@ -2054,6 +2160,8 @@ merge (const char *fn1, const char *fn2, catalog_input_format_ty input_syntax,
 
   definitions_destroy (&definitions);
 
+  time_report_begin ("merge");
+
   if (!for_msgfmt)
     {
       /* Look for messages in the definition file, which are not present
@@ -2103,6 +2211,8 @@ merge (const char *fn1, const char *fn2, catalog_input_format_ty input_syntax,
         }
     }
 
+  time_report_end ("merge");
+
   /* Determine the known a-priori encoding, if any.  */
   if (def->encoding == ref->encoding)
     result->encoding = def->encoding;
@@ -15,15 +15,15 @@
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 namespace eval msgcat {
-  namespace export mcset mcdump
+  namespace export mcset mcmset mcdump
   variable header ""
 }
 
 proc msgcat::puts_po_string {str} {
-  # Replace " with \"
-  regsub -all "\"" $str "\\\"" str
   # Replace \ with \\
   regsub -all "\\\\" $str "\\\\\\" str
+  # Replace " with \"
+  regsub -all "\"" $str "\\\"" str
   # Replace newline with \n
   regsub -all [subst "\n"] $str "\\n" str
   regsub -all [subst "\a"] $str "\\a" str
@@ -51,6 +51,12 @@ proc msgcat::mcset {locale src {dest ""}} {
   msgcat::write_po_message $src $dest
 }
 
+proc msgcat::mcmset {locale pairs} {
+  foreach {src dest} $pairs {
+    msgcat::write_po_message $src $dest
+  }
+}
+
 # Main function.
 proc msgcat::mcdump {langfile} {
   if {[file exists $langfile]} {
@@ -24,9 +24,16 @@
 #include "read-java.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <sys/stat.h>
+
+#if !defined S_ISDIR && defined S_IFDIR
+# define S_ISDIR(mode) (((mode) & S_IFMT) == S_IFDIR)
+#endif
 
 #include "msgunfmt.h"
 #include "relocatable.h"
@@ -36,14 +43,1374 @@
 #include "read-catalog.h"
 #include "read-po.h"
 #include "error.h"
+#include "c-ctype.h"
+#include "concat-filename.h"
+#include "obstack.h"
+#include "read-file.h"
+#include "unistr.h"
+#include "xalloc.h"
+#include "xmemdup0.h"
+#include "xvasprintf.h"
 #include "gettext.h"
 
+/* Separator in PATH like lists of pathnames.  */
+#if (defined _WIN32 && !defined __CYGWIN__) || defined __EMX__ || defined __DJGPP__
+  /* Native Windows, OS/2, DOS */
+# define PATH_SEPARATOR ';'
+#else
+  /* Unix */
+# define PATH_SEPARATOR ':'
+#endif
+
 #define _(str) gettext (str)
 
 
-/* A Java resource name can only be manipulated by a Java virtual machine.
-   So we start a JVM to execute the DumpResource program, and read its
-   output, which is .po format without comments.  */
+/* ===================== Reading the .class file directly ===================== */
+
+/* The classes that msgfmt generates store their messages in a static field
+   'table', which the static initializer fills with string constants.  This
+   happens in straight-line code, whether the class was written by msgfmt
+   itself or compiled by a Java compiler from the output of "msgfmt --source".
+   So we can extract the messages without a JVM, by executing the static
+   initializer on a small abstract machine that knows only the few
+   instructions and library methods that this code uses.  When the class
+   uses anything else, we give up and let the JVM do the work.  */
+
+#define obstack_chunk_alloc xmalloc
+#define obstack_chunk_free free
+
+/* A Java string, in the "modified UTF-8" encoding of class files.  */
+struct jstring
+{
+  const char *data;
+  size_t length;
+};
+
+enum jvalue_kind
+{
+  JV_NONE,                      /* uninitialized local variable */
+  JV_NULL,
+  JV_INT,
+  JV_STRING,
+  JV_OBJECT
+};
+
+struct jvalue
+{
+  enum jvalue_kind kind;
+  int i;                        /* for JV_INT */
+  struct jstring s;             /* for JV_STRING */
+  struct jobject *o;            /* for JV_OBJECT */
+};
+
+/* An entry of a java.util.Hashtable.  */
+struct jhashtable_entry
+{
+  struct jstring key;
+  struct jvalue value;
+  int hash;
+  int next;                     /* index of next entry in bucket, or -1 */
+};
+
+enum jobject_kind
+{
+  JO_ARRAY,                     /* java.lang.String[] or java.lang.Object[] */
+  JO_HASHTABLE,                 /* java.util.Hashtable */
+  JO_STRINGBUFFER               /* java.lang.StringBuffer or StringBuilder */
+};
+
+struct jobject
+{
+  enum jobject_kind kind;
+  /* For JO_ARRAY.  */
+  size_t nelems;
+  struct jvalue *elems;
+  /* For JO_HASHTABLE.  The buckets and the iteration order are those of the
+     java.util.Hashtable implementation, so that the messages come out in the
+     same order as with the JVM.  */
+  int capacity;
+  int threshold;
+  int count;
+  int *buckets;
+  struct jhashtable_entry *entries;
+  /* For JO_STRINGBUFFER.  */
+  struct jstring contents;
+};
+
+/* A method of the class.  */
+struct jmethod
+{
+  struct jstring name;
+  struct jstring descriptor;
+  unsigned int access_flags;
+  unsigned int max_stack;
+  unsigned int max_locals;
+  const unsigned char *code;
+  size_t code_length;
+};
+
+/* A parsed class file.  */
+struct jclass
+{
+  const unsigned char *data;
+  size_t length;
+  /* The offset of each constant pool entry, or 0 for unused slots.  */
+  unsigned int cp_count;
+  size_t *cp_offsets;
+  struct jstring this_name;
+  size_t nmethods;
+  struct jmethod *methods;
+  /* The value stored in the static field 'table'.  */
+  struct jvalue table;
+  /* Memory for the values of the abstract machine.  */
+  struct obstack mempool;
+};
+
+/* Allocate N objects of the given TYPE in the memory pool of JC.  */
+#define JALLOC(jc, type, n) \
+  ((type *) obstack_alloc (&(jc)->mempool, (n) * sizeof (type)))
+
+/* Maximum nesting depth of the static methods called from <clinit>.  */
+#define MAX_CALL_DEPTH 4
+
+static unsigned int
+get_u2 (const unsigned char *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+static unsigned int
+get_u4 (const unsigned char *p)
+{
+  return ((unsigned int) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static bool
+jstring_equals (struct jstring s, const char *str)
+{
+  return s.length == strlen (str) && memcmp (s.data, str, s.length) == 0;
+}
+
+/* Return the CONSTANT_Utf8 entry at INDEX.  */
+static bool
+cp_get_utf8 (const struct jclass *jc, unsigned int index,
+             struct jstring *result)
+{
+  const unsigned char *p;
+
+  if (index == 0 || index >= jc->cp_count || jc->cp_offsets[index] == 0)
+    return false;
+  p = jc->data + jc->cp_offsets[index];
+  if (p[0] != 1)
+    return false;
+  result->data = (const char *) p + 3;
+  result->length = get_u2 (p + 1);
+  return true;
+}
+
+/* Return the entry at INDEX, which must have the given TAG.  */
+static const unsigned char *
+cp_get (const struct jclass *jc, unsigned int index, unsigned int tag)
+{
+  const unsigned char *p;
+
+  if (index == 0 || index >= jc->cp_count || jc->cp_offsets[index] == 0)
+    return NULL;
+  p = jc->data + jc->cp_offsets[index];
+  return (p[0] == tag ? p : NULL);
+}
+
+/* Return the name of the CONSTANT_Class entry at INDEX.  */
+static bool
+cp_get_class (const struct jclass *jc, unsigned int index,
+              struct jstring *result)
+{
+  const unsigned char *p = cp_get (jc, index, 7);
+
+  return p != NULL && cp_get_utf8 (jc, get_u2 (p + 1), result);
+}
+
+/* Decompose the CONSTANT_Fieldref or CONSTANT_Methodref entry at INDEX.  */
+static bool
+cp_get_ref (const struct jclass *jc, unsigned int index, unsigned int tag,
+            struct jstring *class_name, struct jstring *name,
+            struct jstring *descriptor)
+{
+  const unsigned char *p = cp_get (jc, index, tag);
+  const unsigned char *nt;
+
+  if (p == NULL || !cp_get_class (jc, get_u2 (p + 1), class_name))
+    return false;
+  nt = cp_get (jc, get_u2 (p + 3), 12);
+  return nt != NULL
+         && cp_get_utf8 (jc, get_u2 (nt + 1), name)
+         && cp_get_utf8 (jc, get_u2 (nt + 3), descriptor);
+}
+
+/* Parse the class file in JC->data.  */
+static bool
+parse_class (struct jclass *jc)
+{
+  const unsigned char *data = jc->data;
+  size_t length = jc->length;
+  size_t pos;
+  unsigned int i;
+  unsigned int count;
+
+  if (length < 10 || get_u4 (data) != 0xcafebabe)
+    return false;
+  jc->cp_count = get_u2 (data + 8);
+  jc->cp_offsets = XNMALLOC (jc->cp_count, size_t);
+  memset (jc->cp_offsets, 0, jc->cp_count * sizeof (size_t));
+  pos = 10;
+  for (i = 1; i < jc->cp_count; i++)
+    {
+      size_t entry_length;
+
+      if (pos >= length)
+        return false;
+      jc->cp_offsets[i] = pos;
+      switch (data[pos])
+        {
+        case 1: /* CONSTANT_Utf8 */
+          if (pos + 3 > length)
+            return false;
+          entry_length = 3 + get_u2 (data + pos + 1);
+          break;
+        case 7: /* CONSTANT_Class */
+        case 8: /* CONSTANT_String */
+        case 16: /* CONSTANT_MethodType */
+        case 19: /* CONSTANT_Module */
+        case 20: /* CONSTANT_Package */
+          entry_length = 3;
+          break;
+        case 15: /* CONSTANT_MethodHandle */
+          entry_length = 4;
+          break;
+        case 3: /* CONSTANT_Integer */
+        case 4: /* CONSTANT_Float */
+        case 9: /* CONSTANT_Fieldref */
+        case 10: /* CONSTANT_Methodref */
+        case 11: /* CONSTANT_InterfaceMethodref */
+        case 12: /* CONSTANT_NameAndType */
+        case 17: /* CONSTANT_Dynamic */
+        case 18: /* CONSTANT_InvokeDynamic */
+          entry_length = 5;
+          break;
+        case 5: /* CONSTANT_Long */
+        case 6: /* CONSTANT_Double */
+          entry_length = 9;
+          /* These take two slots.  */
+          i++;
+          break;
+        default:
+          return false;
+        }
+      pos += entry_length;
+      if (pos > length)
+        return false;
+    }
+
+  /* access_flags, this_class, super_class, interfaces.  */
+  if (pos + 8 > length)
+    return false;
+  {
+    struct jstring super_name;
+
+    if (!cp_get_class (jc, get_u2 (data + pos + 2), &jc->this_name)
+        || !cp_get_class (jc, get_u2 (data + pos + 4), &super_name)
+        || !jstring_equals (super_name, "java/util/ResourceBundle"))
+      return false;
+  }
+  pos += 8 + 2 * get_u2 (data + pos + 6);
+
+  /* Fields.  */
+  if (pos + 2 > length)
+    return false;
+  count = get_u2 (data + pos);
+  pos += 2;
+  for (i = 0; i < count; i++)
+    {
+      unsigned int nattributes;
+      unsigned int k;
+
+      if (pos + 8 > length)
+        return false;
+      nattributes = get_u2 (data + pos + 6);
+      pos += 8;
+      for (k = 0; k < nattributes; k++)
+        {
+          if (pos + 6 > length)
+            return false;
+          pos += 6 + (size_t) get_u4 (data + pos + 2);
+        }
+    }
+
+  /* Methods.  */
+  if (pos + 2 > length)
+    return false;
+  count = get_u2 (data + pos);
+  pos += 2;
+  jc->methods = XNMALLOC (count, struct jmethod);
+  jc->nmethods = 0;
+  for (i = 0; i < count; i++)
+    {
+      struct jmethod *m = &jc->methods[jc->nmethods++];
+      unsigned int nattributes;
+      unsigned int k;
+
+      if (pos + 8 > length)
+        return false;
+      m->access_flags = get_u2 (data + pos);
+      if (!cp_get_utf8 (jc, get_u2 (data + pos + 2), &m->name)
+          || !cp_get_utf8 (jc, get_u2 (data + pos + 4), &m->descriptor))
+        return false;
+      m->code = NULL;
+      nattributes = get_u2 (data + pos + 6);
+      pos += 8;
+      for (k = 0; k < nattributes; k++)
+        {
+          struct jstring attribute_name;
+          size_t attribute_length;
+
+          if (pos + 6 > length)
+            return false;
+          attribute_length = get_u4 (data + pos + 2);
+          if (attribute_length > length - pos - 6
+              || !cp_get_utf8 (jc, get_u2 (data + pos), &attribute_name))
+            return false;
+          if (jstring_equals (attribute_name, "Code"))
+            {
+              if (attribute_length < 8)
+                return false;
+              m->max_stack = get_u2 (data + pos + 6);
+              m->max_locals = get_u2 (data + pos + 8);
+              m->code_length = get_u4 (data + pos + 10);
+              if (m->code_length > attribute_length - 8)
+                return false;
+              m->code = data + pos + 14;
+            }
+          pos += 6 + attribute_length;
+        }
+    }
+
+  return true;
+}
+
+/* Find the method with the given name and descriptor.  */
+static const struct jmethod *
+find_method (const struct jclass *jc, struct jstring name,
+             struct jstring descriptor)
+{
+  size_t i;
+
+  for (i = 0; i < jc->nmethods; i++)
+    {
+      const struct jmethod *m = &jc->methods[i];
+      if (m->name.length == name.length
+          && memcmp (m->name.data, name.data, name.length) == 0
+          && m->descriptor.length == descriptor.length
+          && memcmp (m->descriptor.data, descriptor.data,
+                     descriptor.length) == 0)
+        return m;
+    }
+  return NULL;
+}
+
+static const struct jmethod *
+find_method_by_name (const struct jclass *jc, const char *name,
+                     const char *descriptor)
+{
+  struct jstring n;
+  struct jstring d;
+
+  n.data = name;
+  n.length = strlen (name);
+  d.data = descriptor;
+  d.length = strlen (descriptor);
+  return find_method (jc, n, d);
+}
+
+
+/* Return the Java hash code of a string, given in modified UTF-8.  */
+static int
+jstring_hashcode (struct jstring s)
+{
+  const unsigned char *p = (const unsigned char *) s.data;
+  const unsigned char *p_end = p + s.length;
+  unsigned int hash = 0;
+
+  while (p < p_end)
+    {
+      unsigned int c = *p++;
+
+      if (c >= 0xe0 && p + 2 <= p_end)
+        {
+          c = ((c & 0x0f) << 12) | ((p[0] & 0x3f) << 6) | (p[1] & 0x3f);
+          p += 2;
+        }
+      else if (c >= 0xc0 && p + 1 <= p_end)
+        {
+          c = ((c & 0x1f) << 6) | (p[0] & 0x3f);
+          p += 1;
+        }
+      hash = 31 * hash + c;
+    }
+  return (int) hash;
+}
+
+static bool
+jstring_eq (struct jstring s1, struct jstring s2)
+{
+  return s1.length == s2.length && memcmp (s1.data, s2.data, s1.length) == 0;
+}
+
+static struct jobject *
+new_jobject (struct jclass *jc, enum jobject_kind kind)
+{
+  struct jobject *o = JALLOC (jc, struct jobject, 1);
+
+  memset (o, 0, sizeof (struct jobject));
+  o->kind = kind;
+  if (kind == JO_HASHTABLE)
+    {
+      /* The defaults of the java.util.Hashtable constructor.  */
+      int i;
+
+      o->capacity = 11;
+      o->threshold = 8;
+      o->buckets = JALLOC (jc, int, o->capacity);
+      for (i = 0; i < o->capacity; i++)
+        o->buckets[i] = -1;
+    }
+  return o;
+}
+
+/* Look up KEY in the hash table HT.  Return the entry index or -1.  */
+static int
+jhashtable_find (const struct jobject *ht, struct jstring key)
+{
+  int hash = jstring_hashcode (key);
+  int e;
+
+  for (e = ht->buckets[(hash & 0x7fffffff) % ht->capacity];
+       e >= 0;
+       e = ht->entries[e].next)
+    if (ht->entries[e].hash == hash && jstring_eq (ht->entries[e].key, key))
+      return e;
+  return -1;
+}
+
+/* Implement Hashtable.put.  */
+static struct jvalue
+jhashtable_put (struct jclass *jc, struct jobject *ht, struct jstring key,
+                struct jvalue value)
+{
+  struct jvalue old;
+  int e = jhashtable_find (ht, key);
+  int hash;
+  int index;
+
+  if (e >= 0)
+    {
+      old = ht->entries[e].value;
+      ht->entries[e].value = value;
+      return old;
+    }
+
+  if (ht->count >= ht->threshold)
+    {
+      /* Rehash, like java.util.Hashtable.rehash().  */
+      int old_capacity = ht->capacity;
+      int *old_buckets = ht->buckets;
+      int new_capacity = 2 * old_capacity + 1;
+      int i;
+
+      ht->buckets = JALLOC (jc, int, new_capacity);
+      for (i = 0; i < new_capacity; i++)
+        ht->buckets[i] = -1;
+      for (i = old_capacity; i-- > 0; )
+        {
+          int old_e = old_buckets[i];
+
+          while (old_e >= 0)
+            {
+              int next = ht->entries[old_e].next;
+              int new_index =
+                (ht->entries[old_e].hash & 0x7fffffff) % new_capacity;
+
+              ht->entries[old_e].next = ht->buckets[new_index];
+              ht->buckets[new_index] = old_e;
+              old_e = next;
+            }
+        }
+      ht->capacity = new_capacity;
+      ht->threshold = (int) (new_capacity * 0.75f);
+
+      /* Make room for the entries.  */
+      {
+        struct jhashtable_entry *new_entries =
+          JALLOC (jc, struct jhashtable_entry, new_capacity);
+        if (ht->count > 0)
+          memcpy (new_entries, ht->entries,
+                  ht->count * sizeof (struct jhashtable_entry));
+        ht->entries = new_entries;
+      }
+    }
+  else if (ht->entries == NULL)
+    ht->entries =
+      JALLOC (jc, struct jhashtable_entry, ht->capacity);
+
+  hash = jstring_hashcode (key);
+  index = (hash & 0x7fffffff) % ht->capacity;
+  e = ht->count++;
+  ht->entries[e].key = key;
+  ht->entries[e].value = value;
+  ht->entries[e].hash = hash;
+  ht->entries[e].next = ht->buckets[index];
+  ht->buckets[index] = e;
+
+  old.kind = JV_NULL;
+  return old;
+}
+
+/* Count the arguments of a method descriptor that consists only of
+   reference types, such as "([Ljava/lang/Object;)V".  Return -1 if it has
+   other argument types or a non-void return type.  */
+static int
+count_reference_args (struct jstring descriptor)
+{
+  const char *p = descriptor.data;
+  const char *p_end = p + descriptor.length;
+  int count = 0;
+
+  if (p == p_end || *p != '(')
+    return -1;
+  p++;
+  while (p < p_end && *p != ')')
+    {
+      while (p < p_end && *p == '[')
+        p++;
+      if (p == p_end || *p != 'L')
+        return -1;
+      p = memchr (p, ';', p_end - p);
+      if (p == NULL)
+        return -1;
+      p++;
+      count++;
+    }
+  if (!(p + 2 == p_end && p[0] == ')' && p[1] == 'V'))
+    return -1;
+  return count;
+}
+
+/* Execute the static method M, with the arguments ARGS[0..NARGS-1].  If the
+   method returns a reference, store it in *RESULT.  Return false if the
+   method does something that this abstract machine does not understand.  */
+static bool
+execute_method (struct jclass *jc, const struct jmethod *m,
+                const struct jvalue *args, unsigned int nargs,
+                struct jvalue *result, int call_depth)
+{
+  const unsigned char *code = m->code;
+  size_t code_length = m->code_length;
+  struct jvalue *locals;
+  struct jvalue *stack;
+  unsigned int sp;
+  size_t pc;
+  unsigned int i;
+  bool ok = false;
+
+  if (code == NULL || !(m->access_flags & 0x0008) || nargs > m->max_locals
+      || call_depth > MAX_CALL_DEPTH)
+    return false;
+
+  locals = XNMALLOC (m->max_locals + 1, struct jvalue);
+  stack = XNMALLOC (m->max_stack + 1, struct jvalue);
+  for (i = 0; i < m->max_locals; i++)
+    if (i < nargs)
+      locals[i] = args[i];
+    else
+      locals[i].kind = JV_NONE;
+  sp = 0;
+
+#define NEED(n) if (pc + (n) > code_length) goto done
+#define PUSH(v) \
+  do { if (sp >= m->max_stack) goto done; stack[sp++] = (v); } while (0)
+#define POP(v) \
+  do { if (sp == 0) goto done; (v) = stack[--sp]; } while (0)
+
+  for (pc = 0; pc < code_length; )
+    {
+      unsigned int opcode = code[pc];
+      struct jvalue v;
+
+      switch (opcode)
+        {
+        case 0x01: /* aconst_null */
+          v.kind = JV_NULL;
+          PUSH (v);
+          pc += 1;
+          break;
+        case 0x02: case 0x03: case 0x04: case 0x05: case 0x06: case 0x07:
+        case 0x08: /* iconst_<n> */
+          v.kind = JV_INT;
+          v.i = (int) opcode - 0x03;
+          PUSH (v);
+          pc += 1;
+          break;
+        case 0x10: /* bipush */
+          NEED (2);
+          v.kind = JV_INT;
+          v.i = (signed char) code[pc + 1];
+          PUSH (v);
+          pc += 2;
+          break;
+        case 0x11: /* sipush */
+          NEED (3);
+          v.kind = JV_INT;
+          v.i = (short) get_u2 (code + pc + 1);
+          PUSH (v);
+          pc += 3;
+          break;
+        case 0x12: /* ldc */
+        case 0x13: /* ldc_w */
+          {
+            unsigned int index;
+            const unsigned char *p;
+
+            if (opcode == 0x12)
+              {
+                NEED (2);
+                index = code[pc + 1];
+                pc += 2;
+              }
+            else
+              {
+                NEED (3);
+                index = get_u2 (code + pc + 1);
+                pc += 3;
+              }
+            if ((p = cp_get (jc, index, 8)) != NULL)
+              {
+                if (!cp_get_utf8 (jc, get_u2 (p + 1), &v.s))
+                  goto done;
+                v.kind = JV_STRING;
+              }
+            else if ((p = cp_get (jc, index, 3)) != NULL)
+              {
+                v.kind = JV_INT;
+                v.i = (int) get_u4 (p + 1);
+              }
+            else
+              goto done;
+            PUSH (v);
+          }
+          break;
+        case 0x15: /* iload */
+        case 0x19: /* aload */
+        case 0x1a: case 0x1b: case 0x1c: case 0x1d: /* iload_<n> */
+        case 0x2a: case 0x2b: case 0x2c: case 0x2d: /* aload_<n> */
+          {
+            unsigned int index;
+
+            if (opcode == 0x15 || opcode == 0x19)
+              {
+                NEED (2);
+                index = code[pc + 1];
+                pc += 2;
+              }
+            else
+              {
+                index = (opcode < 0x2a ? opcode - 0x1a : opcode - 0x2a);
+                pc += 1;
+              }
+            if (index >= m->max_locals || locals[index].kind == JV_NONE)
+              goto done;
+            PUSH (locals[index]);
+          }
+          break;
+        case 0x36: /* istore */
+        case 0x3a: /* astore */
+        case 0x3b: case 0x3c: case 0x3d: case 0x3e: /* istore_<n> */
+        case 0x4b: case 0x4c: case 0x4d: case 0x4e: /* astore_<n> */
+          {
+            unsigned int index;
+
+            if (opcode == 0x36 || opcode == 0x3a)
+              {
+                NEED (2);
+                index = code[pc + 1];
+                pc += 2;
+              }
+            else
+              {
+                index = (opcode < 0x4b ? opcode - 0x3b : opcode - 0x4b);
+                pc += 1;
+              }
+            if (index >= m->max_locals)
+              goto done;
+            POP (locals[index]);
+          }
+          break;
+        case 0x53: /* aastore */
+          {
+            struct jvalue array;
+            struct jvalue index;
+
+            POP (v);
+            POP (index);
+            POP (array);
+            if (array.kind != JV_OBJECT || array.o->kind != JO_ARRAY
+                || index.kind != JV_INT
+                || index.i < 0 || (size_t) index.i >= array.o->nelems
+                || !(v.kind == JV_NULL || v.kind == JV_STRING
+                     || (v.kind == JV_OBJECT && v.o->kind == JO_ARRAY)))
+              goto done;
+            array.o->elems[index.i] = v;
+            pc += 1;
+          }
+          break;
+        case 0x57: /* pop */
+          POP (v);
+          pc += 1;
+          break;
+        case 0x59: /* dup */
+          if (sp == 0)
+            goto done;
+          v = stack[sp - 1];
+          PUSH (v);
+          pc += 1;
+          break;
+        case 0xb0: /* areturn */
+          POP (v);
+          if (result == NULL)
+            goto done;
+          *result = v;
+          ok = true;
+          goto done;
+        case 0xb1: /* return */
+          ok = (result == NULL);
+          goto done;
+        case 0xb3: /* putstatic */
+          {
+            struct jstring class_name, name, descriptor;
+
+            NEED (3);
+            if (!cp_get_ref (jc, get_u2 (code + pc + 1), 9,
+                             &class_name, &name, &descriptor)
+                || !jstring_eq (class_name, jc->this_name)
+                || !jstring_equals (name, "table"))
+              goto done;
+            POP (jc->table);
+            pc += 3;
+          }
+          break;
+        case 0xbb: /* new */
+          {
+            struct jstring class_name;
+
+            NEED (3);
+            if (!cp_get_class (jc, get_u2 (code + pc + 1), &class_name))
+              goto done;
+            v.kind = JV_OBJECT;
+            if (jstring_equals (class_name, "java/util/Hashtable"))
+              v.o = new_jobject (jc, JO_HASHTABLE);
+            else if (jstring_equals (class_name, "java/lang/StringBuffer")
+                     || jstring_equals (class_name, "java/lang/StringBuilder"))
+              {
+                v.o = new_jobject (jc, JO_STRINGBUFFER);
+                v.o->contents.data = "";
+                v.o->contents.length = 0;
+              }
+            else
+              goto done;
+            PUSH (v);
+            pc += 3;
+          }
+          break;
+        case 0xbd: /* anewarray */
+          {
+            struct jstring class_name;
+            struct jvalue count;
+            size_t k;
+
+            NEED (3);
+            POP (count);
+            if (!cp_get_class (jc, get_u2 (code + pc + 1), &class_name)
+                || !(jstring_equals (class_name, "java/lang/String")
+                     || jstring_equals (class_name, "java/lang/Object"))
+                || count.kind != JV_INT || count.i < 0 || count.i > 0x1000000)
+              goto done;
+            v.kind = JV_OBJECT;
+            v.o = new_jobject (jc, JO_ARRAY);
+            v.o->nelems = count.i;
+            v.o->elems = JALLOC (jc, struct jvalue, count.i);
+            for (k = 0; k < v.o->nelems; k++)
+              v.o->elems[k].kind = JV_NULL;
+            PUSH (v);
+            pc += 3;
+          }
+          break;
+        case 0xb6: /* invokevirtual */
+        case 0xb7: /* invokespecial */
+        case 0xb8: /* invokestatic */
+          {
+            struct jstring class_name, name, descriptor;
+
+            NEED (3);
+            if (!cp_get_ref (jc, get_u2 (code + pc + 1), 10,
+                             &class_name, &name, &descriptor))
+              goto done;
+            pc += 3;
+            if (opcode == 0xb8)
+              {
+                /* A call to a clinit_part_<n> method.  */
+                const struct jmethod *callee;
+                int n;
+
+                if (!jstring_eq (class_name, jc->this_name))
+                  goto done;
+                callee = find_method (jc, name, descriptor);
+                n = count_reference_args (descriptor);
+                if (callee == NULL || n < 0 || (unsigned int) n > sp
+                    || !execute_method (jc, callee, stack + sp - n, n, NULL,
+                                        call_depth + 1))
+                  goto done;
+                sp -= n;
+              }
+            else if (opcode == 0xb7)
+              {
+                /* A constructor call, after 'new'.  */
+                POP (v);
+                if (!jstring_equals (name, "<init>")
+                    || !jstring_equals (descriptor, "()V")
+                    || v.kind != JV_OBJECT || v.o->kind == JO_ARRAY)
+                  goto done;
+              }
+            else if (jstring_equals (class_name, "java/util/Hashtable")
+                     && jstring_equals (name, "put"))
+              {
+                struct jvalue ht, key;
+
+                POP (v);
+                POP (key);
+                POP (ht);
+                if (ht.kind != JV_OBJECT || ht.o->kind != JO_HASHTABLE
+                    || key.kind != JV_STRING
+                    || !(v.kind == JV_STRING
+                         || (v.kind == JV_OBJECT && v.o->kind == JO_ARRAY)))
+                  goto done;
+                v = jhashtable_put (jc, ht.o, key.s, v);
+                PUSH (v);
+              }
+            else if ((jstring_equals (class_name, "java/lang/StringBuffer")
+                      || jstring_equals (class_name,
+                                         "java/lang/StringBuilder"))
+                     && jstring_equals (name, "append")
+                     && descriptor.length > 20
+                     && memcmp (descriptor.data, "(Ljava/lang/String;)", 20)
+                        == 0)
+              {
+                struct jvalue sb, str;
+                char *contents;
+
+                POP (str);
+                POP (sb);
+                if (sb.kind != JV_OBJECT || sb.o->kind != JO_STRINGBUFFER
+                    || str.kind != JV_STRING)
+                  goto done;
+                /* Allocate a fresh copy, so that the strings returned by
+                   toString() stay unchanged.  */
+                contents =
+                  (char *) obstack_alloc (&jc->mempool,
+                                          sb.o->contents.length
+                                          + str.s.length + 1);
+                memcpy (contents, sb.o->contents.data, sb.o->contents.length);
+                memcpy (contents + sb.o->contents.length, str.s.data,
+                        str.s.length);
+                sb.o->contents.data = contents;
+                sb.o->contents.length += str.s.length;
+                PUSH (sb);
+              }
+            else if ((jstring_equals (class_name, "java/lang/StringBuffer")
+                      || jstring_equals (class_name,
+                                         "java/lang/StringBuilder"))
+                     && jstring_equals (name, "toString"))
+              {
+                POP (v);
+                if (v.kind != JV_OBJECT || v.o->kind != JO_STRINGBUFFER)
+                  goto done;
+                v.kind = JV_STRING;
+                v.s = v.o->contents;
+                PUSH (v);
+              }
+            else
+              goto done;
+          }
+          break;
+        default:
+          /* Branches, field reads and all other instructions are not used
+             by the code that initializes the messages.  */
+          goto done;
+        }
+    }
+
+ done:
+#undef POP
+#undef PUSH
+#undef NEED
+  free (stack);
+  free (locals);
+  return ok;
+}
+
+
+/* Convert a string from modified UTF-8 to UTF-8.  Return NULL if it
+   contains a NUL character or an unpaired surrogate, which cannot be
+   represented in a PO file.  */
+static char *
+jstring_to_utf8 (struct jstring s)
+{
+  const unsigned char *p = (const unsigned char *) s.data;
+  const unsigned char *p_end = p + s.length;
+  /* A surrogate pair takes 6 bytes in modified UTF-8 and 4 bytes in
+     UTF-8.  All other characters have the same length in both.  */
+  char *result = XNMALLOC (s.length + 1, char);
+  char *q = result;
+
+  while (p < p_end)
+    {
+      unsigned int c = *p;
+      unsigned int n;
+
+      if (c < 0x80)
+        {
+          if (c == 0)
+            goto fail;
+          n = 1;
+        }
+      else if (c >= 0xc0 && c < 0xe0 && p + 2 <= p_end)
+        {
+          c = ((c & 0x1f) << 6) | (p[1] & 0x3f);
+          n = 2;
+        }
+      else if (c >= 0xe0 && c < 0xf0 && p + 3 <= p_end)
+        {
+          c = ((c & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+          n = 3;
+          if (c >= 0xd800 && c < 0xdc00)
+            {
+              /* A high surrogate, which must be followed by a low one.  */
+              unsigned int c2;
+
+              if (!(p + 6 <= p_end && (p[3] & 0xf0) == 0xe0))
+                goto fail;
+              c2 = ((p[3] & 0x0f) << 12) | ((p[4] & 0x3f) << 6)
+                   | (p[5] & 0x3f);
+              if (!(c2 >= 0xdc00 && c2 < 0xe000))
+                goto fail;
+              c = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+              n = 6;
+            }
+          else if (c >= 0xdc00 && c < 0xe000)
+            goto fail;
+        }
+      else
+        goto fail;
+      if (c == 0)
+        goto fail;
+      q += u8_uctomb ((uint8_t *) q, c, 6);
+      p += n;
+    }
+  *q = '\0';
+  return result;
+
+ fail:
+  free (result);
+  return NULL;
+}
+
+/* Add a message with key KEY and value VALUE (a String or a String[]) to
+   MLP.  */
+static bool
+add_message (message_list_ty *mlp, struct jstring key,
+             const struct jvalue *value, const struct jvalue *msgid_plural)
+{
+  static lex_pos_ty pos = { __FILE__, __LINE__ };
+  char *msgctxt;
+  char *msgid;
+  char *msgid_plural_str;
+  char *msgstr;
+  size_t msgstr_len;
+  char *separator;
+
+  msgid = jstring_to_utf8 (key);
+  if (msgid == NULL)
+    return false;
+
+  if (value->kind == JV_STRING)
+    {
+      if (msgid_plural != NULL)
+        goto fail1;
+      msgid_plural_str = NULL;
+      msgstr = jstring_to_utf8 (value->s);
+      if (msgstr == NULL)
+        goto fail1;
+      msgstr_len = strlen (msgstr) + 1;
+    }
+  else if (value->kind == JV_OBJECT && value->o->kind == JO_ARRAY
+           && value->o->nelems > 0
+           && msgid_plural != NULL && msgid_plural->kind == JV_STRING)
+    {
+      size_t k;
+
+      msgid_plural_str = jstring_to_utf8 (msgid_plural->s);
+      if (msgid_plural_str == NULL)
+        goto fail1;
+      msgstr = NULL;
+      msgstr_len = 0;
+      for (k = 0; k < value->o->nelems; k++)
+        {
+          const struct jvalue *form = &value->o->elems[k];
+          char *str;
+          size_t len;
+
+          if (form->kind != JV_STRING
+              || (str = jstring_to_utf8 (form->s)) == NULL)
+            {
+              free (msgstr);
+              free (msgid_plural_str);
+              goto fail1;
+            }
+          len = strlen (str) + 1;
+          msgstr = (char *) xrealloc (msgstr, msgstr_len + len);
+          memcpy (msgstr + msgstr_len, str, len);
+          msgstr_len += len;
+          free (str);
+        }
+    }
+  else
+    goto fail1;
+
+  /* The key consists of msgctxt and msgid, separated by MSGCTXT_SEPARATOR.  */
+  separator = strchr (msgid, MSGCTXT_SEPARATOR);
+  if (separator != NULL)
+    {
+      *separator = '\0';
+      msgctxt = msgid;
+      msgid = xstrdup (separator + 1);
+    }
+  else
+    msgctxt = NULL;
+
+  message_list_append (mlp,
+                       message_alloc (msgctxt, msgid, msgid_plural_str,
+                                      msgstr, msgstr_len, &pos));
+  return true;
+
+ fail1:
+  free (msgid);
+  return false;
+}
+
+/* Add a header entry to MLP, for a class that has none.  DumpResource does
+   the same.  */
+static void
+add_default_header (message_list_ty *mlp)
+{
+  static lex_pos_ty pos = { __FILE__, __LINE__ };
+  static const char header[] = "Content-Type: text/plain; charset=UTF-8\n";
+
+  message_list_append (mlp,
+                       message_alloc (NULL, xstrdup (""), NULL,
+                                      xstrdup (header), sizeof (header),
+                                      &pos));
+}
+
+/* Extract the messages from the class file JC, in the same order as the
+   DumpResource program.  */
+static msgdomain_list_ty *
+extract_messages (struct jclass *jc)
+{
+  const struct jmethod *m;
+  struct jvalue plural_table;
+  msgdomain_list_ty *mdlp;
+  message_list_ty *mlp;
+  bool ok;
+
+  /* Execute the static initializer.  */
+  jc->table.kind = JV_NONE;
+  m = find_method_by_name (jc, "<clinit>", "()V");
+  if (m == NULL || !execute_method (jc, m, NULL, 0, NULL, 0)
+      || jc->table.kind != JV_OBJECT)
+    return NULL;
+
+  /* Get the msgid_plural strings.  */
+  plural_table.kind = JV_NULL;
+  m = find_method_by_name (jc, "get_msgid_plural_table",
+                           "()[Ljava/lang/String;");
+  if (m == NULL)
+    m = find_method_by_name (jc, "get_msgid_plural_table",
+                             "()Ljava/util/Hashtable;");
+  if (m != NULL
+      && !(execute_method (jc, m, NULL, 0, &plural_table, 0)
+           && plural_table.kind == JV_OBJECT))
+    return NULL;
+
+  mdlp = msgdomain_list_alloc (false);
+  mlp = mdlp->item[0]->messages;
+  ok = true;
+
+  if (jc->table.o->kind == JO_ARRAY)
+    {
+      /* The Java2 format: pairs (msgid, msgstr) in a hash table, which
+         getKeys() enumerates in ascending order.  */
+      const struct jobject *table = jc->table.o;
+      size_t plural_index = 0;
+      size_t k;
+
+      if (table->nelems % 2 != 0
+          || !(plural_table.kind == JV_NULL
+               || plural_table.o->kind == JO_ARRAY))
+        ok = false;
+
+      /* The header entry comes first.  */
+      for (k = 0; ok && k < table->nelems; k += 2)
+        if (table->elems[k].kind == JV_STRING
+            && table->elems[k].s.length == 0)
+          break;
+      if (ok)
+        {
+          if (k < table->nelems)
+            ok = add_message (mlp, table->elems[k].s, &table->elems[k + 1],
+                              NULL);
+          else
+            add_default_header (mlp);
+        }
+
+      for (k = 0; ok && k < table->nelems; k += 2)
+        {
+          const struct jvalue *key = &table->elems[k];
+          const struct jvalue *value = &table->elems[k + 1];
+          const struct jvalue *msgid_plural = NULL;
+
+          if (key->kind == JV_NULL)
+            continue;
+          if (key->kind != JV_STRING)
+            ok = false;
+          else
+            {
+              /* The msgid_plural table lists the plural messages in the
+                 same order.  */
+              if (value->kind == JV_OBJECT)
+                {
+                  if (plural_table.kind == JV_NULL
+                      || plural_index >= plural_table.o->nelems)
+                    ok = false;
+                  else
+                    msgid_plural = &plural_table.o->elems[plural_index++];
+                }
+              if (ok && key->s.length > 0)
+                ok = add_message (mlp, key->s, value, msgid_plural);
+            }
+        }
+      if (ok && plural_table.kind == JV_OBJECT
+          && plural_index != plural_table.o->nelems)
+        ok = false;
+    }
+  else if (jc->table.o->kind == JO_HASHTABLE)
+    {
+      /* The Java 1.1 format: a java.util.Hashtable, whose keys() method
+         enumerates the buckets from the last to the first.  */
+      const struct jobject *table = jc->table.o;
+      struct jstring empty;
+      int e;
+      int b;
+
+      if (!(plural_table.kind == JV_NULL
+            || plural_table.o->kind == JO_HASHTABLE))
+        ok = false;
+
+      empty.data = "";
+      empty.length = 0;
+      e = (table->count > 0 ? jhashtable_find (table, empty) : -1);
+      if (ok && e >= 0)
+        ok = add_message (mlp, empty, &table->entries[e].value, NULL);
+      else if (ok)
+        add_default_header (mlp);
+
+      for (b = table->capacity; ok && b-- > 0; )
+        for (e = table->buckets[b]; ok && e >= 0; e = table->entries[e].next)
+          {
+            const struct jhashtable_entry *entry = &table->entries[e];
+            const struct jvalue *msgid_plural = NULL;
+
+            if (entry->key.length == 0)
+              continue;
+            if (entry->value.kind == JV_OBJECT)
+              {
+                int pe = (plural_table.kind == JV_OBJECT
+                          ? jhashtable_find (plural_table.o, entry->key)
+                          : -1);
+                if (pe < 0)
+                  {
+                    ok = false;
+                    break;
+                  }
+                msgid_plural = &plural_table.o->entries[pe].value;
+              }
+            ok = add_message (mlp, entry->key, &entry->value, msgid_plural);
+          }
+    }
+  else
+    ok = false;
+
+  if (!ok)
+    {
+      msgdomain_list_free (mdlp);
+      return NULL;
+    }
+  return mdlp;
+}
+
+/* Read the messages from the class file FILENAME.  Return NULL if it is not
+   a class file that we understand.  */
+static msgdomain_list_ty *
+read_class_file (const char *filename)
+{
+  FILE *fp;
+  char *contents;
+  size_t contents_length;
+  struct jclass jc;
+  msgdomain_list_ty *result;
+
+  fp = fopen (filename, "rb");
+  if (fp == NULL)
+    return NULL;
+  contents = fread_file (fp, 0, &contents_length);
+  fclose (fp);
+  if (contents == NULL)
+    return NULL;
+
+  jc.data = (const unsigned char *) contents;
+  jc.length = contents_length;
+  jc.cp_offsets = NULL;
+  jc.methods = NULL;
+  obstack_init (&jc.mempool);
+
+  result = (parse_class (&jc) ? extract_messages (&jc) : NULL);
+
+  obstack_free (&jc.mempool, NULL);
+  free (jc.methods);
+  free (jc.cp_offsets);
+  free (contents);
+  return result;
+}
+
+/* Return the file name of the class file for the resource given by
+   RESOURCE_NAME and LOCALE_NAME, or NULL if it cannot be determined without
+   a JVM.  The class is searched in the CLASSPATH, like the JVM does.  */
+static char *
+find_class_file (const char *resource_name, const char *locale_name)
+{
+  const char *classpath;
+  char *class_file_name;
+  char *p;
+  char *result;
+
+  classpath = getenv ("CLASSPATH");
+  if (classpath == NULL || classpath[0] == '\0')
+    return NULL;
+
+  /* ResourceBundle.getBundle looks for the class whose name is made of the
+     resource name and the locale, as normalized by java.util.Locale.  */
+  if (locale_name != NULL && locale_name[0] != '\0')
+    {
+      const char *country = strchr (locale_name, '_');
+      size_t language_len =
+        (country != NULL ? country - locale_name : strlen (locale_name));
+      char *q;
+
+      /* java.util.Locale renames some language codes.  Leave these to the
+         JVM.  */
+      if (language_len == 2
+          && (memcmp (locale_name, "he", 2) == 0
+              || memcmp (locale_name, "yi", 2) == 0
+              || memcmp (locale_name, "id", 2) == 0
+              || memcmp (locale_name, "iw", 2) == 0
+              || memcmp (locale_name, "ji", 2) == 0
+              || memcmp (locale_name, "in", 2) == 0))
+        return NULL;
+
+      class_file_name =
+        xasprintf ("%s_%s.class", resource_name, locale_name);
+      /* Lowercase the language, uppercase the country.  */
+      q = class_file_name + strlen (resource_name) + 1;
+      for (; *q != '\0' && *q != '_' && *q != '.'; q++)
+        *q = c_tolower (*q);
+      if (*q == '_')
+        for (q++; *q != '\0' && *q != '_' && *q != '.'; q++)
+          *q = c_toupper (*q);
+    }
+  else
+    class_file_name = xasprintf ("%s.class", resource_name);
+  /* The package name becomes a directory name.  */
+  {
+    char *suffix = strrchr (class_file_name, '.');
+
+    for (p = class_file_name; p < suffix; p++)
+      if (*p == '.')
+        *p = '/';
+  }
+
+  result = NULL;
+  for (;;)
+    {
+      const char *end = strchr (classpath, PATH_SEPARATOR);
+      size_t len = (end != NULL ? end - classpath : strlen (classpath));
+      char *dir = (len > 0 ? xmemdup0 (classpath, len) : xstrdup ("."));
+      struct stat statbuf;
+
+      if (stat (dir, &statbuf) >= 0)
+        {
+          if (!S_ISDIR (statbuf.st_mode))
+            {
+              /* A .jar or .zip file, that may contain the class.  */
+              free (dir);
+              break;
+            }
+          else
+            {
+              char *file_name =
+                xconcatenated_filename (dir, class_file_name, NULL);
+
+              if (stat (file_name, &statbuf) >= 0)
+                {
+                  free (dir);
+                  result = file_name;
+                  break;
+                }
+              free (file_name);
+            }
+        }
+      free (dir);
+
+      if (end == NULL)
+        break;
+      classpath = end + 1;
+    }
+
+  free (class_file_name);
+  return result;
+}
+
+
+/* ======================= Reading through the JVM ======================= */
+
+/* For classes that are not in a directory of the CLASSPATH, or that were
+   not generated by msgfmt, we start a JVM to execute the DumpResource
+   program, and read its output, which is .po format without comments.  */
 
 struct locals
 {
@@ -104,6 +1471,20 @@ msgdomain_read_java (const char *resource_name, const char *locale_name)
   if (resource_name == NULL)
     resource_name = "Messages";
 
+  /* Read the class file directly, if possible.  */
+  {
+    char *class_file_name = find_class_file (resource_name, locale_name);
+
+    if (class_file_name != NULL)
+      {
+        msgdomain_list_ty *mdlp = read_class_file (class_file_name);
+
+        free (class_file_name);
+        if (mdlp != NULL)
+          return mdlp;
+      }
+  }
+
   /* Prepare arguments.  */
   args[0] = resource_name;
   if (locale_name != NULL)
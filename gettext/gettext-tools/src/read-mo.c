@@ -28,6 +28,12 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if HAVE_MMAP && HAVE_MUNMAP
+# include <sys/mman.h>
+#endif
 
 /* These two include files describe the binary .mo format.  */
 #include "gmo.h"
@@ -50,13 +56,17 @@ enum mo_endianness
   MO_BIG_ENDIAN
 };
 
-/* We read the file completely into memory.  This is more efficient than
-   lots of lseek().  This struct represents the .mo file in memory.  */
+/* We read the file completely into memory, or map it into memory.  This is
+   more efficient than lots of lseek().  This struct represents the .mo file
+   in memory.  */
 struct binary_mo_file
 {
   const char *filename;
   char *data;
   size_t size;
+  /* True if DATA is a read-only mapping of the file, false if it has been
+     allocated with malloc.  */
+  bool mapped;
   enum mo_endianness endian;
 };
 
@@ -70,6 +80,35 @@ read_binary_mo_file (struct binary_mo_file *bfp,
   size_t alloc = 0;
   size_t size = 0;
   size_t count;
+  struct stat statbuf;
+
+  bfp->filename = filename;
+  bfp->mapped = false;
+
+  if (fp != stdin
+      && fstat (fileno (fp), &statbuf) >= 0 && S_ISREG (statbuf.st_mode)
+      && statbuf.st_size > 0 && (size_t) statbuf.st_size == statbuf.st_size)
+    {
+#if HAVE_MMAP && HAVE_MUNMAP
+      /* Nothing writes to the contents.  Therefore the pages can stay shared
+         with the page cache, and only the pages that are actually accessed
+         are read from the disk.  */
+      buf = (char *) mmap (NULL, statbuf.st_size, PROT_READ, MAP_PRIVATE,
+                           fileno (fp), 0);
+      if (buf != (char *) MAP_FAILED)
+        {
+          bfp->data = buf;
+          bfp->size = statbuf.st_size;
+          bfp->mapped = true;
+          return;
+        }
+      buf = NULL;
+#endif
+      /* Allocate the buffer with its final size.  The additional increment
+         avoids a reallocation when fread() detects the end of file.  */
+      alloc = xsum (statbuf.st_size, 4096);
+      buf = XNMALLOC (alloc, char);
+    }
 
   while (!feof (fp))
     {
@@ -92,7 +131,6 @@ read_binary_mo_file (struct binary_mo_file *bfp,
         size += count;
     }
   buf = (char *) xrealloc (buf, size);
-  bfp->filename = filename;
   bfp->data = buf;
   bfp->size = size;
 }
@@ -247,15 +285,28 @@ get_sysdep_string (const struct binary_mo_file *bfp, size_t offset,
   return string;
 }
 
-/* Reads an existing .mo file and adds the messages to mlp.  */
-void
-read_mo_file (message_list_ty *mlp, const char *filename)
+/* A .mo file, opened for reading its messages one at a time.  */
+struct mo_file_ty
 {
-  FILE *fp;
   struct binary_mo_file bf;
   struct mo_file_header header;
+  /* Storage for the msgctxt returned by mo_file_get_message.  */
+  char *msgctxt_buf;
+  size_t msgctxt_buf_size;
+  /* The strings of the last system dependent message returned by
+     mo_file_get_message, or NULL.  */
+  char *sysdep_msgid;
+  char *sysdep_msgstr;
+};
+
+mo_file_ty *
+mo_file_open (const char *filename)
+{
+  FILE *fp;
+  mo_file_ty *mfp;
+  struct binary_mo_file *bfp;
+  struct mo_file_header *hp;
   unsigned int i;
-  static lex_pos_ty pos = { __FILE__, __LINE__ };
 
   if (strcmp (filename, "-") == 0 || strcmp (filename, "/dev/stdin") == 0)
     {
@@ -270,23 +321,30 @@ read_mo_file (message_list_ty *mlp, const char *filename)
                _("error while opening \"%s\" for reading"), filename);
     }
 
+  mfp = XMALLOC (mo_file_ty);
+  bfp = &mfp->bf;
+  hp = &mfp->header;
+
   /* Read the file contents into memory.  */
-  read_binary_mo_file (&bf, fp, filename);
+  read_binary_mo_file (bfp, fp, filename);
+
+  if (fp != stdin)
+    fclose (fp);
 
   /* Get a 32-bit number from the file header.  */
 # define GET_HEADER_FIELD(field) \
-    get_uint32 (&bf, offsetof (struct mo_file_header, field))
+    get_uint32 (bfp, offsetof (struct mo_file_header, field))
 
   /* We must grope the file to determine which endian it is.
      Perversity of the universe tends towards maximum, so it will
      probably not match the currently executing architecture.  */
-  bf.endian = MO_BIG_ENDIAN;
-  header.magic = GET_HEADER_FIELD (magic);
-  if (header.magic != _MAGIC)
+  bfp->endian = MO_BIG_ENDIAN;
+  hp->magic = GET_HEADER_FIELD (magic);
+  if (hp->magic != _MAGIC)
     {
-      bf.endian = MO_LITTLE_ENDIAN;
-      header.magic = GET_HEADER_FIELD (magic);
-      if (header.magic != _MAGIC)
+      bfp->endian = MO_LITTLE_ENDIAN;
+      hp->magic = GET_HEADER_FIELD (magic);
+      if (hp->magic != _MAGIC)
         {
         unrecognised:
           error (EXIT_FAILURE, 0, _("file \"%s\" is not in GNU .mo format"),
@@ -294,19 +352,19 @@ read_mo_file (message_list_ty *mlp, const char *filename)
         }
     }
 
-  header.revision = GET_HEADER_FIELD (revision);
+  hp->revision = GET_HEADER_FIELD (revision);
 
   /* We support only the major revisions 0 and 1.  */
-  switch (header.revision >> 16)
+  switch (hp->revision >> 16)
     {
     case 0:
     case 1:
       /* Fill the header parts that apply to major revisions 0 and 1.  */
-      header.nstrings = GET_HEADER_FIELD (nstrings);
-      header.orig_tab_offset = GET_HEADER_FIELD (orig_tab_offset);
-      header.trans_tab_offset = GET_HEADER_FIELD (trans_tab_offset);
-      header.hash_tab_size = GET_HEADER_FIELD (hash_tab_size);
-      header.hash_tab_offset = GET_HEADER_FIELD (hash_tab_offset);
+      hp->nstrings = GET_HEADER_FIELD (nstrings);
+      hp->orig_tab_offset = GET_HEADER_FIELD (orig_tab_offset);
+      hp->trans_tab_offset = GET_HEADER_FIELD (trans_tab_offset);
+      hp->hash_tab_size = GET_HEADER_FIELD (hash_tab_size);
+      hp->hash_tab_offset = GET_HEADER_FIELD (hash_tab_offset);
 
       /* The following verifications attempt to ensure that 'msgunfmt' complains
          about a .mo file that may make libintl crash at run time.  */
@@ -315,12 +373,12 @@ read_mo_file (message_list_ty *mlp, const char *filename)
       {
         char *prev_msgid = NULL;
 
-        for (i = 0; i < header.nstrings; i++)
+        for (i = 0; i < hp->nstrings; i++)
           {
             char *msgid;
             size_t msgid_len;
 
-            msgid = get_string (&bf, header.orig_tab_offset + i * 8,
+            msgid = get_string (bfp, hp->orig_tab_offset + i * 8,
                                 &msgid_len);
             if (i == 0)
               prev_msgid = msgid;
@@ -335,36 +393,36 @@ read_mo_file (message_list_ty *mlp, const char *filename)
       }
 
       /* Verify the hash table.  */
-      if (header.hash_tab_size > 0)
+      if (hp->hash_tab_size > 0)
         {
           char *seen;
           unsigned int j;
 
           /* Verify the hash table's size.  */
-          if (!(header.hash_tab_size > 2))
+          if (!(hp->hash_tab_size > 2))
             error (EXIT_FAILURE, 0,
                    _("file \"%s\" is not in GNU .mo format: The hash table size is invalid."),
                    filename);
 
           /* Verify that the non-empty hash table entries contain the values
              1, ..., nstrings, each exactly once.  */
-          seen = (char *) xcalloc (header.nstrings, 1);
-          for (j = 0; j < header.hash_tab_size; j++)
+          seen = (char *) xcalloc (hp->nstrings, 1);
+          for (j = 0; j < hp->hash_tab_size; j++)
             {
               nls_uint32 entry =
-                get_uint32 (&bf, header.hash_tab_offset + j * 4);
+                get_uint32 (bfp, hp->hash_tab_offset + j * 4);
 
               if (entry != 0)
                 {
                   i = entry - 1;
-                  if (!(i < header.nstrings && seen[i] == 0))
+                  if (!(i < hp->nstrings && seen[i] == 0))
                     error (EXIT_FAILURE, 0,
                            _("file \"%s\" is not in GNU .mo format: The hash table contains invalid entries."),
                            filename);
                   seen[i] = 1;
                 }
             }
-          for (i = 0; i < header.nstrings; i++)
+          for (i = 0; i < hp->nstrings; i++)
             if (seen[i] == 0)
               error (EXIT_FAILURE, 0, _("file \"%s\" is not in GNU .mo format: Some messages are not present in the hash table."),
                      filename);
@@ -372,18 +430,18 @@ read_mo_file (message_list_ty *mlp, const char *filename)
 
           /* Verify that the hash table lookup algorithm finds the entry for
              each message.  */
-          for (i = 0; i < header.nstrings; i++)
+          for (i = 0; i < hp->nstrings; i++)
             {
               size_t msgid_len;
-              char *msgid = get_string (&bf, header.orig_tab_offset + i * 8,
+              char *msgid = get_string (bfp, hp->orig_tab_offset + i * 8,
                                         &msgid_len);
               nls_uint32 hash_val = hash_string (msgid);
-              nls_uint32 idx = hash_val % header.hash_tab_size;
-              nls_uint32 incr = 1 + (hash_val % (header.hash_tab_size - 2));
+              nls_uint32 idx = hash_val % hp->hash_tab_size;
+              nls_uint32 incr = 1 + (hash_val % (hp->hash_tab_size - 2));
               for (;;)
                 {
                   nls_uint32 entry =
-                    get_uint32 (&bf, header.hash_tab_offset + idx * 4);
+                    get_uint32 (bfp, hp->hash_tab_offset + idx * 4);
 
                   if (entry == 0)
                     error (EXIT_FAILURE, 0,
@@ -392,180 +450,272 @@ read_mo_file (message_list_ty *mlp, const char *filename)
                   if (entry == i + 1)
                     break;
 
-                  if (idx >= header.hash_tab_size - incr)
-                    idx -= header.hash_tab_size - incr;
+                  if (idx >= hp->hash_tab_size - incr)
+                    idx -= hp->hash_tab_size - incr;
                   else
                     idx += incr;
                 }
             }
         }
 
-      for (i = 0; i < header.nstrings; i++)
-        {
-          message_ty *mp;
-          char *msgctxt;
-          char *msgid;
-          size_t msgid_len;
-          char *separator;
-          char *msgstr;
-          size_t msgstr_len;
-
-          /* Read the msgctxt and msgid.  */
-          msgid = get_string (&bf, header.orig_tab_offset + i * 8,
-                              &msgid_len);
-          /* Split into msgctxt and msgid.  */
-          separator = strchr (msgid, MSGCTXT_SEPARATOR);
-          if (separator != NULL)
-            {
-              /* The part before the MSGCTXT_SEPARATOR is the msgctxt.  */
-              *separator = '\0';
-              msgctxt = msgid;
-              msgid = separator + 1;
-              msgid_len -= msgid - msgctxt;
-            }
-          else
-            msgctxt = NULL;
-
-          /* Read the msgstr.  */
-          msgstr = get_string (&bf, header.trans_tab_offset + i * 8,
-                               &msgstr_len);
-
-          mp = message_alloc (msgctxt,
-                              msgid,
-                              (strlen (msgid) + 1 < msgid_len
-                               ? msgid + strlen (msgid) + 1
-                               : NULL),
-                              msgstr, msgstr_len,
-                              &pos);
-          message_list_append (mlp, mp);
-        }
-
-      switch (header.revision & 0xffff)
+      switch (hp->revision & 0xffff)
         {
         case 0:
+          hp->n_sysdep_segments = 0;
+          hp->sysdep_segments_offset = 0;
+          hp->n_sysdep_strings = 0;
+          hp->orig_sysdep_tab_offset = 0;
+          hp->trans_sysdep_tab_offset = 0;
           break;
         case 1:
         default:
           /* Fill the header parts that apply to minor revision >= 1.  */
-          header.n_sysdep_segments = GET_HEADER_FIELD (n_sysdep_segments);
-          header.sysdep_segments_offset =
+          hp->n_sysdep_segments = GET_HEADER_FIELD (n_sysdep_segments);
+          hp->sysdep_segments_offset =
             GET_HEADER_FIELD (sysdep_segments_offset);
-          header.n_sysdep_strings = GET_HEADER_FIELD (n_sysdep_strings);
-          header.orig_sysdep_tab_offset =
+          hp->n_sysdep_strings = GET_HEADER_FIELD (n_sysdep_strings);
+          hp->orig_sysdep_tab_offset =
             GET_HEADER_FIELD (orig_sysdep_tab_offset);
-          header.trans_sysdep_tab_offset =
+          hp->trans_sysdep_tab_offset =
             GET_HEADER_FIELD (trans_sysdep_tab_offset);
+          break;
+        }
+      break;
+
+    default:
+      goto unrecognised;
+    }
+
+# undef GET_HEADER_FIELD
+
+  mfp->msgctxt_buf = NULL;
+  mfp->msgctxt_buf_size = 0;
+  mfp->sysdep_msgid = NULL;
+  mfp->sysdep_msgstr = NULL;
+
+  return mfp;
+}
+
+size_t
+mo_file_nmessages (const mo_file_ty *mfp)
+{
+  return (size_t) mfp->header.nstrings + mfp->header.n_sysdep_strings;
+}
+
+/* Stores the message number I of MFP in *MSGP, except that MSGP->msgctxt
+   is not NUL terminated; its length is stored in *MSGCTXT_LENP.
+   The strings of a system dependent message are freshly allocated; the
+   msgctxt, if any, is at the beginning of the memory block of the msgid.
+   The other strings point into the file's contents.  */
+static void
+read_message (mo_file_ty *mfp, size_t i, struct mo_message *msgp,
+              size_t *msgctxt_lenp)
+{
+  const struct binary_mo_file *bfp = &mfp->bf;
+  const struct mo_file_header *hp = &mfp->header;
+  char *msgid;
+  size_t msgid_len;
+  char *separator;
+
+  if (i < hp->nstrings)
+    {
+      /* Read the msgctxt and msgid.  */
+      msgid = get_string (bfp, hp->orig_tab_offset + i * 8, &msgid_len);
+      /* Read the msgstr.  */
+      msgp->msgstr =
+        get_string (bfp, hp->trans_tab_offset + i * 8, &msgp->msgstr_len);
+      msgp->sysdep = false;
+    }
+  else
+    {
+      nls_uint32 offset;
+
+      i -= hp->nstrings;
+      /* Read the msgctxt and msgid.  */
+      offset = get_uint32 (bfp, hp->orig_sysdep_tab_offset + i * 4);
+      msgid = get_sysdep_string (bfp, offset, hp, &msgid_len);
+      /* Read the msgstr.  */
+      offset = get_uint32 (bfp, hp->trans_sysdep_tab_offset + i * 4);
+      msgp->msgstr = get_sysdep_string (bfp, offset, hp, &msgp->msgstr_len);
+      msgp->sysdep = true;
+    }
+
+  /* Split into msgctxt and msgid.  */
+  separator = strchr (msgid, MSGCTXT_SEPARATOR);
+  if (separator != NULL)
+    {
+      /* The part before the MSGCTXT_SEPARATOR is the msgctxt.  */
+      msgp->msgctxt = msgid;
+      *msgctxt_lenp = separator - msgid;
+      msgp->msgid = separator + 1;
+      msgp->msgid_len = msgid_len - (separator + 1 - msgid);
+    }
+  else
+    {
+      msgp->msgctxt = NULL;
+      *msgctxt_lenp = 0;
+      msgp->msgid = msgid;
+      msgp->msgid_len = msgid_len;
+    }
+}
+
+void
+mo_file_get_message (mo_file_ty *mfp, size_t i, struct mo_message *msgp)
+{
+  size_t msgctxt_len;
 
-          for (i = 0; i < header.n_sysdep_strings; i++)
+  /* Free the strings of the previous system dependent message.  */
+  free (mfp->sysdep_msgid);
+  mfp->sysdep_msgid = NULL;
+  free (mfp->sysdep_msgstr);
+  mfp->sysdep_msgstr = NULL;
+
+  read_message (mfp, i, msgp, &msgctxt_len);
+
+  if (msgp->sysdep)
+    {
+      mfp->sysdep_msgid =
+        (char *) (msgp->msgctxt != NULL ? msgp->msgctxt : msgp->msgid);
+      mfp->sysdep_msgstr = (char *) msgp->msgstr;
+    }
+
+  /* The contents of the file are read-only.  Therefore the msgctxt is
+     copied, in order to NUL terminate it.  */
+  if (msgp->msgctxt != NULL)
+    {
+      if (mfp->msgctxt_buf_size <= msgctxt_len)
+        {
+          mfp->msgctxt_buf_size = 2 * mfp->msgctxt_buf_size + msgctxt_len + 1;
+          mfp->msgctxt_buf =
+            (char *) xrealloc (mfp->msgctxt_buf, mfp->msgctxt_buf_size);
+        }
+      memcpy (mfp->msgctxt_buf, msgp->msgctxt, msgctxt_len);
+      mfp->msgctxt_buf[msgctxt_len] = '\0';
+      msgp->msgctxt = mfp->msgctxt_buf;
+    }
+}
+
+void
+mo_file_close (mo_file_ty *mfp)
+{
+  free (mfp->sysdep_msgid);
+  free (mfp->sysdep_msgstr);
+  free (mfp->msgctxt_buf);
+#if HAVE_MMAP && HAVE_MUNMAP
+  if (mfp->bf.mapped)
+    munmap (mfp->bf.data, mfp->bf.size);
+  else
+#endif
+    free (mfp->bf.data);
+  free (mfp);
+}
+
+
+/* Only messages with c-format or objc-format annotation are recognized as
+   having system-dependent strings by msgfmt.  Which one of the two, we don't
+   know.  We have to guess, assuming that c-format is more probable than
+   objc-format and that the .mo was likely produced by "msgfmt -c".  */
+static void
+guess_sysdep_format (message_ty *mp, const struct mo_message *msgp)
+{
+  size_t f;
+
+  for (f = format_c; ; f = format_objc)
+    {
+      bool valid = true;
+      struct formatstring_parser *parser = formatstring_parsers[f];
+      const char *str_end;
+      const char *str;
+
+      str_end = msgp->msgid + msgp->msgid_len;
+      for (str = msgp->msgid; str < str_end; str += strlen (str) + 1)
+        {
+          char *invalid_reason = NULL;
+          void *descr = parser->parse (str, false, NULL, &invalid_reason);
+
+          if (descr != NULL)
+            parser->free (descr);
+          else
             {
-              message_ty *mp;
-              char *msgctxt;
-              char *msgid;
-              size_t msgid_len;
-              char *separator;
-              char *msgstr;
-              size_t msgstr_len;
-              nls_uint32 offset;
-              size_t f;
-
-              /* Read the msgctxt and msgid.  */
-              offset = get_uint32 (&bf, header.orig_sysdep_tab_offset + i * 4);
-              msgid = get_sysdep_string (&bf, offset, &header, &msgid_len);
-              /* Split into msgctxt and msgid.  */
-              separator = strchr (msgid, MSGCTXT_SEPARATOR);
-              if (separator != NULL)
-                {
-                  /* The part before the MSGCTXT_SEPARATOR is the msgctxt.  */
-                  *separator = '\0';
-                  msgctxt = msgid;
-                  msgid = separator + 1;
-                  msgid_len -= msgid - msgctxt;
-                }
+              free (invalid_reason);
+              valid = false;
+              break;
+            }
+        }
+      if (valid)
+        {
+          str_end = msgp->msgstr + msgp->msgstr_len;
+          for (str = msgp->msgstr; str < str_end; str += strlen (str) + 1)
+            {
+              char *invalid_reason = NULL;
+              void *descr = parser->parse (str, true, NULL, &invalid_reason);
+
+              if (descr != NULL)
+                parser->free (descr);
               else
-                msgctxt = NULL;
-
-              /* Read the msgstr.  */
-              offset = get_uint32 (&bf, header.trans_sysdep_tab_offset + i * 4);
-              msgstr = get_sysdep_string (&bf, offset, &header, &msgstr_len);
-
-              mp = message_alloc (msgctxt,
-                                  msgid,
-                                  (strlen (msgid) + 1 < msgid_len
-                                   ? msgid + strlen (msgid) + 1
-                                   : NULL),
-                                  msgstr, msgstr_len,
-                                  &pos);
-
-              /* Only messages with c-format or objc-format annotation are
-                 recognized as having system-dependent strings by msgfmt.
-                 Which one of the two, we don't know.  We have to guess,
-                 assuming that c-format is more probable than objc-format and
-                 that the .mo was likely produced by "msgfmt -c".  */
-              for (f = format_c; ; f = format_objc)
                 {
-                  bool valid = true;
-                  struct formatstring_parser *parser = formatstring_parsers[f];
-                  const char *str_end;
-                  const char *str;
-
-                  str_end = msgid + msgid_len;
-                  for (str = msgid; str < str_end; str += strlen (str) + 1)
-                    {
-                      char *invalid_reason = NULL;
-                      void *descr =
-                        parser->parse (str, false, NULL, &invalid_reason);
-
-                      if (descr != NULL)
-                        parser->free (descr);
-                      else
-                        {
-                          free (invalid_reason);
-                          valid = false;
-                          break;
-                        }
-                    }
-                  if (valid)
-                    {
-                      str_end = msgstr + msgstr_len;
-                      for (str = msgstr; str < str_end; str += strlen (str) + 1)
-                        {
-                          char *invalid_reason = NULL;
-                          void *descr =
-                            parser->parse (str, true, NULL, &invalid_reason);
-
-                          if (descr != NULL)
-                            parser->free (descr);
-                          else
-                            {
-                              free (invalid_reason);
-                              valid = false;
-                              break;
-                            }
-                        }
-                    }
-
-                  if (valid)
-                    {
-                      /* Found the most likely among c-format, objc-format.  */
-                      mp->is_format[f] = yes;
-                      break;
-                    }
-
-                  /* Try next f.  */
-                  if (f == format_objc)
-                    break;
+                  free (invalid_reason);
+                  valid = false;
+                  break;
                 }
-
-              message_list_append (mlp, mp);
             }
+        }
+
+      if (valid)
+        {
+          /* Found the most likely among c-format, objc-format.  */
+          mp->is_format[f] = yes;
           break;
         }
-      break;
 
-    default:
-      goto unrecognised;
+      /* Try next f.  */
+      if (f == format_objc)
+        break;
     }
+}
 
-  if (fp != stdin)
-    fclose (fp);
+/* Reads an existing .mo file and adds the messages to mlp.  */
+void
+read_mo_file (message_list_ty *mlp, const char *filename)
+{
+  mo_file_ty *mfp;
+  size_t n;
+  size_t i;
+  static lex_pos_ty pos = { __FILE__, __LINE__ };
+
+  mfp = mo_file_open (filename);
+  n = mo_file_nmessages (mfp);
+
+  for (i = 0; i < n; i++)
+    {
+      struct mo_message msg;
+      size_t msgctxt_len;
+      char *msgctxt;
+      message_ty *mp;
+
+      read_message (mfp, i, &msg, &msgctxt_len);
+
+      if (msg.msgctxt != NULL)
+        {
+          msgctxt = XNMALLOC (msgctxt_len + 1, char);
+          memcpy (msgctxt, msg.msgctxt, msgctxt_len);
+          msgctxt[msgctxt_len] = '\0';
+        }
+      else
+        msgctxt = NULL;
+
+      mp = message_alloc (msgctxt,
+                          msg.msgid,
+                          (strlen (msg.msgid) + 1 < msg.msgid_len
+                           ? msg.msgid + strlen (msg.msgid) + 1
+                           : NULL),
+                          msg.msgstr, msg.msgstr_len,
+                          &pos);
+      if (msg.sysdep)
+        guess_sysdep_format (mp, &msg);
+      message_list_append (mlp, mp);
+    }
+
+  /* The messages point into the file's contents.  Therefore MFP is not
+     closed.  */
 }
@@ -1,5 +1,5 @@
 /* Reading binary .mo files.
-   Copyright (C) 1995-1998, 2000-2004 Free Software Foundation, Inc.
+   Copyright (C) 1995-1998, 2000-2007, 2014-2015, 2017, 2020 Free Software Foundation, Inc.
    Written by Ulrich Drepper <drepper@gnu.ai.mit.edu>, April 1995.
 
    This program is free software: you can redistribute it and/or modify
@@ -18,9 +18,50 @@
 #ifndef _READ_MO_H
 #define _READ_MO_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "message.h"
 
 /* Reads an existing .mo file and adds the messages to mlp.  */
 extern void read_mo_file (message_list_ty *mlp, const char *filename);
 
+
+/* A .mo file, opened for reading its messages one at a time.  */
+typedef struct mo_file_ty mo_file_ty;
+
+/* A message of a .mo file.  */
+struct mo_message
+{
+  /* The context, or NULL.  */
+  const char *msgctxt;
+  /* The msgid, followed by the msgid_plural if the message has plural
+     forms.  Each is NUL terminated.  */
+  const char *msgid;
+  size_t msgid_len;
+  /* The translations: one NUL terminated string per plural form.  */
+  const char *msgstr;
+  size_t msgstr_len;
+  /* True if the message contains system dependent segments, such as
+     <PRId64>.  */
+  bool sysdep;
+};
+
+/* Opens the .mo file FILENAME, or standard input if FILENAME is "-", and
+   verifies its header and its hash table.  Exits with an error message if
+   it is not a valid .mo file.  */
+extern mo_file_ty *mo_file_open (const char *filename);
+
+/* Returns the number of messages in MFP.  */
+extern size_t mo_file_nmessages (const mo_file_ty *mfp);
+
+/* Stores the message number I, 0 <= I < mo_file_nmessages (MFP), in *MSGP.
+   The strings remain valid until the next call to this function with the
+   same MFP, or until MFP is closed.  */
+extern void mo_file_get_message (mo_file_ty *mfp, size_t i,
+                                 struct mo_message *msgp);
+
+/* Closes MFP.  */
+extern void mo_file_close (mo_file_ty *mfp);
+
 #endif /* _READ_MO_H */
@@ -0,0 +1,1143 @@
+/* Reading PO files into read-only memory.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* Specification.  */
+#include "read-po-readonly.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if HAVE_MMAP && HAVE_MUNMAP
+# include <sys/mman.h>
+#endif
+
+#include "c-ctype.h"
+#include "c-strstr.h"
+#include "str-list.h"
+#include "po-charset.h"
+#include "po-lex.h"
+#include "read-catalog.h"
+#include "read-po.h"
+#include "po-xerror.h"
+#include "unistr.h"
+#include "xalloc.h"
+#include "gettext.h"
+
+#define _(str) gettext (str)
+
+/* For compiling this file in C++ mode.  */
+#ifdef __cplusplus
+# define this thiss
+#endif
+
+
+/* The file's contents are scanned twice, by the same code.  The first scan
+   accepts only the common subset of the PO syntax: everything that would
+   make the PO lexer or grammar report an error or warning, or that would
+   need the lexer's knowledge of multibyte characters, makes it give up, and
+   the file is then read by the normal parser instead.  The second scan
+   decodes the strings in place and passes the comments and messages to a
+   catalog reader.  */
+
+
+/* ========================================================================= */
+/* Storage of the file's contents.  */
+
+
+/* Read the contents of the file FP into STORAGE->contents.  Return false if
+   this is not possible.  */
+static bool
+read_contents (FILE *fp, po_readonly_storage_ty *storage)
+{
+  struct stat statbuf;
+  size_t size;
+  char *data;
+
+  /* Standard input may already have been read partially.  */
+  if (fp == stdin)
+    return false;
+  if (fstat (fileno (fp), &statbuf) < 0 || !S_ISREG (statbuf.st_mode))
+    return false;
+  size = statbuf.st_size;
+  if (size == 0 || size != statbuf.st_size)
+    return false;
+
+#if HAVE_MMAP && HAVE_MUNMAP
+  /* The mapping is private, so that the strings can be decoded in place.
+     Pages that are not written to remain shared with the page cache.  */
+  data = (char *) mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                        fileno (fp), 0);
+  if (data != (char *) MAP_FAILED)
+    {
+      storage->contents = data;
+      storage->contents_size = size;
+      storage->mapped = true;
+      return true;
+    }
+#endif
+
+  data = XNMALLOC (size, char);
+  if (fread (data, 1, size, fp) != size)
+    {
+      free (data);
+      return false;
+    }
+  storage->contents = data;
+  storage->contents_size = size;
+  storage->mapped = false;
+  return true;
+}
+
+
+static void
+release_contents (po_readonly_storage_ty *storage)
+{
+  if (storage->contents != NULL)
+    {
+#if HAVE_MMAP && HAVE_MUNMAP
+      if (storage->mapped)
+        munmap (storage->contents, storage->contents_size);
+      else
+#endif
+        free (storage->contents);
+      storage->contents = NULL;
+      storage->contents_size = 0;
+    }
+}
+
+
+/* Test whether the string S is located in STORAGE->contents.  */
+static inline bool
+in_contents (const po_readonly_storage_ty *storage, const char *s)
+{
+  return (storage->contents != NULL
+          && s >= storage->contents
+          && s < storage->contents + storage->contents_size);
+}
+
+
+/* ========================================================================= */
+/* Scanning.  */
+
+
+struct scanner
+{
+  /* The unscanned part of the contents.  */
+  char *p;
+  char *end;
+  /* The current line number.  */
+  size_t line_number;
+  /* Whether the current line started with "#~" or "#|".  */
+  bool obsolete;
+  bool previous;
+  /* Whether a header entry has been seen.  */
+  bool seen_header;
+  /* False during the first scan, which only validates the contents and
+     decodes the strings into SCRATCH.  True during the second scan, which
+     decodes the strings in place and passes them to the catalog reader.  */
+  bool building;
+  char *scratch;
+  /* The number of messages seen so far.  */
+  size_t nmessages;
+  /* During the second scan: the file name attached to the messages.  */
+  char *file_name;
+};
+
+/* The tokens that the scanner distinguishes.  */
+enum token
+{
+  t_eof,
+  t_comment,
+  t_string,
+  t_msgctxt,
+  t_msgid,
+  t_msgid_plural,
+  t_msgstr,
+  t_prev_msgctxt,
+  t_prev_msgid,
+  t_prev_msgid_plural,
+  t_lbracket,
+  t_rbracket,
+  t_number,
+  t_other
+};
+
+
+static void
+scanner_init (struct scanner *s, const po_readonly_storage_ty *storage,
+              bool building)
+{
+  s->p = storage->contents;
+  s->end = storage->contents + storage->contents_size;
+  s->line_number = 1;
+  s->obsolete = false;
+  s->previous = false;
+  s->seen_header = false;
+  s->building = building;
+  s->nmessages = 0;
+}
+
+
+/* Skip whitespace and the "#~" and "#|" markers, and return the kind of the
+   next token.  For a keyword, set *ENDP to the end of the keyword.  */
+static enum token
+peek_token (struct scanner *s, char **endp)
+{
+  for (;;)
+    {
+      if (s->p == s->end)
+        return t_eof;
+      switch (*s->p)
+        {
+        case '\n':
+          s->line_number++;
+          s->obsolete = false;
+          s->previous = false;
+          s->p++;
+          break;
+
+        case ' ': case '\t': case '\r': case '\f': case '\v':
+          s->p++;
+          break;
+
+        case '#':
+          if (s->p + 1 < s->end && s->p[1] == '~')
+            {
+              s->obsolete = true;
+              s->p += 2;
+              if (s->p < s->end && *s->p == '|')
+                {
+                  s->previous = true;
+                  s->p++;
+                }
+              break;
+            }
+          if (s->p + 1 < s->end && s->p[1] == '|')
+            {
+              s->previous = true;
+              s->p += 2;
+              break;
+            }
+          return t_comment;
+
+        case '"':
+          return t_string;
+
+        case '[':
+          return t_lbracket;
+
+        case ']':
+          return t_rbracket;
+
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+          return t_number;
+
+        default:
+          if (c_isalpha (*s->p) || *s->p == '_' || *s->p == '$')
+            {
+              char *q = s->p;
+              size_t len;
+
+              do
+                q++;
+              while (q < s->end
+                     && (c_isalnum (*q) || *q == '_' || *q == '$'));
+              *endp = q;
+              len = q - s->p;
+
+              if (len == 5 && memcmp (s->p, "msgid", 5) == 0)
+                return (s->previous ? t_prev_msgid : t_msgid);
+              if (len == 12 && memcmp (s->p, "msgid_plural", 12) == 0)
+                return (s->previous ? t_prev_msgid_plural : t_msgid_plural);
+              if (len == 7 && memcmp (s->p, "msgctxt", 7) == 0)
+                return (s->previous ? t_prev_msgctxt : t_msgctxt);
+              if (len == 6 && memcmp (s->p, "msgstr", 6) == 0
+                  && !s->previous)
+                return t_msgstr;
+            }
+          /* This includes 'domain' directives.  */
+          return t_other;
+        }
+    }
+}
+
+
+/* Consume the comment at the current position.  */
+static bool
+scan_comment (struct scanner *s)
+{
+  char *text = s->p + 1;
+  char *newline = (char *) memchr (text, '\n', s->end - text);
+
+  /* Give up on a comment that is continued through a backslash-newline,
+     and on a comment at the end of the file, which cannot be terminated in
+     place.  */
+  if (newline == NULL || (newline > text && newline[-1] == '\\'))
+    return false;
+
+  if (s->building)
+    {
+      *newline = '\0';
+      po_callback_comment_dispatcher (text);
+    }
+
+  s->p = newline + 1;
+  s->line_number++;
+  return true;
+}
+
+
+/* Return the place where the list of strings that starts at the current
+   position is to be decoded.  */
+static inline char *
+string_dest (const struct scanner *s)
+{
+  return (s->building ? s->p + 1 : s->scratch);
+}
+
+
+/* Decode the string at the current position, appending its contents at
+   *DESTP, which must not be after the current position.  */
+static bool
+scan_string (struct scanner *s, char **destp)
+{
+  char *dest = *destp;
+  char *q = s->p + 1;
+
+  for (;;)
+    {
+      char c;
+
+      if (q == s->end)
+        /* End-of-file within string.  */
+        return false;
+      c = *q;
+      if (c == '"')
+        break;
+      if (c == '\\')
+        {
+          int value;
+
+          if (++q == s->end)
+            return false;
+          switch (*q)
+            {
+            case 'n': value = '\n'; q++; break;
+            case 't': value = '\t'; q++; break;
+            case 'b': value = '\b'; q++; break;
+            case 'r': value = '\r'; q++; break;
+            case 'f': value = '\f'; q++; break;
+            case 'v': value = '\v'; q++; break;
+            case 'a': value = '\a'; q++; break;
+            case '\\': case '"': value = *q; q++; break;
+
+            case '0': case '1': case '2': case '3':
+            case '4': case '5': case '6': case '7':
+              {
+                int max = 0;
+
+                value = 0;
+                do
+                  value = value * 8 + (*q++ - '0');
+                while (++max < 3 && q < s->end && *q >= '0' && *q <= '7');
+              }
+              break;
+
+            case 'x':
+              {
+                int max = 0;
+
+                q++;
+                if (q == s->end || !c_isxdigit (*q))
+                  return false;
+                value = 0;
+                do
+                  {
+                    value = value * 16
+                            + (c_isdigit (*q) ? *q - '0'
+                               : c_toupper (*q) - 'A' + 10);
+                    q++;
+                  }
+                while (++max < 2 && q < s->end && c_isxdigit (*q));
+                /* Longer hexadecimal escapes are left to the lexer.  */
+                if (q < s->end && c_isxdigit (*q))
+                  return false;
+              }
+              break;
+
+            default:
+              /* Invalid control sequence, or backslash-newline.  */
+              return false;
+            }
+          c = (char) value;
+        }
+      else if (c == '\n')
+        /* End-of-line within string.  */
+        return false;
+      else
+        q++;
+
+      /* The lexer truncates strings at a NUL byte, and strings cannot
+         contain the msgctxt separator.  */
+      if (c == '\0' || c == MSGCTXT_SEPARATOR)
+        return false;
+      if (dest == q - 1)
+        dest++;
+      else
+        *dest++ = c;
+    }
+
+  s->p = q + 1;
+  *destp = dest;
+  return true;
+}
+
+
+/* Decode the list of strings that starts at the current position, and store
+   its NUL-terminated concatenation at DEST.  Set *ENDP to the position of the
+   terminating NUL.  */
+static bool
+scan_string_list (struct scanner *s, char *dest, char **endp)
+{
+  bool obsolete = s->obsolete;
+  bool previous = s->previous;
+  char *unused;
+
+  do
+    {
+      if (s->obsolete != obsolete || s->previous != previous)
+        return false;
+      if (!scan_string (s, &dest))
+        return false;
+    }
+  while (peek_token (s, &unused) == t_string);
+
+  *dest = '\0';
+  *endp = dest;
+  return true;
+}
+
+
+/* Consume a token of kind EXPECTED, which must belong to a message whose
+   obsolete flag is OBSOLETE, and return the line on which it is located.  */
+static bool
+scan_token (struct scanner *s, enum token expected, bool obsolete,
+            size_t *linep)
+{
+  char *end;
+
+  if (peek_token (s, &end) != expected || s->obsolete != obsolete)
+    return false;
+  if (linep != NULL)
+    *linep = s->line_number;
+  switch (expected)
+    {
+    case t_lbracket:
+    case t_rbracket:
+      s->p++;
+      break;
+    default:
+      s->p = end;
+      break;
+    }
+  return true;
+}
+
+
+/* Consume a keyword of kind EXPECTED, followed by a list of strings.  */
+static bool
+scan_keyword_string (struct scanner *s, enum token expected, bool obsolete,
+                     size_t *linep, char **resultp, char **endp)
+{
+  char *unused;
+
+  if (!scan_token (s, expected, obsolete, linep))
+    return false;
+  if (peek_token (s, &unused) != t_string)
+    return false;
+  *resultp = string_dest (s);
+  return scan_string_list (s, *resultp, endp);
+}
+
+
+/* Check that the bytes after the header entry are valid in its encoding,
+   as the lexer would do.  */
+static bool
+check_charset (struct scanner *s, const char *header)
+{
+  const char *charsetstr = c_strstr (header, "charset=");
+
+  if (charsetstr != NULL)
+    {
+      size_t len;
+      char *charset;
+      const char *canon_charset;
+
+      charsetstr += strlen ("charset=");
+      len = strcspn (charsetstr, " \t\n");
+      charset = XNMALLOC (len + 1, char);
+      memcpy (charset, charsetstr, len);
+      charset[len] = '\0';
+      canon_charset = po_charset_canonicalize (charset);
+      free (charset);
+
+      /* Without a valid charset, the lexer doesn't look at multibyte
+         characters.  */
+      if (canon_charset != NULL)
+        {
+          if (canon_charset == po_charset_utf8)
+            return u8_check ((const uint8_t *) s->p, s->end - s->p) == NULL;
+          else
+            {
+              /* Accept other encodings only for ASCII contents.  */
+              const char *q;
+
+              for (q = s->p; q < s->end; q++)
+                if ((unsigned char) *q >= 0x80)
+                  return false;
+            }
+        }
+    }
+  return true;
+}
+
+
+/* Scan a message, starting at the token T.  */
+static bool
+scan_message (struct scanner *s, enum token t)
+{
+  bool obsolete = s->obsolete;
+  char *msgctxt = NULL;
+  char *msgid;
+  char *msgid_end;
+  size_t msgid_line;
+  char *msgid_plural = NULL;
+  char *msgstr;
+  char *msgstr_end;
+  size_t msgstr_line = 0;
+  char *prev_msgctxt = NULL;
+  char *prev_msgid = NULL;
+  char *prev_msgid_plural = NULL;
+  bool header;
+  char *unused;
+
+  if (t == t_prev_msgctxt || t == t_prev_msgid)
+    {
+      if (t == t_prev_msgctxt
+          && !scan_keyword_string (s, t_prev_msgctxt, obsolete, NULL,
+                                   &prev_msgctxt, &unused))
+        return false;
+      if (!scan_keyword_string (s, t_prev_msgid, obsolete, NULL,
+                                &prev_msgid, &unused))
+        return false;
+      if (peek_token (s, &unused) == t_prev_msgid_plural
+          && !scan_keyword_string (s, t_prev_msgid_plural, obsolete, NULL,
+                                   &prev_msgid_plural, &unused))
+        return false;
+      t = peek_token (s, &unused);
+    }
+
+  if (t == t_msgctxt
+      && !scan_keyword_string (s, t_msgctxt, obsolete, NULL,
+                               &msgctxt, &unused))
+    return false;
+  if (!scan_keyword_string (s, t_msgid, obsolete, &msgid_line,
+                            &msgid, &msgid_end))
+    return false;
+  /* Test for header entry now: in the first scan, the msgid is overwritten
+     by the following strings.  */
+  header = (msgctxt == NULL && msgid_end == msgid && !obsolete);
+
+  t = peek_token (s, &unused);
+  if (t == t_msgstr)
+    {
+      if (!scan_keyword_string (s, t_msgstr, obsolete, &msgstr_line,
+                                &msgstr, &msgstr_end))
+        return false;
+    }
+  else if (t == t_msgid_plural)
+    {
+      unsigned long plural_counter = 0;
+
+      if (!scan_keyword_string (s, t_msgid_plural, obsolete, NULL,
+                                &msgid_plural, &unused))
+        return false;
+
+      /* Concatenate the plural forms, separated by NULs.  */
+      msgstr = msgstr_end = NULL;
+      do
+        {
+          unsigned long index;
+          size_t line;
+
+          if (!scan_token (s, t_msgstr, obsolete, &line)
+              || !scan_token (s, t_lbracket, obsolete, NULL)
+              || peek_token (s, &unused) != t_number
+              || s->obsolete != obsolete)
+            return false;
+          for (index = 0; s->p < s->end && c_isdigit (*s->p); s->p++)
+            {
+              if (index >= 1000)
+                return false;
+              index = index * 10 + (*s->p - '0');
+            }
+          if (index != plural_counter
+              || !scan_token (s, t_rbracket, obsolete, NULL)
+              || peek_token (s, &unused) != t_string)
+            return false;
+          if (plural_counter == 0)
+            {
+              msgstr = string_dest (s);
+              msgstr_end = msgstr - 1;
+              msgstr_line = line;
+            }
+          if (!scan_string_list (s, msgstr_end + 1, &msgstr_end))
+            return false;
+          plural_counter++;
+        }
+      while (peek_token (s, &unused) == t_msgstr);
+    }
+  else
+    return false;
+
+  if (header)
+    {
+      /* The lexer switches to the header entry's encoding from here on.
+         A second header entry would be a duplicate.  */
+      if (s->seen_header)
+        return false;
+      s->seen_header = true;
+      if (s->building)
+        po_lex_charset_set (msgstr, s->file_name);
+      else if (!check_charset (s, msgstr))
+        return false;
+    }
+
+  s->nmessages++;
+  if (s->building && (!obsolete || pass_obsolete_entries))
+    {
+      lex_pos_ty msgid_pos;
+      lex_pos_ty msgstr_pos;
+
+      msgid_pos.file_name = s->file_name;
+      msgid_pos.line_number = msgid_line;
+      msgstr_pos.file_name = s->file_name;
+      msgstr_pos.line_number = msgstr_line;
+      po_callback_message (msgctxt, msgid, &msgid_pos, msgid_plural,
+                           msgstr, msgstr_end - msgstr + 1, &msgstr_pos,
+                           prev_msgctxt, prev_msgid, prev_msgid_plural,
+                           false, obsolete);
+    }
+  return true;
+}
+
+
+/* Scan the entire contents.  */
+static bool
+scan_contents (struct scanner *s)
+{
+  for (;;)
+    {
+      char *unused;
+      enum token t = peek_token (s, &unused);
+
+      switch (t)
+        {
+        case t_eof:
+          return true;
+
+        case t_comment:
+          if (s->obsolete || s->previous || !scan_comment (s))
+            return false;
+          break;
+
+        case t_msgctxt:
+        case t_msgid:
+        case t_prev_msgctxt:
+        case t_prev_msgid:
+          if (!scan_message (s, t))
+            return false;
+          break;
+
+        default:
+          return false;
+        }
+    }
+}
+
+
+/* ========================================================================= */
+/* Building the messages.  */
+
+
+/* The following pair of structures cooperate to create a derived class from
+   class default_catalog_reader_ty.  Its messages are allocated from a table,
+   and its strings and comments are not copied.  */
+
+typedef struct readonly_catalog_reader_ty readonly_catalog_reader_ty;
+struct readonly_catalog_reader_ty
+{
+  /* Inherited instance variables and methods.  */
+  DEFAULT_CATALOG_READER_TY
+
+  /* The storage and the table from which the messages are allocated.  */
+  po_readonly_storage_ty *storage;
+  message_ty *table;
+  size_t table_used;
+};
+
+
+/* Append S, without copying it, to the list *SLPP.  */
+static void
+append_comment (string_list_ty **slpp, const char *s)
+{
+  string_list_ty *slp = *slpp;
+
+  if (slp == NULL)
+    *slpp = slp = string_list_alloc ();
+  if (slp->nitems >= slp->nitems_max)
+    {
+      slp->nitems_max = slp->nitems_max * 2 + 4;
+      slp->item = (const char **)
+        xrealloc (slp->item, slp->nitems_max * sizeof (slp->item[0]));
+    }
+  slp->item[slp->nitems++] = s;
+}
+
+
+/* Move the comments from the list *FROMP to the list *TOP.  */
+static void
+move_comments (string_list_ty **top, string_list_ty **fromp)
+{
+  string_list_ty *from = *fromp;
+
+  if (from != NULL)
+    {
+      if (*top == NULL)
+        *top = from;
+      else
+        {
+          size_t j;
+
+          for (j = 0; j < from->nitems; j++)
+            append_comment (top, from->item[j]);
+          free (from->item);
+          free (from);
+        }
+      *fromp = NULL;
+    }
+}
+
+
+static void
+readonly_destructor (abstract_catalog_reader_ty *that)
+{
+  readonly_catalog_reader_ty *this = (readonly_catalog_reader_ty *) that;
+  string_list_ty *unused = NULL;
+
+  /* Drop the comments after the last message, without freeing them.  */
+  move_comments (&unused, &this->comment);
+  move_comments (&unused, &this->comment_dot);
+  if (unused != NULL)
+    {
+      free (unused->item);
+      free (unused);
+    }
+
+  default_destructor (that);
+}
+
+
+static void
+readonly_comment (abstract_catalog_reader_ty *that, const char *s)
+{
+  readonly_catalog_reader_ty *this = (readonly_catalog_reader_ty *) that;
+
+  if (this->handle_comments)
+    append_comment (&this->comment, s);
+}
+
+
+static void
+readonly_comment_dot (abstract_catalog_reader_ty *that, const char *s)
+{
+  readonly_catalog_reader_ty *this = (readonly_catalog_reader_ty *) that;
+
+  if (this->handle_comments)
+    append_comment (&this->comment_dot, s);
+}
+
+
+/* Add the accumulated comments to the message.  Like
+   default_copy_comment_state, except that the comments are moved.  */
+static void
+readonly_copy_comment_state (readonly_catalog_reader_ty *this, message_ty *mp)
+{
+  size_t j, i;
+
+  if (this->handle_comments)
+    {
+      move_comments (&mp->comment, &this->comment);
+      move_comments (&mp->comment_dot, &this->comment_dot);
+    }
+  for (j = 0; j < this->filepos_count; ++j)
+    {
+      lex_pos_ty *pp;
+
+      pp = &this->filepos[j];
+      message_comment_filepos (mp, pp->file_name, pp->line_number);
+    }
+  mp->is_fuzzy = this->is_fuzzy;
+  for (i = 0; i < NFORMATS; i++)
+    mp->is_format[i] = this->is_format[i];
+  mp->range = this->range;
+  mp->do_wrap = this->do_wrap;
+  for (i = 0; i < NSYNTAXCHECKS; i++)
+    mp->do_syntax_check[i] = this->do_syntax_check[i];
+}
+
+
+/* Like default_add_message, except that the strings are not copied and
+   not freed, and that the message is allocated from the table.  */
+static void
+readonly_add_message (default_catalog_reader_ty *that,
+                      char *msgctxt,
+                      char *msgid,
+                      lex_pos_ty *msgid_pos,
+                      char *msgid_plural,
+                      char *msgstr, size_t msgstr_len,
+                      lex_pos_ty *msgstr_pos,
+                      char *prev_msgctxt,
+                      char *prev_msgid,
+                      char *prev_msgid_plural,
+                      bool force_fuzzy, bool obsolete)
+{
+  readonly_catalog_reader_ty *this = (readonly_catalog_reader_ty *) that;
+  message_ty *mp;
+
+  if (this->mdlp != NULL)
+    /* Select the appropriate sublist of this->mdlp.  */
+    this->mlp = msgdomain_list_sublist (this->mdlp, this->domain, true);
+
+  if (this->allow_duplicates && msgid[0] != '\0')
+    /* Doesn't matter if this message ID has been seen before.  */
+    mp = NULL;
+  else
+    /* See if this message ID has been seen before.  */
+    mp = message_list_search (this->mlp, msgctxt, msgid);
+
+  if (mp)
+    {
+      if (!(this->allow_duplicates_if_same_msgstr
+            && msgstr_len == mp->msgstr_len
+            && memcmp (msgstr, mp->msgstr, msgstr_len) == 0))
+        po_xerror2 (PO_SEVERITY_ERROR,
+                    NULL, msgid_pos->file_name, msgid_pos->line_number,
+                    (size_t)(-1), false, _("duplicate message definition"),
+                    mp, NULL, 0, 0, false,
+                    _("this is the location of the first definition"));
+
+      /* Add the accumulated comments to the message.  */
+      readonly_copy_comment_state (this, mp);
+    }
+  else
+    {
+      size_t i;
+
+      /* Construct message to add to the list, like message_alloc does.  */
+      mp = &this->table[this->table_used++];
+      mp->msgctxt = msgctxt;
+      mp->msgid = msgid;
+      mp->msgid_plural = msgid_plural;
+      mp->msgstr = msgstr;
+      mp->msgstr_len = msgstr_len;
+      mp->pos = *msgstr_pos;
+      mp->comment = NULL;
+      mp->comment_dot = NULL;
+      mp->filepos_count = 0;
+      mp->filepos = NULL;
+      mp->is_fuzzy = false;
+      for (i = 0; i < NFORMATS; i++)
+        mp->is_format[i] = undecided;
+      mp->range.min = -1;
+      mp->range.max = -1;
+      mp->do_wrap = undecided;
+      for (i = 0; i < NSYNTAXCHECKS; i++)
+        mp->do_syntax_check[i] = undecided;
+      mp->prev_msgctxt = prev_msgctxt;
+      mp->prev_msgid = prev_msgid;
+      mp->prev_msgid_plural = prev_msgid_plural;
+      mp->used = 0;
+      mp->obsolete = obsolete;
+      mp->readonly_storage = this->storage;
+      readonly_copy_comment_state (this, mp);
+      if (force_fuzzy)
+        mp->is_fuzzy = true;
+
+      message_list_append (this->mlp, mp);
+    }
+}
+
+
+static default_catalog_reader_class_ty readonly_methods =
+{
+  {
+    sizeof (readonly_catalog_reader_ty),
+    default_constructor,
+    readonly_destructor,
+    default_parse_brief,
+    default_parse_debrief,
+    default_directive_domain,
+    default_directive_message,
+    readonly_comment,
+    readonly_comment_dot,
+    default_comment_filepos,
+    default_comment_special
+  },
+  default_set_domain, /* set_domain */
+  readonly_add_message, /* add_message */
+  NULL /* frob_new_message */
+};
+
+
+/* The scanner that has validated the contents.  */
+static struct scanner *validated_scanner;
+
+/* Pass the comments and messages to the catalog reader, like po_gram_parse
+   does.  */
+static void
+readonly_parse (abstract_catalog_reader_ty *this, FILE *fp,
+                const char *real_filename, const char *logical_filename)
+{
+  struct scanner *s = validated_scanner;
+
+  /* Like lex_start, attach a copy of the file name to the messages.  */
+  s->file_name = xstrdup (real_filename);
+  po_lex_charset_init ();
+  scan_contents (s);
+  po_lex_charset_close ();
+}
+
+static const struct catalog_input_format input_format_po_readonly =
+{
+  readonly_parse,                       /* parse */
+  false                                 /* produces_utf8 */
+};
+
+
+/* ========================================================================= */
+/* Exported functions.  */
+
+
+msgdomain_list_ty *
+read_po_stream_readonly (FILE *fp, const char *real_filename,
+                         const char *logical_filename,
+                         po_readonly_storage_ty **storagep)
+{
+  po_readonly_storage_ty *storage = XMALLOC (po_readonly_storage_ty);
+
+  if (read_contents (fp, storage))
+    {
+      struct scanner s;
+      bool valid;
+
+      /* The scratch buffer is large enough for any string list.  Only the
+         pages that are actually used get allocated by the system.  */
+      scanner_init (&s, storage, false);
+      s.scratch = XNMALLOC (storage->contents_size + 1, char);
+      valid = scan_contents (&s);
+      free (s.scratch);
+
+      if (valid)
+        {
+          readonly_catalog_reader_ty *pop;
+          msgdomain_list_ty *mdlp;
+
+          storage->table = XNMALLOC (s.nmessages, message_ty);
+          storage->table_size = s.nmessages;
+
+          pop = (readonly_catalog_reader_ty *)
+            default_catalog_reader_alloc (&readonly_methods);
+          pop->handle_comments = true;
+          pop->allow_domain_directives = true;
+          pop->allow_duplicates = allow_duplicates;
+          pop->allow_duplicates_if_same_msgstr = false;
+          pop->file_name = real_filename;
+          pop->mdlp = msgdomain_list_alloc (!pop->allow_duplicates);
+          pop->mlp = msgdomain_list_sublist (pop->mdlp, pop->domain, true);
+          pop->storage = storage;
+          pop->table = storage->table;
+          pop->table_used = 0;
+          po_lex_pass_obsolete_entries (true);
+          scanner_init (&s, storage, true);
+          validated_scanner = &s;
+          catalog_reader_parse ((abstract_catalog_reader_ty *) pop, fp,
+                                real_filename, logical_filename,
+                                &input_format_po_readonly);
+          validated_scanner = NULL;
+          mdlp = pop->mdlp;
+          catalog_reader_free ((abstract_catalog_reader_ty *) pop);
+
+          storage->mdlp = mdlp;
+          *storagep = storage;
+          return mdlp;
+        }
+
+      /* Fall back to the normal parser, which reads the file through FP.  */
+      release_contents (storage);
+      rewind (fp);
+    }
+
+  free (storage);
+  *storagep = NULL;
+  return read_catalog_stream (fp, real_filename, logical_filename,
+                              &input_format_po);
+}
+
+
+void
+readonly_storage_unshare (po_readonly_storage_ty *storage, bool keep_contents)
+{
+  msgdomain_list_ty *mdlp = storage->mdlp;
+  size_t k, j, i;
+
+  if (storage->contents == NULL)
+    return;
+
+  for (k = 0; k < mdlp->nitems; k++)
+    {
+      message_list_ty *mlp = mdlp->item[k]->messages;
+
+      for (j = 0; j < mlp->nitems; j++)
+        {
+          message_ty *mp = mlp->item[j];
+
+#define UNSHARE(field) \
+          if (mp->field != NULL && in_contents (storage, mp->field)) \
+            mp->field = xstrdup (mp->field);
+          UNSHARE (msgctxt)
+          UNSHARE (msgid)
+          UNSHARE (msgid_plural)
+          UNSHARE (prev_msgctxt)
+          UNSHARE (prev_msgid)
+          UNSHARE (prev_msgid_plural)
+#undef UNSHARE
+          if (in_contents (storage, mp->msgstr))
+            mp->msgstr = (const char *) xmemdup (mp->msgstr, mp->msgstr_len);
+          if (mp->comment != NULL)
+            for (i = 0; i < mp->comment->nitems; i++)
+              if (in_contents (storage, mp->comment->item[i]))
+                mp->comment->item[i] = xstrdup (mp->comment->item[i]);
+          if (mp->comment_dot != NULL)
+            for (i = 0; i < mp->comment_dot->nitems; i++)
+              if (in_contents (storage, mp->comment_dot->item[i]))
+                mp->comment_dot->item[i] = xstrdup (mp->comment_dot->item[i]);
+          mp->readonly_storage = NULL;
+        }
+    }
+
+  if (!keep_contents)
+    release_contents (storage);
+}
+
+
+/* Test whether the message MP was allocated from STORAGE.  */
+static bool
+readonly_storage_owns (const po_readonly_storage_ty *storage,
+                       const message_ty *mp)
+{
+  return (mp >= storage->table && mp < storage->table + storage->table_size);
+}
+
+
+/* Free a list of comments, except for those located in STORAGE.  */
+static void
+readonly_string_list_free (string_list_ty *slp,
+                           const po_readonly_storage_ty *storage)
+{
+  size_t j;
+
+  for (j = 0; j < slp->nitems; ++j)
+    if (!in_contents (storage, slp->item[j]))
+      free ((char *) slp->item[j]);
+  if (slp->item != NULL)
+    free (slp->item);
+  free (slp);
+}
+
+
+/* Like message_free, except that the strings located in STORAGE and the
+   messages allocated from its table are not freed.  */
+static void
+readonly_message_free (message_ty *mp, const po_readonly_storage_ty *storage)
+{
+  size_t j;
+
+#define FREE_UNLESS_SHARED(s) \
+  if ((s) != NULL && !in_contents (storage, (s))) \
+    free ((char *) (s));
+  FREE_UNLESS_SHARED (mp->msgid)
+  FREE_UNLESS_SHARED (mp->msgid_plural)
+  FREE_UNLESS_SHARED (mp->msgstr)
+  if (mp->comment != NULL)
+    readonly_string_list_free (mp->comment, storage);
+  if (mp->comment_dot != NULL)
+    readonly_string_list_free (mp->comment_dot, storage);
+  for (j = 0; j < mp->filepos_count; ++j)
+    free ((char *) mp->filepos[j].file_name);
+  if (mp->filepos != NULL)
+    free (mp->filepos);
+  FREE_UNLESS_SHARED (mp->prev_msgctxt)
+  FREE_UNLESS_SHARED (mp->prev_msgid)
+  FREE_UNLESS_SHARED (mp->prev_msgid_plural)
+#undef FREE_UNLESS_SHARED
+  if (!readonly_storage_owns (storage, mp))
+    free (mp);
+}
+
+
+void
+readonly_msgdomain_list_free (msgdomain_list_ty *mdlp,
+                              po_readonly_storage_ty *storage)
+{
+  size_t k, j;
+
+  for (k = 0; k < mdlp->nitems; k++)
+    {
+      msgdomain_ty *mdp = mdlp->item[k];
+
+      for (j = 0; j < mdp->messages->nitems; j++)
+        readonly_message_free (mdp->messages->item[j], storage);
+      message_list_free (mdp->messages, 1);
+      free (mdp);
+    }
+  if (mdlp->item)
+    free (mdlp->item);
+  free (mdlp);
+
+  release_contents (storage);
+  free (storage->table);
+  free (storage);
+}
@@ -0,0 +1,87 @@
+/* Reading PO files into read-only memory.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef _READ_PO_READONLY_H
+#define _READ_PO_READONLY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "message.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* The memory shared by the messages of a list returned by
+   read_po_stream_readonly.  */
+typedef struct po_readonly_storage_ty po_readonly_storage_ty;
+struct po_readonly_storage_ty
+{
+  /* A private copy of the file's contents, in which the strings have been
+     decoded in place.  NULL after readonly_storage_unshare.  */
+  char *contents;
+  size_t contents_size;
+  /* True if CONTENTS was obtained through mmap().  */
+  bool mapped;
+
+  /* The array from which the messages have been allocated.  */
+  message_ty *table;
+  size_t table_size;
+
+  /* The list of messages returned by read_po_stream_readonly.  */
+  msgdomain_list_ty *mdlp;
+};
+
+/* Read a PO file from FP, which has just been opened.  Returns a list of
+   messages whose strings and comments point into a private copy of the file's
+   contents, and sets *STORAGEP to the storage shared by these messages.
+   If the file cannot be read this way (for example, because it is not a
+   regular file or because it contains syntax errors), reads it through
+   read_catalog_stream instead and sets *STORAGEP to NULL.
+   Each message that is allocated from the storage points to it through its
+   readonly_storage field.  */
+extern msgdomain_list_ty *
+       read_po_stream_readonly (FILE *fp, const char *real_filename,
+                                const char *logical_filename,
+                                po_readonly_storage_ty **storagep);
+
+/* Give the messages of the list that was read into STORAGE their own copies
+   of the strings that are located in STORAGE, so that they can be modified
+   and freed individually, and reset their readonly_storage field.  The
+   messages keep their addresses.  If KEEP_CONTENTS is true, the file's
+   contents remain allocated until readonly_msgdomain_list_free, so that
+   pointers into them stay valid; otherwise they are released.  */
+extern void
+       readonly_storage_unshare (po_readonly_storage_ty *storage,
+                                 bool keep_contents);
+
+/* Free MDLP, which was returned by read_po_stream_readonly, together with
+   its STORAGE.  */
+extern void
+       readonly_msgdomain_list_free (msgdomain_list_ty *mdlp,
+                                     po_readonly_storage_ty *storage);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* _READ_PO_READONLY_H */
@@ -24,8 +24,10 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "msgunfmt.h"
 #include "relocatable.h"
@@ -36,16 +38,291 @@
 #include "read-po.h"
 #include "message.h"
 #include "concat-filename.h"
+#include "clean-temp.h"
 #include "error.h"
+#include "binary-io.h"
+#include "read-file.h"
+#include "unistr.h"
+#include "xalloc.h"
 #include "gettext.h"
 
 #define _(str) gettext (str)
 
 
-/* A .resources file has such a complex format that it's most easily read
-   through the C# class ResourceReader.  So we start a C# process to execute
-   the DumpResource program, and read its output, which is .po format without
-   comments.  */
+/* The .resources format is the one of the System.Resources.ResourceReader
+   class, versions 1 and 2; see write-resources.c for a description.  We read
+   files that contain only string values directly.  For other files, we start
+   a C# process to execute the DumpResource program, and read its output,
+   which is .po format without comments.  */
+
+/* A .resources file in memory.  */
+struct resources_file
+{
+  const unsigned char *data;
+  size_t size;
+};
+
+/* Read a 32-bit little-endian integer at *POSP.  */
+static bool
+get_u32 (const struct resources_file *rf, size_t *posp, unsigned int *valuep)
+{
+  const unsigned char *p;
+
+  if (*posp > rf->size || rf->size - *posp < 4)
+    return false;
+  p = rf->data + *posp;
+  *valuep = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+  *posp += 4;
+  return true;
+}
+
+/* Read an integer in 7-bit encoding at *POSP.  */
+static bool
+get_7bit (const struct resources_file *rf, size_t *posp, unsigned int *valuep)
+{
+  unsigned int value = 0;
+  unsigned int shift;
+
+  for (shift = 0; shift < 35; shift += 7)
+    {
+      unsigned int c;
+
+      if (*posp >= rf->size)
+        return false;
+      c = rf->data[(*posp)++];
+      value |= (c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        {
+          *valuep = value;
+          return true;
+        }
+    }
+  return false;
+}
+
+/* Read a string, preceded by its length in bytes, at *POSP.  */
+static bool
+get_string (const struct resources_file *rf, size_t *posp,
+            const unsigned char **strp, size_t *lenp)
+{
+  unsigned int len;
+
+  if (!get_7bit (rf, posp, &len)
+      || *posp > rf->size || rf->size - *posp < len)
+    return false;
+  *strp = rf->data + *posp;
+  *lenp = len;
+  *posp += len;
+  return true;
+}
+
+/* Convert a string of N UTF-16 units in little-endian byte order to UTF-8.
+   Return NULL if it contains a NUL character or an unpaired surrogate.  */
+static char *
+utf16le_to_utf8 (const unsigned char *str, size_t n)
+{
+  /* Each unit becomes at most 3 bytes.  */
+  char *result = XNMALLOC (3 * n + 1, char);
+  char *q = result;
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+      ucs4_t uc = str[2 * i] | (str[2 * i + 1] << 8);
+
+      if (uc == 0 || (uc >= 0xdc00 && uc < 0xe000))
+        goto fail;
+      if (uc >= 0xd800 && uc < 0xdc00)
+        {
+          ucs4_t uc2;
+
+          if (i + 1 == n)
+            goto fail;
+          i++;
+          uc2 = str[2 * i] | (str[2 * i + 1] << 8);
+          if (!(uc2 >= 0xdc00 && uc2 < 0xe000))
+            goto fail;
+          uc = 0x10000 + ((uc - 0xd800) << 10) + (uc2 - 0xdc00);
+        }
+      q += u8_uctomb ((uint8_t *) q, uc, 6);
+    }
+  *q = '\0';
+  return result;
+
+ fail:
+  free (result);
+  return NULL;
+}
+
+/* Test whether the type name STR designates System.String.  */
+static bool
+is_string_type (const unsigned char *str, size_t len)
+{
+  return (len == 13 || (len > 13 && str[13] == ','))
+         && memcmp (str, "System.String", 13) == 0;
+}
+
+/* Read the string value at position POS.  Return it in UTF-8, or NULL if
+   it is not a string.  */
+static char *
+get_value (const struct resources_file *rf, size_t pos, unsigned int version,
+           const unsigned char **types, const size_t *type_lengths,
+           unsigned int ntypes)
+{
+  unsigned int type;
+  const unsigned char *str;
+  size_t len;
+  char *result;
+
+  if (!get_7bit (rf, &pos, &type))
+    return NULL;
+  if (version == 1 || type >= 0x40)
+    {
+      /* An index into the type table.  */
+      if (version != 1)
+        type -= 0x40;
+      if (!(type < ntypes && is_string_type (types[type], type_lengths[type])))
+        return NULL;
+    }
+  else if (type != 1)
+    /* Not a string.  */
+    return NULL;
+  if (!get_string (rf, &pos, &str, &len)
+      || u8_check (str, len) != NULL
+      || memchr (str, '\0', len) != NULL)
+    return NULL;
+  result = XNMALLOC (len + 1, char);
+  memcpy (result, str, len);
+  result[len] = '\0';
+  return result;
+}
+
+/* Read the messages of the .resources file RF into MLP.  Return false if
+   the file is not in the expected format or contains other values than
+   strings.  */
+static bool
+parse_resources_file (const struct resources_file *rf, message_list_ty *mlp)
+{
+  static lex_pos_ty pos = { __FILE__, __LINE__ };
+  size_t p = 0;
+  unsigned int magic;
+  unsigned int header_version;
+  unsigned int header_size;
+  unsigned int version;
+  unsigned int nresources;
+  unsigned int ntypes;
+  const unsigned char **types;
+  size_t *type_lengths;
+  size_t positions_start;
+  unsigned int data_start;
+  size_t names_start;
+  unsigned int i;
+  bool ok = false;
+
+  /* The ResourceManager header.  */
+  if (!get_u32 (rf, &p, &magic) || magic != 0xbeefcace
+      || !get_u32 (rf, &p, &header_version)
+      || !get_u32 (rf, &p, &header_size))
+    return false;
+  if (header_version == 1)
+    {
+      /* Only the standard reader class knows this format.  */
+      const unsigned char *reader_type;
+      size_t reader_type_len;
+      size_t q = p;
+
+      if (!get_string (rf, &q, &reader_type, &reader_type_len)
+          || !(reader_type_len >= 31
+               && memcmp (reader_type, "System.Resources.ResourceReader", 31)
+                  == 0))
+        return false;
+    }
+  if (rf->size - p < header_size)
+    return false;
+  p += header_size;
+
+  /* The RuntimeResourceSet header.  */
+  if (!get_u32 (rf, &p, &version) || !(version == 1 || version == 2)
+      || !get_u32 (rf, &p, &nresources)
+      || !get_u32 (rf, &p, &ntypes)
+      || nresources > rf->size / 8 || ntypes > rf->size)
+    return false;
+  types = XNMALLOC (ntypes, const unsigned char *);
+  type_lengths = XNMALLOC (ntypes, size_t);
+  for (i = 0; i < ntypes; i++)
+    if (!get_string (rf, &p, &types[i], &type_lengths[i]))
+      goto done;
+  /* Skip the padding.  */
+  p = (p + 7) & ~(size_t) 7;
+
+  /* Skip the hash codes, which are only needed for lookup.  */
+  if (p > rf->size || (rf->size - p) / 8 < nresources)
+    goto done;
+  positions_start = p + 4 * (size_t) nresources;
+  p = positions_start + 4 * (size_t) nresources;
+  if (!get_u32 (rf, &p, &data_start) || data_start > rf->size)
+    goto done;
+  names_start = p;
+
+  /* The resources, in the order of the ResourceReader enumerator.  */
+  for (i = 0; i < nresources; i++)
+    {
+      size_t q = positions_start + 4 * (size_t) i;
+      unsigned int name_position;
+      unsigned int data_position;
+      const unsigned char *name;
+      size_t name_len;
+      char *msgid;
+      char *msgctxt;
+      char *msgstr;
+      char *separator;
+
+      if (!get_u32 (rf, &q, &name_position)
+          || name_position > rf->size - names_start)
+        goto done;
+      q = names_start + name_position;
+      if (!get_string (rf, &q, &name, &name_len) || name_len % 2 != 0
+          || !get_u32 (rf, &q, &data_position)
+          || data_position > rf->size - data_start)
+        goto done;
+
+      /* Convert the name from UTF-16LE to UTF-8.  */
+      msgid = utf16le_to_utf8 (name, name_len / 2);
+      if (msgid == NULL)
+        goto done;
+
+      msgstr = get_value (rf, data_start + data_position, version,
+                          types, type_lengths, ntypes);
+      if (msgstr == NULL)
+        {
+          free (msgid);
+          goto done;
+        }
+
+      /* DumpResource splits the name at the context separator.  */
+      separator = strchr (msgid, MSGCTXT_SEPARATOR);
+      if (separator != NULL)
+        {
+          *separator = '\0';
+          msgctxt = msgid;
+          msgid = xstrdup (separator + 1);
+        }
+      else
+        msgctxt = NULL;
+
+      message_list_append (mlp,
+                           message_alloc (msgctxt, msgid, NULL,
+                                          msgstr, strlen (msgstr) + 1, &pos));
+    }
+  ok = true;
+
+ done:
+  free (type_lengths);
+  free (types);
+  return ok;
+}
+
+
 
 struct locals
 {
@@ -97,6 +374,72 @@ read_resources_file (message_list_ty *mlp, const char *filename)
   char *assembly_path;
   const char *libdirs[1];
   struct locals locals;
+  struct temp_dir *tmpdir = NULL;
+  char *tmp_file_name = NULL;
+
+  /* Read the file directly, if possible.  */
+  {
+    bool is_stdin =
+      (strcmp (filename, "-") == 0 || strcmp (filename, "/dev/stdin") == 0);
+    FILE *fp = (is_stdin ? stdin : fopen (filename, "rb"));
+
+    if (fp != NULL)
+      {
+        struct resources_file rf;
+        char *contents;
+        message_list_ty *read_mlp;
+        bool parsed;
+
+        if (is_stdin)
+          SET_BINARY (fileno (fp));
+        contents = fread_file (fp, 0, &rf.size);
+        if (contents == NULL)
+          error (EXIT_FAILURE, errno,
+                 _("error while reading \"%s\""), filename);
+        if (!is_stdin)
+          fclose (fp);
+        rf.data = (const unsigned char *) contents;
+
+        read_mlp = message_list_alloc (false);
+        parsed = parse_resources_file (&rf, read_mlp);
+        if (parsed)
+          {
+            size_t j;
+
+            free (contents);
+            for (j = 0; j < read_mlp->nitems; j++)
+              message_list_append (mlp, read_mlp->item[j]);
+            message_list_free (read_mlp, 1);
+            return;
+          }
+        message_list_free (read_mlp, 0);
+
+        /* The standard input is consumed.  Pass a copy of it to the C#
+           program instead.  */
+        if (is_stdin)
+          {
+            FILE *tmp_fp;
+
+            tmpdir = create_temp_dir ("msg", NULL, false);
+            if (tmpdir == NULL)
+              exit (EXIT_FAILURE);
+            tmp_file_name =
+              xconcatenated_filename (tmpdir->dir_name, "stdin.resources",
+                                      NULL);
+            register_temp_file (tmpdir, tmp_file_name);
+            tmp_fp = fopen_temp (tmp_file_name, "wb", false);
+            if (tmp_fp == NULL)
+              error (EXIT_FAILURE, errno, _("failed to create \"%s\""),
+                     tmp_file_name);
+            fwrite (contents, 1, rf.size, tmp_fp);
+            if (fwriteerror_temp (tmp_fp))
+              error (EXIT_FAILURE, errno,
+                     _("error while writing \"%s\" file"), tmp_file_name);
+            filename = tmp_file_name;
+          }
+        free (contents);
+      }
+  }
 
   /* Prepare arguments.  */
   args[0] = filename;
@@ -135,4 +478,9 @@ read_resources_file (message_list_ty *mlp, const char *filename)
   }
 
   free (assembly_path);
+  if (tmpdir != NULL)
+    {
+      cleanup_temp_dir (tmpdir);
+      free (tmp_file_name);
+    }
 }
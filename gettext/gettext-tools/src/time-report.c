@@ -0,0 +1,245 @@
+/* Phase timing for the --time-report option.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Specification.  */
+#include "time-report.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "timespec.h"
+
+/* The heap usage is only known with glibc.  Elsewhere, no portable means
+   of measuring it exists.  */
+#if defined __GLIBC__ && HAVE_MALLOC_H
+# include <malloc.h>
+# define HAVE_HEAP_USAGE 1
+#endif
+
+
+/* The maximum number of distinct phases.  Further phases are ignored.  */
+#define MAX_PHASES 16
+
+struct phase
+{
+  const char *name;
+  unsigned long count;
+  /* The accumulated totals.  */
+  double elapsed;
+  double cpu;
+  long heap;
+  /* False for the phases filled through time_report_add.  */
+  bool has_cpu;
+  /* The values at the beginning of the current entry.  */
+  double start_elapsed;
+  clock_t start_cpu;
+  long start_heap;
+};
+
+static struct phase phases[MAX_PHASES];
+static size_t nphases;
+
+bool time_report_enabled;
+
+static enum time_report_format report_format;
+
+
+/* Returns the number of bytes currently allocated from the heap.  */
+static long
+heap_usage (void)
+{
+#if HAVE_HEAP_USAGE
+# if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 info = mallinfo2 ();
+# else
+  struct mallinfo info = mallinfo ();
+# endif
+
+  return (long) info.uordblks + (long) info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+
+double
+time_report_clock (void)
+{
+  struct timespec now;
+
+  gettime (&now);
+  return timespectod (now);
+}
+
+
+/* Returns the phase with the given name, or NULL if there are too many
+   phases.  */
+static struct phase *
+find_phase (const char *name)
+{
+  size_t i;
+
+  for (i = 0; i < nphases; i++)
+    if (phases[i].name == name || strcmp (phases[i].name, name) == 0)
+      return &phases[i];
+
+  if (nphases == MAX_PHASES)
+    return NULL;
+  phases[nphases].name = name;
+  return &phases[nphases++];
+}
+
+
+void
+time_report_begin (const char *name)
+{
+  struct phase *phase;
+
+  if (!time_report_enabled)
+    return;
+
+  phase = find_phase (name);
+  if (phase != NULL)
+    {
+      phase->has_cpu = true;
+      phase->start_heap = heap_usage ();
+      phase->start_cpu = clock ();
+      phase->start_elapsed = time_report_clock ();
+    }
+}
+
+
+void
+time_report_end (const char *name)
+{
+  struct phase *phase;
+
+  if (!time_report_enabled)
+    return;
+
+  phase = find_phase (name);
+  if (phase != NULL)
+    {
+      phase->elapsed += time_report_clock () - phase->start_elapsed;
+      phase->cpu += (double) (clock () - phase->start_cpu) / CLOCKS_PER_SEC;
+      phase->heap += heap_usage () - phase->start_heap;
+      phase->count++;
+    }
+}
+
+
+void
+time_report_add (const char *name, double seconds, unsigned long count)
+{
+  struct phase *phase;
+
+  if (!time_report_enabled)
+    return;
+
+  phase = find_phase (name);
+  if (phase != NULL)
+    {
+      phase->elapsed += seconds;
+      phase->count += count;
+    }
+}
+
+
+/* Writes the report to standard error.  */
+static void
+time_report_print (void)
+{
+  size_t i;
+
+  if (report_format == time_report_json)
+    {
+      fputs ("{\"phases\":[", stderr);
+      for (i = 0; i < nphases; i++)
+        {
+          const struct phase *phase = &phases[i];
+
+          fprintf (stderr, "%s\n {\"name\":\"%s\",\"count\":%lu,\"elapsed\":%.6f",
+                   i > 0 ? "," : "", phase->name, phase->count,
+                   phase->elapsed);
+          if (phase->has_cpu)
+            fprintf (stderr, ",\"cpu\":%.6f", phase->cpu);
+          else
+            fputs (",\"cpu\":null", stderr);
+#if HAVE_HEAP_USAGE
+          if (phase->has_cpu)
+            fprintf (stderr, ",\"heap\":%ld", phase->heap);
+          else
+#endif
+            fputs (",\"heap\":null", stderr);
+          fputs ("}", stderr);
+        }
+      fputs ("\n]}\n", stderr);
+    }
+  else
+    {
+      fprintf (stderr, "%-20s %10s %12s %12s %12s\n",
+               "phase", "count", "elapsed(s)", "cpu(s)", "heap(KiB)");
+      for (i = 0; i < nphases; i++)
+        {
+          const struct phase *phase = &phases[i];
+
+          fprintf (stderr, "%-20s %10lu %12.6f",
+                   phase->name, phase->count, phase->elapsed);
+          if (phase->has_cpu)
+            fprintf (stderr, " %12.6f", phase->cpu);
+          else
+            fprintf (stderr, " %12s", "-");
+#if HAVE_HEAP_USAGE
+          if (phase->has_cpu)
+            fprintf (stderr, " %+12ld", phase->heap / 1024);
+          else
+#endif
+            fprintf (stderr, " %12s", "-");
+          fputc ('\n', stderr);
+        }
+    }
+}
+
+
+bool
+time_report_parse_format (const char *arg, enum time_report_format *formatp)
+{
+  if (arg == NULL || strcmp (arg, "text") == 0)
+    *formatp = time_report_text;
+  else if (strcmp (arg, "json") == 0)
+    *formatp = time_report_json;
+  else
+    return false;
+  return true;
+}
+
+
+void
+time_report_request (enum time_report_format format)
+{
+  report_format = format;
+  if (!time_report_enabled)
+    {
+      time_report_enabled = true;
+      atexit (time_report_print);
+    }
+}
@@ -0,0 +1,77 @@
+/* Phase timing for the --time-report option.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef _TIME_REPORT_H
+#define _TIME_REPORT_H
+
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* A program is divided into named phases, such as "parse" or "output".
+   For each phase, the number of times it was entered, the elapsed time,
+   the processor time and the change in heap usage are accumulated.
+   A phase may be entered several times; nested phases are counted in full
+   in the enclosing phase.  The phases are reported in the order in which
+   they were first entered.  */
+
+/* The formats of the report.  */
+enum time_report_format
+{
+  time_report_text,
+  time_report_json
+};
+
+/* True if a report has been requested.  */
+extern DLL_VARIABLE bool time_report_enabled;
+
+/* Parses the argument of the --time-report option.  ARG may be NULL,
+   meaning the default format.  Returns false if ARG is not a known
+   format.  */
+extern bool time_report_parse_format (const char *arg,
+                                      enum time_report_format *formatp);
+
+/* Requests that the report be written to standard error, in the given
+   format, when the program exits.  */
+extern void time_report_request (enum time_report_format format);
+
+/* Marks the beginning and the end of a phase.  They do nothing unless a
+   report has been requested.
+   These functions are not multithread-safe.  */
+extern void time_report_begin (const char *phase);
+extern void time_report_end (const char *phase);
+
+/* Returns the current elapsed time, in seconds.  */
+extern double time_report_clock (void);
+
+/* Adds SECONDS of elapsed time and COUNT entries to a phase, for phases
+   that are too short-lived to be delimited by time_report_begin and
+   time_report_end, or that run in several threads.  The processor time
+   and heap usage of such phases are not known.  Does nothing unless a
+   report has been requested.  */
+extern void time_report_add (const char *phase, double seconds,
+                             unsigned long count);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TIME_REPORT_H */
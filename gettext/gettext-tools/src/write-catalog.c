@@ -40,6 +40,7 @@
 #include "error-progname.h"
 #include "xvasprintf.h"
 #include "po-xerror.h"
+#include "write-po.h"
 #include "gettext.h"
 
 /* Our regular abbreviation.  */
@@ -310,7 +311,9 @@ msgdomain_list_print (msgdomain_list_ty *mdlp, const char *filename,
           noop_styled_ostream_t styled_stream;
 
           styled_stream = noop_styled_ostream_create (stream, false);
+          message_print_stream_unstyled (true);
           output_syntax->print (mdlp, styled_stream, page_width, debug);
+          message_print_stream_unstyled (false);
           ostream_free (styled_stream);
         }
 #else
@@ -26,9 +26,11 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <sys/stat.h>
 #if !defined S_ISDIR && defined S_IFDIR
@@ -60,6 +62,7 @@
 #include "javacomp.h"
 #include "message.h"
 #include "msgfmt.h"
+#include "hash.h"
 #include "msgl-iconv.h"
 #include "msgl-header.h"
 #include "plural-exp.h"
@@ -1041,22 +1044,1419 @@ write_java_code (FILE *stream, const char *class_name, message_list_ty *mlp,
 }
 
 
+/* ======================== Writing the .class file ======================== */
+
+/* The class file is written directly, in the format of Java 1.5 (class file
+   version 49.0), so that no Java compiler is needed.  This version does not
+   need StackMapTable attributes.  The generated class has the same methods
+   and fields as the class that a Java compiler would produce from the
+   output of write_java_code.  Only the getKeys method of the Java2 variant
+   differs: it returns the keys through a java.util.Vector instead of an
+   anonymous inner class, in the same order.  */
+
+/* A growable byte buffer.  */
+struct bytebuf
+{
+  unsigned char *data;
+  size_t length;
+  size_t allocated;
+};
+
+static void
+bytebuf_init (struct bytebuf *bb)
+{
+  bb->data = NULL;
+  bb->length = 0;
+  bb->allocated = 0;
+}
+
+static void
+bytebuf_append (struct bytebuf *bb, const void *data, size_t length)
+{
+  if (bb->length + length > bb->allocated)
+    {
+      bb->allocated = 2 * bb->allocated + length + 64;
+      bb->data = (unsigned char *) xrealloc (bb->data, bb->allocated);
+    }
+  memcpy (bb->data + bb->length, data, length);
+  bb->length += length;
+}
+
+static void
+bytebuf_u1 (struct bytebuf *bb, unsigned int value)
+{
+  unsigned char buf[1];
+
+  buf[0] = value & 0xff;
+  bytebuf_append (bb, buf, 1);
+}
+
+static void
+bytebuf_u2 (struct bytebuf *bb, unsigned int value)
+{
+  unsigned char buf[2];
+
+  buf[0] = (value >> 8) & 0xff;
+  buf[1] = value & 0xff;
+  bytebuf_append (bb, buf, 2);
+}
+
+static void
+bytebuf_u4 (struct bytebuf *bb, unsigned int value)
+{
+  unsigned char buf[4];
+
+  buf[0] = (value >> 24) & 0xff;
+  buf[1] = (value >> 16) & 0xff;
+  buf[2] = (value >> 8) & 0xff;
+  buf[3] = value & 0xff;
+  bytebuf_append (bb, buf, 4);
+}
+
+static void
+bytebuf_destroy (struct bytebuf *bb)
+{
+  free (bb->data);
+}
+
+
+/* Constant pool tags.  */
+enum
+{
+  CONSTANT_Utf8 = 1,
+  CONSTANT_Integer = 3,
+  CONSTANT_Long = 5,
+  CONSTANT_Class = 7,
+  CONSTANT_String = 8,
+  CONSTANT_Fieldref = 9,
+  CONSTANT_Methodref = 10,
+  CONSTANT_NameAndType = 12
+};
+
+/* The class file being built.  */
+struct class_file
+{
+  /* The constant pool entries, and a map from each entry to its index.  */
+  struct bytebuf constants;
+  unsigned int constants_count;
+  hash_table constants_map;
+  /* The serialized fields and methods.  */
+  struct bytebuf fields;
+  unsigned int fields_count;
+  struct bytebuf methods;
+  unsigned int methods_count;
+  /* The internal name of the class, such as "com/foo/Messages_de".  */
+  char *this_name;
+  /* Set when a limit of the class file format has been exceeded.  */
+  bool overflow;
+};
+
+/* Return the index of the constant pool entry ENTRY[0..LENGTH-1], which
+   occupies SLOTS slots, adding it if needed.  */
+static unsigned int
+cp_add (struct class_file *cf, const unsigned char *entry, size_t length,
+        unsigned int slots)
+{
+  void *found;
+  unsigned int index;
+
+  if (hash_find_entry (&cf->constants_map, entry, length, &found) == 0)
+    return (uintptr_t) found;
+
+  index = cf->constants_count;
+  if (index + slots > 0xffff)
+    {
+      cf->overflow = true;
+      return 1;
+    }
+  bytebuf_append (&cf->constants, entry, length);
+  cf->constants_count += slots;
+  hash_insert_entry (&cf->constants_map, entry, length,
+                     (void *) (uintptr_t) index);
+  return index;
+}
+
+/* Return the index of a CONSTANT_Utf8 entry, given the string in modified
+   UTF-8 encoding.  */
+static unsigned int
+cp_utf8 (struct class_file *cf, const char *str, size_t length)
+{
+  unsigned char *entry = (unsigned char *) xmalloca (3 + length);
+  unsigned int index;
+
+  entry[0] = CONSTANT_Utf8;
+  entry[1] = (length >> 8) & 0xff;
+  entry[2] = length & 0xff;
+  memcpy (entry + 3, str, length);
+  index = cp_add (cf, entry, 3 + length, 1);
+  freea (entry);
+  return index;
+}
+
+/* Return the index of an entry that refers to one or two other entries.  */
+static unsigned int
+cp_ref (struct class_file *cf, unsigned int tag,
+        unsigned int index1, unsigned int index2, bool two)
+{
+  unsigned char entry[5];
+
+  entry[0] = tag;
+  entry[1] = (index1 >> 8) & 0xff;
+  entry[2] = index1 & 0xff;
+  entry[3] = (index2 >> 8) & 0xff;
+  entry[4] = index2 & 0xff;
+  return cp_add (cf, entry, two ? 5 : 3, 1);
+}
+
+static unsigned int
+cp_class (struct class_file *cf, const char *name)
+{
+  return cp_ref (cf, CONSTANT_Class, cp_utf8 (cf, name, strlen (name)), 0,
+                 false);
+}
+
+static unsigned int
+cp_name_and_type (struct class_file *cf, const char *name,
+                  const char *descriptor)
+{
+  return cp_ref (cf, CONSTANT_NameAndType,
+                 cp_utf8 (cf, name, strlen (name)),
+                 cp_utf8 (cf, descriptor, strlen (descriptor)), true);
+}
+
+static unsigned int
+cp_fieldref (struct class_file *cf, const char *class_name, const char *name,
+             const char *descriptor)
+{
+  return cp_ref (cf, CONSTANT_Fieldref, cp_class (cf, class_name),
+                 cp_name_and_type (cf, name, descriptor), true);
+}
+
+static unsigned int
+cp_methodref (struct class_file *cf, const char *class_name, const char *name,
+              const char *descriptor)
+{
+  return cp_ref (cf, CONSTANT_Methodref, cp_class (cf, class_name),
+                 cp_name_and_type (cf, name, descriptor), true);
+}
+
+/* Return the index of a CONSTANT_String entry, given the string in modified
+   UTF-8 encoding.  */
+static unsigned int
+cp_add_string (struct class_file *cf, const char *str, size_t length)
+{
+  return cp_ref (cf, CONSTANT_String, cp_utf8 (cf, str, length), 0, false);
+}
+
+static unsigned int
+cp_integer (struct class_file *cf, unsigned int value)
+{
+  unsigned char entry[5];
+
+  entry[0] = CONSTANT_Integer;
+  entry[1] = (value >> 24) & 0xff;
+  entry[2] = (value >> 16) & 0xff;
+  entry[3] = (value >> 8) & 0xff;
+  entry[4] = value & 0xff;
+  return cp_add (cf, entry, 5, 1);
+}
+
+static unsigned int
+cp_long (struct class_file *cf, unsigned long long value)
+{
+  unsigned char entry[9];
+  int i;
+
+  entry[0] = CONSTANT_Long;
+  for (i = 0; i < 8; i++)
+    entry[1 + i] = (value >> (56 - 8 * i)) & 0xff;
+  /* A long constant occupies two slots.  */
+  return cp_add (cf, entry, 9, 2);
+}
+
+
+/* Convert the UTF-8 string STR to the "modified UTF-8" encoding of class
+   files, in which supplementary characters are represented as UTF-16
+   surrogate pairs.  Return a freshly allocated string and its length.  */
+static char *
+convert_to_modified_utf8 (const char *str, size_t *lengthp)
+{
+  const char *str_limit = str + strlen (str);
+  /* Each byte expands to at most 2 bytes (a 4-byte UTF-8 sequence expands
+     to 6 bytes).  */
+  char *result = XNMALLOC (2 * (str_limit - str) + 1, char);
+  unsigned char *q = (unsigned char *) result;
+
+  while (str < str_limit)
+    {
+      ucs4_t uc;
+      int n = u8_mbtouc (&uc, (const unsigned char *) str, str_limit - str);
+
+      if (uc < 0x10000)
+        {
+          if (uc != 0 && uc < 0x80)
+            *q++ = uc;
+          else if (uc < 0x800)
+            {
+              *q++ = 0xc0 | (uc >> 6);
+              *q++ = 0x80 | (uc & 0x3f);
+            }
+          else
+            {
+              *q++ = 0xe0 | (uc >> 12);
+              *q++ = 0x80 | ((uc >> 6) & 0x3f);
+              *q++ = 0x80 | (uc & 0x3f);
+            }
+        }
+      else
+        {
+          /* UTF-16 surrogate: two 'char's.  */
+          ucs4_t uc1 = 0xd800 + ((uc - 0x10000) >> 10);
+          ucs4_t uc2 = 0xdc00 + ((uc - 0x10000) & 0x3ff);
+          *q++ = 0xe0 | (uc1 >> 12);
+          *q++ = 0x80 | ((uc1 >> 6) & 0x3f);
+          *q++ = 0x80 | (uc1 & 0x3f);
+          *q++ = 0xe0 | (uc2 >> 12);
+          *q++ = 0x80 | ((uc2 >> 6) & 0x3f);
+          *q++ = 0x80 | (uc2 & 0x3f);
+        }
+      str += n;
+    }
+  *lengthp = q - (unsigned char *) result;
+  *q = '\0';
+  return result;
+}
+
+
+/* Opcodes of the Java virtual machine.  */
+enum
+{
+  op_aconst_null = 0x01,
+  op_iconst_m1 = 0x02,
+  op_iconst_0 = 0x03,
+  op_iconst_1 = 0x04,
+  op_lconst_0 = 0x09,
+  op_lconst_1 = 0x0a,
+  op_bipush = 0x10,
+  op_sipush = 0x11,
+  op_ldc = 0x12,
+  op_ldc_w = 0x13,
+  op_ldc2_w = 0x14,
+  op_iload = 0x15,
+  op_aload = 0x19,
+  op_lload_0 = 0x1e,
+  op_aload_0 = 0x2a,
+  op_aaload = 0x32,
+  op_istore = 0x36,
+  op_astore = 0x3a,
+  op_aastore = 0x53,
+  op_pop = 0x57,
+  op_dup = 0x59,
+  op_iadd = 0x60,
+  op_ladd = 0x61,
+  op_isub = 0x64,
+  op_lsub = 0x65,
+  op_lmul = 0x69,
+  op_ldiv = 0x6d,
+  op_irem = 0x70,
+  op_lrem = 0x71,
+  op_ishl = 0x78,
+  op_iand = 0x7e,
+  op_ixor = 0x82,
+  op_iinc = 0x84,
+  op_i2l = 0x85,
+  op_lcmp = 0x94,
+  op_ifeq = 0x99,
+  op_ifne = 0x9a,
+  op_iflt = 0x9b,
+  op_ifge = 0x9c,
+  op_ifgt = 0x9d,
+  op_ifle = 0x9e,
+  op_if_icmplt = 0xa1,
+  op_if_icmpge = 0xa2,
+  op_goto = 0xa7,
+  op_lreturn = 0xad,
+  op_areturn = 0xb0,
+  op_return = 0xb1,
+  op_getstatic = 0xb2,
+  op_putstatic = 0xb3,
+  op_getfield = 0xb4,
+  op_invokevirtual = 0xb6,
+  op_invokespecial = 0xb7,
+  op_invokestatic = 0xb8,
+  op_new = 0xbb,
+  op_anewarray = 0xbd,
+  op_checkcast = 0xc0,
+  op_instanceof = 0xc1,
+  op_ifnull = 0xc6,
+  op_ifnonnull = 0xc7
+};
+
+/* The bytecode of a method being built.  */
+struct code
+{
+  struct class_file *cf;
+  struct bytebuf bytes;
+  /* The current and the maximum depth of the operand stack, in slots.  */
+  int depth;
+  int max_depth;
+  /* False after an unconditional jump or a return.  */
+  bool reachable;
+};
+
+/* A branch target.  */
+struct label
+{
+  /* The position of the target, or -1 if not yet known.  */
+  long position;
+  /* The stack depth at the target.  */
+  int depth;
+  /* The positions of the branch instructions that jump to the target
+     before its position is known.  */
+  size_t fixups[4];
+  size_t nfixups;
+};
+
+static void
+code_init (struct code *code, struct class_file *cf)
+{
+  code->cf = cf;
+  bytebuf_init (&code->bytes);
+  code->depth = 0;
+  code->max_depth = 0;
+  code->reachable = true;
+}
+
+static void
+code_adjust_depth (struct code *code, int delta)
+{
+  code->depth += delta;
+  if (code->depth < 0)
+    abort ();
+  if (code->max_depth < code->depth)
+    code->max_depth = code->depth;
+}
+
+/* Emit an instruction without operands, that changes the stack depth by
+   DELTA.  */
+static void
+code_op (struct code *code, unsigned int opcode, int delta)
+{
+  bytebuf_u1 (&code->bytes, opcode);
+  code_adjust_depth (code, delta);
+  if (opcode == op_areturn || opcode == op_lreturn || opcode == op_return)
+    code->reachable = false;
+}
+
+/* Emit an instruction with a one-byte operand.  */
+static void
+code_op_u1 (struct code *code, unsigned int opcode, unsigned int operand,
+            int delta)
+{
+  bytebuf_u1 (&code->bytes, opcode);
+  bytebuf_u1 (&code->bytes, operand);
+  code_adjust_depth (code, delta);
+}
+
+/* Emit an instruction with a two-byte operand, such as a constant pool
+   index.  */
+static void
+code_op_u2 (struct code *code, unsigned int opcode, unsigned int operand,
+            int delta)
+{
+  bytebuf_u1 (&code->bytes, opcode);
+  bytebuf_u2 (&code->bytes, operand);
+  code_adjust_depth (code, delta);
+}
+
+/* Emit an instruction that accesses the local variable INDEX.  */
+static void
+code_local (struct code *code, unsigned int opcode, unsigned int index,
+            int delta)
+{
+  /* Use the short forms iload_<n>, aload_<n>, istore_<n>, astore_<n>.  */
+  if (index <= 3)
+    {
+      unsigned int short_opcode =
+        (opcode == op_iload ? 0x1a :
+         opcode == op_aload ? 0x2a :
+         opcode == op_istore ? 0x3b :
+         /* opcode == op_astore */ 0x4b);
+      code_op (code, short_opcode + index, delta);
+    }
+  else
+    code_op_u1 (code, opcode, index, delta);
+}
+
+/* Emit an instruction that pushes the int VALUE.  */
+static void
+code_int (struct code *code, int value)
+{
+  if (value >= -1 && value <= 5)
+    code_op (code, op_iconst_0 + value, 1);
+  else if (value >= -128 && value <= 127)
+    code_op_u1 (code, op_bipush, value, 1);
+  else if (value >= -32768 && value <= 32767)
+    code_op_u2 (code, op_sipush, value, 1);
+  else
+    code_op_u2 (code, op_ldc_w, cp_integer (code->cf, value), 1);
+}
+
+static void
+label_init (struct label *label)
+{
+  label->position = -1;
+  label->nfixups = 0;
+}
+
+static void
+code_patch_branch (struct code *code, size_t branch_position, long target)
+{
+  long offset = target - (long) branch_position;
+
+  code->bytes.data[branch_position + 1] = (offset >> 8) & 0xff;
+  code->bytes.data[branch_position + 2] = offset & 0xff;
+}
+
+/* Emit a branch instruction to LABEL, that changes the stack depth by
+   DELTA.  */
+static void
+code_branch (struct code *code, unsigned int opcode, struct label *label,
+             int delta)
+{
+  size_t position = code->bytes.length;
+
+  code_op_u2 (code, opcode, 0, delta);
+  label->depth = code->depth;
+  if (label->position >= 0)
+    code_patch_branch (code, position, label->position);
+  else
+    {
+      if (label->nfixups
+          == sizeof (label->fixups) / sizeof (label->fixups[0]))
+        abort ();
+      label->fixups[label->nfixups++] = position;
+    }
+  if (opcode == op_goto)
+    code->reachable = false;
+}
+
+/* Set the position of LABEL to the current position.  */
+static void
+code_label (struct code *code, struct label *label)
+{
+  size_t i;
+
+  label->position = code->bytes.length;
+  for (i = 0; i < label->nfixups; i++)
+    code_patch_branch (code, label->fixups[i], label->position);
+  if (label->nfixups > 0)
+    {
+      /* The stack depth must be the same on all paths.  */
+      if (code->reachable && code->depth != label->depth)
+        abort ();
+      code->depth = label->depth;
+    }
+  else
+    label->depth = code->depth;
+  code->reachable = true;
+}
+
+
+/* Emit code that pushes the string STR, given in UTF-8.  */
+static void
+code_string (struct code *code, const char *str)
+{
+  size_t length;
+  char *mstr = convert_to_modified_utf8 (str, &length);
+
+  if (length <= 0xffff)
+    {
+      unsigned int index = cp_add_string (code->cf, mstr, length);
+
+      if (index < 0x100)
+        code_op_u1 (code, op_ldc, index, 1);
+      else
+        code_op_u2 (code, op_ldc_w, index, 1);
+    }
+  else
+    {
+      /* A constant is limited to 65535 bytes.  Concatenate the string from
+         pieces, without splitting a multibyte sequence.  */
+      const char *sb = "java/lang/StringBuffer";
+      size_t start;
+
+      code_op_u2 (code, op_new, cp_class (code->cf, sb), 1);
+      code_op (code, op_dup, 1);
+      code_op_u2 (code, op_invokespecial,
+                  cp_methodref (code->cf, sb, "<init>", "()V"), -1);
+      for (start = 0; start < length; )
+        {
+          size_t end = start + 0xffff;
+
+          if (end >= length)
+            end = length;
+          else
+            while ((mstr[end] & 0xc0) == 0x80)
+              end--;
+          code_op_u2 (code, op_ldc_w,
+                      cp_add_string (code->cf, mstr + start, end - start), 1);
+          code_op_u2 (code, op_invokevirtual,
+                      cp_methodref (code->cf, sb, "append",
+                                    "(Ljava/lang/String;)Ljava/lang/StringBuffer;"),
+                      -1);
+          start = end;
+        }
+      code_op_u2 (code, op_invokevirtual,
+                  cp_methodref (code->cf, sb, "toString",
+                                "()Ljava/lang/String;"),
+                  0);
+    }
+  free (mstr);
+}
+
+/* Emit code that pushes the key of the message MP.  */
+static void
+code_msgid (struct code *code, message_ty *mp)
+{
+  const char *msgctxt = mp->msgctxt;
+  const char *msgid = mp->msgid;
+
+  if (msgctxt == NULL)
+    code_string (code, msgid);
+  else
+    {
+      size_t msgctxt_len = strlen (msgctxt);
+      size_t msgid_len = strlen (msgid);
+      size_t combined_len = msgctxt_len + 1 + msgid_len;
+      char *combined;
+
+      combined = (char *) xmalloca (combined_len + 1);
+      memcpy (combined, msgctxt, msgctxt_len);
+      combined[msgctxt_len] = MSGCTXT_SEPARATOR;
+      memcpy (combined + msgctxt_len + 1, msgid, msgid_len + 1);
+
+      code_string (code, combined);
+
+      freea (combined);
+    }
+}
+
+/* Emit code that pushes the value for the message MP: a String[] if the
+   message has plural forms, otherwise a String.  */
+static void
+code_msgstr (struct code *code, message_ty *mp)
+{
+  if (mp->msgid_plural != NULL)
+    {
+      const char *p;
+      int nforms;
+      int k;
+
+      nforms = 0;
+      for (p = mp->msgstr; p < mp->msgstr + mp->msgstr_len; p += strlen (p) + 1)
+        nforms++;
+      code_int (code, nforms);
+      code_op_u2 (code, op_anewarray,
+                  cp_class (code->cf, "java/lang/String"), 0);
+      for (p = mp->msgstr, k = 0;
+           p < mp->msgstr + mp->msgstr_len;
+           p += strlen (p) + 1, k++)
+        {
+          code_op (code, op_dup, 1);
+          code_int (code, k);
+          code_string (code, p);
+          code_op (code, op_aastore, -3);
+        }
+    }
+  else
+    {
+      if (mp->msgstr_len != strlen (mp->msgstr) + 1)
+        abort ();
+
+      code_string (code, mp->msgstr);
+    }
+}
+
+
+/* Emit code that pushes the value of the plural expression EXP, according
+   to the C rules, as a Java 'long' (if !AS_BOOLEAN) or as an 'int' that is
+   0 or 1 (if AS_BOOLEAN).  The variable n is the local variable 0.  This
+   corresponds to write_java_expression.  */
+static void
+code_expression (struct code *code, const struct expression *exp,
+                 bool as_boolean)
+{
+  if (as_boolean)
+    {
+      unsigned int opcode;
+      struct label l_true;
+      struct label l_false;
+      struct label l_end;
+
+      label_init (&l_true);
+      label_init (&l_false);
+      label_init (&l_end);
+      switch (exp->operation)
+        {
+        case num:
+          code_op (code, exp->val.num ? op_iconst_1 : op_iconst_0, 1);
+          return;
+        case lnot:
+          code_expression (code, exp->val.args[0], true);
+          code_op (code, op_iconst_1, 1);
+          code_op (code, op_ixor, -1);
+          return;
+        case land:
+          code_expression (code, exp->val.args[0], true);
+          code_branch (code, op_ifeq, &l_false, -1);
+          code_expression (code, exp->val.args[1], true);
+          code_branch (code, op_goto, &l_end, 0);
+          code_label (code, &l_false);
+          code_op (code, op_iconst_0, 1);
+          code_label (code, &l_end);
+          return;
+        case lor:
+          code_expression (code, exp->val.args[0], true);
+          code_branch (code, op_ifne, &l_true, -1);
+          code_expression (code, exp->val.args[1], true);
+          code_branch (code, op_goto, &l_end, 0);
+          code_label (code, &l_true);
+          code_op (code, op_iconst_1, 1);
+          code_label (code, &l_end);
+          return;
+        case qmop:
+          if (is_expression_boolean (exp->val.args[1])
+              && is_expression_boolean (exp->val.args[2]))
+            {
+              code_expression (code, exp->val.args[0], true);
+              code_branch (code, op_ifeq, &l_false, -1);
+              code_expression (code, exp->val.args[1], true);
+              code_branch (code, op_goto, &l_end, 0);
+              code_label (code, &l_false);
+              code_expression (code, exp->val.args[2], true);
+              code_label (code, &l_end);
+              return;
+            }
+          /*FALLTHROUGH*/
+        case var:
+        case mult:
+        case divide:
+        case module:
+        case plus:
+        case minus:
+          /* Compare the value with 0.  */
+          code_expression (code, exp, false);
+          code_op (code, op_lconst_0, 2);
+          opcode = op_ifne;
+          break;
+        case less_than:
+          opcode = op_iflt;
+          goto comparison;
+        case greater_than:
+          opcode = op_ifgt;
+          goto comparison;
+        case less_or_equal:
+          opcode = op_ifle;
+          goto comparison;
+        case greater_or_equal:
+          opcode = op_ifge;
+          goto comparison;
+        case equal:
+          opcode = op_ifeq;
+          goto comparison;
+        case not_equal:
+          opcode = op_ifne;
+        comparison:
+          code_expression (code, exp->val.args[0], false);
+          code_expression (code, exp->val.args[1], false);
+          break;
+        default:
+          abort ();
+        }
+      /* Two longs are on the stack.  Convert their comparison to 0 or 1.  */
+      code_op (code, op_lcmp, -3);
+      code_branch (code, opcode, &l_true, -1);
+      code_op (code, op_iconst_0, 1);
+      code_branch (code, op_goto, &l_end, 0);
+      code_label (code, &l_true);
+      code_op (code, op_iconst_1, 1);
+      code_label (code, &l_end);
+    }
+  else
+    {
+      unsigned int opcode;
+
+      switch (exp->operation)
+        {
+        case var:
+          code_op (code, op_lload_0, 2);
+          return;
+        case num:
+          if (exp->val.num == 0)
+            code_op (code, op_lconst_0, 2);
+          else if (exp->val.num == 1)
+            code_op (code, op_lconst_1, 2);
+          else
+            code_op_u2 (code, op_ldc2_w, cp_long (code->cf, exp->val.num), 2);
+          return;
+        case mult:
+          opcode = op_lmul;
+          break;
+        case divide:
+          opcode = op_ldiv;
+          break;
+        case module:
+          opcode = op_lrem;
+          break;
+        case plus:
+          opcode = op_ladd;
+          break;
+        case minus:
+          opcode = op_lsub;
+          break;
+        case qmop:
+          {
+            struct label l_false;
+            struct label l_end;
+
+            label_init (&l_false);
+            label_init (&l_end);
+            code_expression (code, exp->val.args[0], true);
+            code_branch (code, op_ifeq, &l_false, -1);
+            code_expression (code, exp->val.args[1], false);
+            code_branch (code, op_goto, &l_end, 0);
+            code_label (code, &l_false);
+            code_expression (code, exp->val.args[2], false);
+            code_label (code, &l_end);
+          }
+          return;
+        case lnot:
+        case less_than:
+        case greater_than:
+        case less_or_equal:
+        case greater_or_equal:
+        case equal:
+        case not_equal:
+        case land:
+        case lor:
+          code_expression (code, exp, true);
+          code_op (code, op_i2l, 1);
+          return;
+        default:
+          abort ();
+        }
+      code_expression (code, exp->val.args[0], false);
+      code_expression (code, exp->val.args[1], false);
+      code_op (code, opcode, -2);
+    }
+}
+
+
+/* Add a field to the class.  */
+static void
+class_add_field (struct class_file *cf, unsigned int access_flags,
+                 const char *name, const char *descriptor)
+{
+  bytebuf_u2 (&cf->fields, access_flags);
+  bytebuf_u2 (&cf->fields, cp_utf8 (cf, name, strlen (name)));
+  bytebuf_u2 (&cf->fields, cp_utf8 (cf, descriptor, strlen (descriptor)));
+  bytebuf_u2 (&cf->fields, 0);
+  cf->fields_count++;
+}
+
+/* Add a method with the code CODE to the class, and free CODE.  */
+static void
+class_add_method (struct class_file *cf, unsigned int access_flags,
+                  const char *name, const char *descriptor,
+                  struct code *code, unsigned int max_locals)
+{
+  /* The code of a method is limited to 65535 bytes.  */
+  if (code->bytes.length > 0xffff)
+    cf->overflow = true;
+
+  bytebuf_u2 (&cf->methods, access_flags);
+  bytebuf_u2 (&cf->methods, cp_utf8 (cf, name, strlen (name)));
+  bytebuf_u2 (&cf->methods, cp_utf8 (cf, descriptor, strlen (descriptor)));
+  bytebuf_u2 (&cf->methods, 1);
+  /* The Code attribute.  */
+  bytebuf_u2 (&cf->methods, cp_utf8 (cf, "Code", 4));
+  bytebuf_u4 (&cf->methods, 12 + code->bytes.length);
+  bytebuf_u2 (&cf->methods, code->max_depth);
+  bytebuf_u2 (&cf->methods, max_locals);
+  bytebuf_u4 (&cf->methods, code->bytes.length);
+  bytebuf_append (&cf->methods, code->bytes.data, code->bytes.length);
+  bytebuf_u2 (&cf->methods, 0); /* exception_table_length */
+  bytebuf_u2 (&cf->methods, 0); /* attributes_count */
+  cf->methods_count++;
+
+  bytebuf_destroy (&code->bytes);
+}
+
+/* Access flags.  */
+enum
+{
+  ACC_PUBLIC = 0x0001,
+  ACC_PRIVATE = 0x0002,
+  ACC_STATIC = 0x0008,
+  ACC_FINAL = 0x0010,
+  ACC_SUPER = 0x0020
+};
+
+
+/* Emit the code that initializes the table of messages from the static
+   initializer.  The code expects the table in local variable 0, so that it
+   can be moved into separate methods when it is too large.  INIT_ITEM
+   emits the code for a single message.  */
+static void
+class_add_table_init (struct class_file *cf, struct code *clinit,
+                      const char *table_descriptor,
+                      void (*init_item) (struct code *code, void *item_data,
+                                         size_t j),
+                      void *item_data, size_t nitems)
+{
+  /* Keep enough room in each method for a message with many long plural
+     forms.  */
+  const size_t max_part_length = 60000;
+  struct code part;
+  unsigned int nparts = 0;
+  size_t j;
+
+  code_init (&part, cf);
+  for (j = 0; j < nitems; j++)
+    {
+      init_item (&part, item_data, j);
+      if (part.bytes.length > max_part_length || j + 1 == nitems)
+        {
+          if (nparts == 0 && j + 1 == nitems)
+            {
+              /* Everything fits into the static initializer.  */
+              bytebuf_append (&clinit->bytes, part.bytes.data,
+                              part.bytes.length);
+              if (clinit->max_depth < clinit->depth + part.max_depth)
+                clinit->max_depth = clinit->depth + part.max_depth;
+              bytebuf_destroy (&part.bytes);
+            }
+          else
+            {
+              char *name = xasprintf ("clinit_part_%u", nparts);
+              char *descriptor = xasprintf ("(%s)V", table_descriptor);
+
+              code_op (&part, op_return, 0);
+              class_add_method (cf, ACC_STATIC, name, descriptor, &part, 1);
+              code_op (clinit, op_aload_0, 1);
+              code_op_u2 (clinit, op_invokestatic,
+                          cp_methodref (cf, cf->this_name, name, descriptor),
+                          -1);
+              free (descriptor);
+              free (name);
+              nparts++;
+            }
+          code_init (&part, cf);
+        }
+    }
+  bytebuf_destroy (&part.bytes);
+}
+
+/* Emit code that initializes one message of the Java2 hash table.  */
+static void
+java2_init_item (struct code *code, void *item_data, size_t j)
+{
+  const struct table_item *ti = &((const struct table_item *) item_data)[j];
+
+  code_op (code, op_aload_0, 1);
+  code_int (code, 2 * ti->index);
+  code_msgid (code, ti->mp);
+  code_op (code, op_aastore, -3);
+  code_op (code, op_aload_0, 1);
+  code_int (code, 2 * ti->index + 1);
+  code_msgstr (code, ti->mp);
+  code_op (code, op_aastore, -3);
+}
+
+/* Emit code that puts one message into the Java 1.1.x Hashtable.  */
+static void
+java1_init_item (struct code *code, void *item_data, size_t j)
+{
+  message_ty *mp = ((message_list_ty *) item_data)->item[j];
+
+  code_op (code, op_aload_0, 1);
+  code_msgid (code, mp);
+  code_msgstr (code, mp);
+  code_op_u2 (code, op_invokevirtual,
+              cp_methodref (code->cf, "java/util/Hashtable", "put",
+                            "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;"),
+              -2);
+  code_op (code, op_pop, -1);
+}
+
+
+/* Emit code that compares the key in local variable 4 with msgid and
+   returns the table entry after it, or null.  Jump to L_MISMATCH if the
+   key is non-null and different.  */
+static void
+code_lookup_probe (struct code *code, unsigned int table_ref,
+                   struct label *l_mismatch)
+{
+  struct label l_found;
+
+  label_init (&l_found);
+  code_op_u2 (code, op_getstatic, table_ref, 1);
+  code_local (code, op_iload, 3, 1);
+  code_op (code, op_aaload, -1);
+  code_local (code, op_astore, 4, -1);
+  code_local (code, op_aload, 4, 1);
+  code_branch (code, op_ifnonnull, &l_found, -1);
+  code_op (code, op_aconst_null, 1);
+  code_op (code, op_areturn, -1);
+  code_label (code, &l_found);
+  code_local (code, op_aload, 1, 1);
+  code_local (code, op_aload, 4, 1);
+  code_op_u2 (code, op_invokevirtual,
+              cp_methodref (code->cf, "java/lang/String", "equals",
+                            "(Ljava/lang/Object;)Z"),
+              -1);
+  code_branch (code, op_ifeq, l_mismatch, -1);
+  code_op_u2 (code, op_getstatic, table_ref, 1);
+  code_local (code, op_iload, 3, 1);
+  code_op (code, op_iconst_1, 1);
+  code_op (code, op_iadd, -1);
+  code_op (code, op_aaload, -1);
+  code_op (code, op_areturn, -1);
+}
+
+/* Emit the lookup code for the Java2 hash table.  This corresponds to
+   write_lookup_code.  Local variables: 1 = msgid, 2 = hash_val, 3 = idx,
+   4 = found, 5 = incr.  */
+static void
+code_lookup (struct code *code, unsigned int table_ref,
+             unsigned int hashsize, bool collisions)
+{
+  struct label l_mismatch;
+
+  label_init (&l_mismatch);
+
+  /* int hash_val = msgid.hashCode() & 0x7fffffff;  */
+  code_local (code, op_aload, 1, 1);
+  code_op_u2 (code, op_invokevirtual,
+              cp_methodref (code->cf, "java/lang/String", "hashCode", "()I"),
+              0);
+  code_op_u2 (code, op_ldc_w, cp_integer (code->cf, 0x7fffffff), 1);
+  code_op (code, op_iand, -1);
+  code_local (code, op_istore, 2, -1);
+  /* int idx = (hash_val % hashsize) << 1;  */
+  code_local (code, op_iload, 2, 1);
+  code_int (code, hashsize);
+  code_op (code, op_irem, -1);
+  code_op (code, op_iconst_1, 1);
+  code_op (code, op_ishl, -1);
+  code_local (code, op_istore, 3, -1);
+
+  code_lookup_probe (code, table_ref, &l_mismatch);
+  code_label (code, &l_mismatch);
+  if (collisions)
+    {
+      struct label l_loop;
+      struct label l_inrange;
+
+      label_init (&l_loop);
+      label_init (&l_inrange);
+
+      /* int incr = ((hash_val % (hashsize - 2)) + 1) << 1;  */
+      code_local (code, op_iload, 2, 1);
+      code_int (code, hashsize - 2);
+      code_op (code, op_irem, -1);
+      code_op (code, op_iconst_1, 1);
+      code_op (code, op_iadd, -1);
+      code_op (code, op_iconst_1, 1);
+      code_op (code, op_ishl, -1);
+      code_local (code, op_istore, 5, -1);
+      /* for (;;) { idx += incr; if (idx >= 2 * hashsize) idx -= ...; ... }  */
+      code_label (code, &l_loop);
+      code_local (code, op_iload, 3, 1);
+      code_local (code, op_iload, 5, 1);
+      code_op (code, op_iadd, -1);
+      code_local (code, op_istore, 3, -1);
+      code_local (code, op_iload, 3, 1);
+      code_int (code, 2 * hashsize);
+      code_branch (code, op_if_icmplt, &l_inrange, -2);
+      code_local (code, op_iload, 3, 1);
+      code_int (code, 2 * hashsize);
+      code_op (code, op_isub, -1);
+      code_local (code, op_istore, 3, -1);
+      code_label (code, &l_inrange);
+      code_lookup_probe (code, table_ref, &l_loop);
+    }
+  else
+    {
+      code_op (code, op_aconst_null, 1);
+      code_op (code, op_areturn, -1);
+    }
+}
+
+
+/* Build the ResourceBundle subclass as a class file in CF.  This
+   corresponds to write_java_code.  */
+static void
+build_java_class (struct class_file *cf, message_list_ty *mlp,
+                  bool assume_java2)
+{
+  const char *resource_bundle = "java/util/ResourceBundle";
+  const char *table_descriptor;
+  unsigned int table_ref;
+  unsigned int plurals;
+  struct code code;
+  size_t j;
+
+  /* Determine whether there are plural messages.  */
+  plurals = 0;
+  for (j = 0; j < mlp->nitems; j++)
+    if (mlp->item[j]->msgid_plural != NULL)
+      plurals++;
+
+  /* The constructor.  */
+  code_init (&code, cf);
+  code_op (&code, op_aload_0, 1);
+  code_op_u2 (&code, op_invokespecial,
+              cp_methodref (cf, resource_bundle, "<init>", "()V"), -1);
+  code_op (&code, op_return, 0);
+  class_add_method (cf, ACC_PUBLIC, "<init>", "()V", &code, 1);
+
+  if (assume_java2)
+    {
+      unsigned int hashsize;
+      bool collisions;
+      struct table_item *table_items;
+      const char *table_eltype;
+
+      /* Determine the hash table size and whether it leads to collisions.  */
+      hashsize = compute_hashsize (mlp, &collisions);
+
+      /* Determines which indices in the table contain a message.  The others
+         are null.  */
+      table_items = compute_table_items (mlp, hashsize);
+
+      /* The table of pairs (msgid, msgstr).  If there are plurals, it is of
+         type Object[], otherwise of type String[].  */
+      table_eltype = (plurals ? "java/lang/Object" : "java/lang/String");
+      table_descriptor =
+        (plurals ? "[Ljava/lang/Object;" : "[Ljava/lang/String;");
+      class_add_field (cf, ACC_PRIVATE | ACC_STATIC | ACC_FINAL, "table",
+                       table_descriptor);
+      table_ref = cp_fieldref (cf, cf->this_name, "table", table_descriptor);
+
+      code_init (&code, cf);
+      code_int (&code, 2 * hashsize);
+      code_op_u2 (&code, op_anewarray, cp_class (cf, table_eltype), 0);
+      code_op (&code, op_dup, 1);
+      code_local (&code, op_astore, 0, -1);
+      class_add_table_init (cf, &code, table_descriptor,
+                            java2_init_item, table_items, mlp->nitems);
+      code_op_u2 (&code, op_putstatic, table_ref, -1);
+      code_op (&code, op_return, 0);
+      class_add_method (cf, ACC_STATIC, "<clinit>", "()V", &code, 1);
+
+      /* The msgid_plural strings.  Only used by msgunfmt.  */
+      if (plurals)
+        {
+          int k;
+
+          code_init (&code, cf);
+          code_int (&code, plurals);
+          code_op_u2 (&code, op_anewarray,
+                      cp_class (cf, "java/lang/String"), 0);
+          for (j = 0, k = 0; j < mlp->nitems; j++)
+            {
+              struct table_item *ti = &table_items[j];
+              if (ti->mp->msgid_plural != NULL)
+                {
+                  code_op (&code, op_dup, 1);
+                  code_int (&code, k++);
+                  code_string (&code, ti->mp->msgid_plural);
+                  code_op (&code, op_aastore, -3);
+                }
+            }
+          code_op (&code, op_areturn, -1);
+          class_add_method (cf, ACC_PUBLIC | ACC_STATIC | ACC_FINAL,
+                            "get_msgid_plural_table", "()[Ljava/lang/String;",
+                            &code, 0);
+        }
+
+      /* The lookup function, or the handleGetObject function.  */
+      code_init (&code, cf);
+      code_lookup (&code, table_ref, hashsize, collisions);
+      class_add_method (cf, ACC_PUBLIC,
+                        plurals ? "lookup" : "handleGetObject",
+                        "(Ljava/lang/String;)Ljava/lang/Object;",
+                        &code, collisions ? 6 : 5);
+
+      /* The getKeys function.  */
+      {
+        const char *vector = "java/util/Vector";
+        struct label l_loop;
+        struct label l_next;
+        struct label l_end;
+
+        label_init (&l_loop);
+        label_init (&l_next);
+        label_init (&l_end);
+        code_init (&code, cf);
+        code_op_u2 (&code, op_new, cp_class (cf, vector), 1);
+        code_op (&code, op_dup, 1);
+        code_op_u2 (&code, op_invokespecial,
+                    cp_methodref (cf, vector, "<init>", "()V"), -1);
+        code_local (&code, op_astore, 1, -1);
+        code_op (&code, op_iconst_0, 1);
+        code_local (&code, op_istore, 2, -1);
+        code_label (&code, &l_loop);
+        code_local (&code, op_iload, 2, 1);
+        code_int (&code, 2 * hashsize);
+        code_branch (&code, op_if_icmpge, &l_end, -2);
+        code_op_u2 (&code, op_getstatic, table_ref, 1);
+        code_local (&code, op_iload, 2, 1);
+        code_op (&code, op_aaload, -1);
+        code_branch (&code, op_ifnull, &l_next, -1);
+        code_local (&code, op_aload, 1, 1);
+        code_op_u2 (&code, op_getstatic, table_ref, 1);
+        code_local (&code, op_iload, 2, 1);
+        code_op (&code, op_aaload, -1);
+        code_op_u2 (&code, op_invokevirtual,
+                    cp_methodref (cf, vector, "addElement",
+                                  "(Ljava/lang/Object;)V"),
+                    -2);
+        code_label (&code, &l_next);
+        bytebuf_u1 (&code.bytes, op_iinc);
+        bytebuf_u1 (&code.bytes, 2);
+        bytebuf_u1 (&code.bytes, 2);
+        code_branch (&code, op_goto, &l_loop, 0);
+        code_label (&code, &l_end);
+        code_local (&code, op_aload, 1, 1);
+        code_op_u2 (&code, op_invokevirtual,
+                    cp_methodref (cf, vector, "elements",
+                                  "()Ljava/util/Enumeration;"),
+                    0);
+        code_op (&code, op_areturn, -1);
+        class_add_method (cf, ACC_PUBLIC, "getKeys",
+                          "()Ljava/util/Enumeration;", &code, 3);
+      }
+
+      free (table_items);
+    }
+  else
+    {
+      const char *hashtable = "java/util/Hashtable";
+
+      /* Java 1.1.x uses a different hash function.  If compatibility with
+         this Java version is required, the hash table must be built at run
+         time, not at compile time.  */
+      table_descriptor = "Ljava/util/Hashtable;";
+      class_add_field (cf, ACC_PRIVATE | ACC_STATIC | ACC_FINAL, "table",
+                       table_descriptor);
+      table_ref = cp_fieldref (cf, cf->this_name, "table", table_descriptor);
+
+      code_init (&code, cf);
+      code_op_u2 (&code, op_new, cp_class (cf, hashtable), 1);
+      code_op (&code, op_dup, 1);
+      code_op_u2 (&code, op_invokespecial,
+                  cp_methodref (cf, hashtable, "<init>", "()V"), -1);
+      code_op (&code, op_dup, 1);
+      code_local (&code, op_astore, 0, -1);
+      class_add_table_init (cf, &code, table_descriptor,
+                            java1_init_item, mlp, mlp->nitems);
+      code_op_u2 (&code, op_putstatic, table_ref, -1);
+      code_op (&code, op_return, 0);
+      class_add_method (cf, ACC_STATIC, "<clinit>", "()V", &code, 1);
+
+      /* The msgid_plural strings.  Only used by msgunfmt.  */
+      if (plurals)
+        {
+          code_init (&code, cf);
+          code_op_u2 (&code, op_new, cp_class (cf, hashtable), 1);
+          code_op (&code, op_dup, 1);
+          code_op_u2 (&code, op_invokespecial,
+                      cp_methodref (cf, hashtable, "<init>", "()V"), -1);
+          for (j = 0; j < mlp->nitems; j++)
+            if (mlp->item[j]->msgid_plural != NULL)
+              {
+                code_op (&code, op_dup, 1);
+                code_msgid (&code, mlp->item[j]);
+                code_string (&code, mlp->item[j]->msgid_plural);
+                code_op_u2 (&code, op_invokevirtual,
+                            cp_methodref (cf, hashtable, "put",
+                                          "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;"),
+                            -2);
+                code_op (&code, op_pop, -1);
+              }
+          code_op (&code, op_areturn, -1);
+          class_add_method (cf, ACC_PUBLIC | ACC_STATIC | ACC_FINAL,
+                            "get_msgid_plural_table",
+                            "()Ljava/util/Hashtable;", &code, 0);
+        }
+
+      /* The lookup function, or the handleGetObject function.  */
+      code_init (&code, cf);
+      code_op_u2 (&code, op_getstatic, table_ref, 1);
+      code_local (&code, op_aload, 1, 1);
+      code_op_u2 (&code, op_invokevirtual,
+                  cp_methodref (cf, hashtable, "get",
+                                "(Ljava/lang/Object;)Ljava/lang/Object;"),
+                  -1);
+      code_op (&code, op_areturn, -1);
+      class_add_method (cf, ACC_PUBLIC,
+                        plurals ? "lookup" : "handleGetObject",
+                        "(Ljava/lang/String;)Ljava/lang/Object;", &code, 2);
+
+      /* The getKeys function.  */
+      code_init (&code, cf);
+      code_op_u2 (&code, op_getstatic, table_ref, 1);
+      code_op_u2 (&code, op_invokevirtual,
+                  cp_methodref (cf, hashtable, "keys",
+                                "()Ljava/util/Enumeration;"),
+                  0);
+      code_op (&code, op_areturn, -1);
+      class_add_method (cf, ACC_PUBLIC, "getKeys", "()Ljava/util/Enumeration;",
+                        &code, 1);
+    }
+
+  if (plurals)
+    {
+      const char *string_array = "[Ljava/lang/String;";
+      message_ty *header_entry;
+      const struct expression *plural;
+      unsigned long int nplurals;
+      struct label l_single;
+
+      /* The handleGetObject function, on top of the lookup function.  */
+      label_init (&l_single);
+      code_init (&code, cf);
+      code_op (&code, op_aload_0, 1);
+      code_local (&code, op_aload, 1, 1);
+      code_op_u2 (&code, op_invokevirtual,
+                  cp_methodref (cf, cf->this_name, "lookup",
+                                "(Ljava/lang/String;)Ljava/lang/Object;"),
+                  -1);
+      code_local (&code, op_astore, 2, -1);
+      code_local (&code, op_aload, 2, 1);
+      code_op_u2 (&code, op_instanceof, cp_class (cf, string_array), 0);
+      code_branch (&code, op_ifeq, &l_single, -1);
+      code_local (&code, op_aload, 2, 1);
+      code_op_u2 (&code, op_checkcast, cp_class (cf, string_array), 0);
+      code_op (&code, op_iconst_0, 1);
+      code_op (&code, op_aaload, -1);
+      code_op (&code, op_areturn, -1);
+      code_label (&code, &l_single);
+      code_local (&code, op_aload, 2, 1);
+      code_op (&code, op_areturn, -1);
+      class_add_method (cf, ACC_PUBLIC, "handleGetObject",
+                        "(Ljava/lang/String;)Ljava/lang/Object;", &code, 3);
+
+      /* The pluralEval function.  */
+      header_entry = message_list_search (mlp, NULL, "");
+      extract_plural_expression (header_entry ? header_entry->msgstr : NULL,
+                                 &plural, &nplurals);
+
+      code_init (&code, cf);
+      code_expression (&code, plural, false);
+      code_op (&code, op_lreturn, -2);
+      class_add_method (cf, ACC_PUBLIC | ACC_STATIC, "pluralEval", "(J)J",
+                        &code, 2);
+    }
+
+  /* The getParent function.  */
+  code_init (&code, cf);
+  code_op (&code, op_aload_0, 1);
+  code_op_u2 (&code, op_getfield,
+              cp_fieldref (cf, cf->this_name, "parent",
+                           "Ljava/util/ResourceBundle;"),
+              0);
+  code_op (&code, op_areturn, -1);
+  class_add_method (cf, ACC_PUBLIC, "getParent", "()Ljava/util/ResourceBundle;",
+                    &code, 1);
+}
+
+
+/* Write the ResourceBundle subclass as a class file to the given stream.
+   Return false, after emitting an error message, if the messages do not
+   fit into a class file.  */
+static bool
+write_java_class (FILE *stream, const char *class_name, message_list_ty *mlp,
+                  bool assume_java2)
+{
+  struct class_file cf;
+  unsigned int this_class;
+  unsigned int super_class;
+  struct bytebuf out;
+  char *p;
+  bool ok;
+
+  bytebuf_init (&cf.constants);
+  cf.constants_count = 1;
+  hash_init (&cf.constants_map, 1000);
+  bytebuf_init (&cf.fields);
+  cf.fields_count = 0;
+  bytebuf_init (&cf.methods);
+  cf.methods_count = 0;
+  cf.this_name = xstrdup (class_name);
+  for (p = cf.this_name; *p != '\0'; p++)
+    if (*p == '.')
+      *p = '/';
+  cf.overflow = false;
+
+  this_class = cp_class (&cf, cf.this_name);
+  super_class = cp_class (&cf, "java/util/ResourceBundle");
+  build_java_class (&cf, mlp, assume_java2);
+
+  ok = !cf.overflow;
+  if (ok)
+    {
+      bytebuf_init (&out);
+      bytebuf_u4 (&out, 0xcafebabe);
+      bytebuf_u2 (&out, 0);  /* minor_version */
+      bytebuf_u2 (&out, 49); /* major_version */
+      bytebuf_u2 (&out, cf.constants_count);
+      bytebuf_append (&out, cf.constants.data, cf.constants.length);
+      bytebuf_u2 (&out, ACC_PUBLIC | ACC_SUPER);
+      bytebuf_u2 (&out, this_class);
+      bytebuf_u2 (&out, super_class);
+      bytebuf_u2 (&out, 0);  /* interfaces_count */
+      bytebuf_u2 (&out, cf.fields_count);
+      bytebuf_append (&out, cf.fields.data, cf.fields.length);
+      bytebuf_u2 (&out, cf.methods_count);
+      bytebuf_append (&out, cf.methods.data, cf.methods.length);
+      bytebuf_u2 (&out, 0);  /* attributes_count */
+      fwrite (out.data, 1, out.length, stream);
+      bytebuf_destroy (&out);
+    }
+  else
+    error (0, 0, _("too many messages for a Java class: %s"), class_name);
+
+  free (cf.this_name);
+  bytebuf_destroy (&cf.methods);
+  bytebuf_destroy (&cf.fields);
+  hash_destroy (&cf.constants_map);
+  bytebuf_destroy (&cf.constants);
+  return ok;
+}
+
+
 int
 msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
                       const char *resource_name, const char *locale_name,
                       const char *directory,
                       bool assume_java2,
-                      bool output_source)
+                      bool output_source,
+                      bool output_class_directly)
 {
   int retval;
   struct temp_dir *tmpdir;
   int ndots;
   char *class_name;
   char **subdirs;
-  char *java_file_name;
-  FILE *java_file;
+  char *file_name;
+  FILE *file;
   const char *java_sources[1];
-  const char *source_dir_name;
+  const char *base_dir_name;
+  bool compile;
 
   /* If no entry for this resource/domain, don't even create the file.  */
   if (mlp->nitems == 0)
@@ -1071,18 +2471,21 @@ msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
      between builds in the same conditions.  */
   message_list_delete_header_field (mlp, "POT-Creation-Date:");
 
-  if (output_source)
-    {
-      tmpdir = NULL;
-      source_dir_name = directory;
-    }
-  else
+  /* Unless OUTPUT_SOURCE or OUTPUT_CLASS_DIRECTLY, the Java file is written
+     in a temporary directory and then compiled.  */
+  compile = !output_source && !output_class_directly;
+  if (compile)
     {
       /* Create a temporary directory where we can put the Java file.  */
       tmpdir = create_temp_dir ("msg", NULL, false);
       if (tmpdir == NULL)
         goto quit1;
-      source_dir_name = tmpdir->dir_name;
+      base_dir_name = tmpdir->dir_name;
+    }
+  else
+    {
+      tmpdir = NULL;
+      base_dir_name = directory;
     }
 
   /* Assign a default value to the resource name.  */
@@ -1104,11 +2507,12 @@ msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
 
   subdirs = (ndots > 0 ? (char **) xmalloca (ndots * sizeof (char *)) : NULL);
   {
+    const char *extension = (output_class_directly ? ".class" : ".java");
     const char *p;
     const char *last_dir;
     int i;
 
-    last_dir = source_dir_name;
+    last_dir = base_dir_name;
     p = resource_name;
     for (i = 0; i < ndots; i++)
       {
@@ -1125,41 +2529,51 @@ msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
 
     if (locale_name != NULL)
       {
-        char *suffix = xasprintf ("_%s.java", locale_name);
-        java_file_name = xconcatenated_filename (last_dir, p, suffix);
+        char *suffix = xasprintf ("_%s%s", locale_name, extension);
+        file_name = xconcatenated_filename (last_dir, p, suffix);
         free (suffix);
       }
     else
-      java_file_name = xconcatenated_filename (last_dir, p, ".java");
+      file_name = xconcatenated_filename (last_dir, p, extension);
   }
 
-  /* If OUTPUT_SOURCE, write the Java file in DIRECTORY and return.  */
-  if (output_source)
+  /* If OUTPUT_SOURCE, write the Java file in DIRECTORY and return.
+     If OUTPUT_CLASS_DIRECTLY, write the class file in the directory
+     hierarchy under DIRECTORY, where the Java class loader looks for it,
+     and return.  */
+  if (!compile)
     {
       int i;
 
       for (i = 0; i < ndots; i++)
         {
-          if (mkdir (subdirs[i], S_IRUSR | S_IWUSR | S_IXUSR) < 0)
+          if (mkdir (subdirs[i], S_IRWXU | S_IRWXG | S_IRWXO) < 0
+              && !(errno == EEXIST && output_class_directly))
             {
               error (0, errno, _("failed to create \"%s\""), subdirs[i]);
               goto quit3;
             }
         }
 
-      java_file = fopen (java_file_name, "w");
-      if (java_file == NULL)
+      file = fopen (file_name, output_class_directly ? "wb" : "w");
+      if (file == NULL)
         {
-          error (0, errno, _("failed to create \"%s\""), java_file_name);
+          error (0, errno, _("failed to create \"%s\""), file_name);
           goto quit3;
         }
 
-      write_java_code (java_file, class_name, mlp, assume_java2);
+      if (!output_class_directly)
+        write_java_code (file, class_name, mlp, assume_java2);
+      else if (!write_java_class (file, class_name, mlp, assume_java2))
+        {
+          fclose (file);
+          unlink (file_name);
+          goto quit3;
+        }
 
-      if (fwriteerror (java_file))
+      if (fwriteerror (file))
         {
-          error (0, errno, _("error while writing \"%s\" file"),
-                 java_file_name);
+          error (0, errno, _("error while writing \"%s\" file"), file_name);
           goto quit3;
         }
 
@@ -1186,20 +2600,20 @@ msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
   }
 
   /* Create the Java file.  */
-  register_temp_file (tmpdir, java_file_name);
-  java_file = fopen_temp (java_file_name, "w", false);
-  if (java_file == NULL)
+  register_temp_file (tmpdir, file_name);
+  file = fopen_temp (file_name, "w", false);
+  if (file == NULL)
     {
-      error (0, errno, _("failed to create \"%s\""), java_file_name);
-      unregister_temp_file (tmpdir, java_file_name);
+      error (0, errno, _("failed to create \"%s\""), file_name);
+      unregister_temp_file (tmpdir, file_name);
       goto quit3;
     }
 
-  write_java_code (java_file, class_name, mlp, assume_java2);
+  write_java_code (file, class_name, mlp, assume_java2);
 
-  if (fwriteerror_temp (java_file))
+  if (fwriteerror_temp (file))
     {
-      error (0, errno, _("error while writing \"%s\" file"), java_file_name);
+      error (0, errno, _("error while writing \"%s\" file"), file_name);
       goto quit3;
     }
 
@@ -1207,7 +2621,7 @@ msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
      directory must be non-NULL, because when the -d option is omitted, the
      Java compilers create the class files in the source file's directory -
      which is in a temporary directory in our case.  */
-  java_sources[0] = java_file_name;
+  java_sources[0] = file_name;
   if (compile_java_class (java_sources, 1, NULL, 0, "1.5", "1.6", directory,
                           true, false, true, verbose > 0))
     {
@@ -1225,7 +2639,7 @@ msgdomain_write_java (message_list_ty *mlp, const char *canon_encoding,
  quit3:
   {
     int i;
-    free (java_file_name);
+    free (file_name);
     for (i = 0; i < ndots; i++)
       free (subdirs[i]);
   }
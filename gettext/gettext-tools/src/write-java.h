@@ -26,6 +26,9 @@
    messages to be output.  resource_name is the name of the resource
    (with dot separators), locale_name is the locale name (with underscore
    separators) or NULL, directory is the base directory.
+   If output_source, a .java file is written.  Otherwise, if
+   output_class_directly, the .class file is written without a Java
+   compiler.  Otherwise a .java file is compiled with a Java compiler.
    Return 0 if ok, nonzero on error.  */
 extern int
        msgdomain_write_java (message_list_ty *mlp,
@@ -34,6 +37,7 @@ extern int
                              const char *locale_name,
                              const char *directory,
                              bool assume_java2,
-                             bool output_source);
+                             bool output_source,
+                             bool output_class_directly);
 
 #endif /* _WRITE_JAVA_H */
@@ -18,7 +18,6 @@
 #ifdef HAVE_CONFIG_H
 # include <config.h>
 #endif
-#include <alloca.h>
 
 /* Specification.  */
 #include "write-mo.h"
@@ -75,6 +74,12 @@ bool byteswap;
 /* True if no hash table in .mo is wanted.  */
 bool no_hash_table;
 
+/* True if a perfect hash table in .mo is wanted.  */
+bool perfect_hash_table;
+
+/* True if a Bloom filter in .mo is wanted.  */
+bool bloom_filter;
+
 
 /* Destructively changes the byte order of a 32-bit value in memory.  */
 #define BSWAP32(x) (x) = bswap_32 (x)
@@ -103,11 +108,89 @@ struct pre_message
   size_t id_plural_len;
 };
 
-static int
-compare_id (const void *pval1, const void *pval2)
+/* Sorts the N static string pairs in ARR according to the original string,
+   in the order defined by strcmp.  All original strings in ARR are known to
+   agree in their first DEPTH bytes.
+   This is a multikey quicksort (Bentley & Sedgewick): each partitioning step
+   looks at a single byte only, instead of comparing the strings from the
+   start again as qsort with strcmp would do.  This matters for large catalogs
+   whose msgids share long common prefixes.  */
+static void
+sort_by_id (struct pre_message *arr, size_t n, size_t depth)
 {
-  return strcmp (((struct pre_message *) pval1)->str[M_ID].pointer,
-                 ((struct pre_message *) pval2)->str[M_ID].pointer);
+#define ID_BYTE(i) ((unsigned char) arr[i].str[M_ID].pointer[depth])
+  while (n > 1)
+    {
+      struct pre_message tmp;
+      size_t lt, gt, i;
+      unsigned int pivot;
+
+      if (n < 8)
+        {
+          /* Insertion sort for small partitions.  */
+          for (i = 1; i < n; i++)
+            {
+              size_t k;
+
+              tmp = arr[i];
+              for (k = i;
+                   k > 0
+                   && strcmp (arr[k - 1].str[M_ID].pointer + depth,
+                              tmp.str[M_ID].pointer + depth) > 0;
+                   k--)
+                arr[k] = arr[k - 1];
+              arr[k] = tmp;
+            }
+          return;
+        }
+
+      /* Median of three, as pivot byte.  */
+      {
+        unsigned int a = ID_BYTE (0);
+        unsigned int b = ID_BYTE (n / 2);
+        unsigned int c = ID_BYTE (n - 1);
+
+        pivot = (a < b
+                 ? (b < c ? b : a < c ? c : a)
+                 : (a < c ? a : b < c ? c : b));
+      }
+
+      /* Three-way partitioning:
+         arr[0..lt-1] < pivot, arr[lt..gt-1] == pivot, arr[gt..n-1] > pivot.  */
+      lt = 0;
+      gt = n;
+      i = 0;
+      while (i < gt)
+        {
+          unsigned int c = ID_BYTE (i);
+
+          if (c < pivot)
+            {
+              tmp = arr[lt]; arr[lt] = arr[i]; arr[i] = tmp;
+              lt++;
+              i++;
+            }
+          else if (c > pivot)
+            {
+              gt--;
+              tmp = arr[gt]; arr[gt] = arr[i]; arr[i] = tmp;
+            }
+          else
+            i++;
+        }
+
+      sort_by_id (arr, lt, depth);
+      sort_by_id (arr + gt, n - gt, depth);
+
+      /* The strings in the middle partition agree in one more byte.  If that
+         byte is the terminating NUL, they are all equal.  */
+      if (pivot == 0)
+        return;
+      arr += lt;
+      n = gt - lt;
+      depth++;
+    }
+#undef ID_BYTE
 }
 
 
@@ -142,6 +225,188 @@ struct pre_sysdep_message
   size_t id_plural_len;
 };
 
+/* A memory buffer into which the contents of the .mo file is assembled,
+   so that it can be written out at once, instead of through thousands of
+   small fwrite calls.  */
+struct mo_image
+{
+  char *data;
+  size_t length;
+  size_t allocated;
+};
+
+/* Appends LENGTH bytes from DATA to IMAGE.  If DATA is NULL, appends
+   LENGTH NUL bytes.  */
+static void
+image_append (struct mo_image *image, const void *data, size_t length)
+{
+  if (image->length + length > image->allocated)
+    {
+      size_t new_allocated =
+        xmax (xsum (image->length, length), xtimes (image->allocated, 2));
+
+      image->data = (char *) xrealloc (image->data, new_allocated);
+      image->allocated = new_allocated;
+    }
+  if (data != NULL)
+    memcpy (image->data + image->length, data, length);
+  else
+    memset (image->data + image->length, '\0', length);
+  image->length += length;
+}
+
+/* Builds a minimal perfect hash table for the N static string pairs in ARR,
+   with NBUCKETS buckets.  Stores the displacement value of each bucket in
+   BUCKETS and the N table entries in TAB.  Returns false if no suitable
+   displacement value was found for some bucket.
+   This is the "hash and displace" construction (Belazzougui, Botelho,
+   Dietzfelbinger): a string with hash values hval1, hval2 belongs to the
+   bucket hval2 % NBUCKETS, and is placed at the table index
+   hash_string_slot (hval1, disp, N), where disp is the displacement value of
+   the bucket.  The buckets are processed by decreasing size, and for each
+   bucket the smallest disp is chosen that maps its strings to free indices.  */
+static bool
+build_perfect_hash (const struct pre_message *arr, size_t n,
+                    size_t nbuckets, nls_uint32 *buckets,
+                    struct phash_entry *tab)
+{
+  unsigned long int *hval1 = XNMALLOC (n, unsigned long int);
+  unsigned long int *hval2 = XNMALLOC (n, unsigned long int);
+  /* The strings of bucket b are
+     members[bucket_start[b]..bucket_start[b+1]-1].  */
+  size_t *bucket_start = XCALLOC (nbuckets + 1, size_t);
+  size_t *members = XNMALLOC (n, size_t);
+  /* The buckets, sorted by decreasing size.  */
+  size_t *order = XNMALLOC (nbuckets, size_t);
+  size_t *size_start;
+  size_t *slots;
+  char *taken = XCALLOC (n, char);
+  size_t max_size;
+  unsigned long int max_disp;
+  bool ok;
+  size_t i, b, k;
+
+  for (i = 0; i < n; i++)
+    hash_string_pair (arr[i].str[M_ID].pointer, &hval1[i], &hval2[i]);
+
+  /* Distribute the strings into the buckets.  */
+  for (i = 0; i < n; i++)
+    bucket_start[hval2[i] % nbuckets + 1]++;
+  max_size = 0;
+  for (b = 0; b < nbuckets; b++)
+    {
+      if (max_size < bucket_start[b + 1])
+        max_size = bucket_start[b + 1];
+      bucket_start[b + 1] += bucket_start[b];
+    }
+  for (b = 0; b < nbuckets; b++)
+    order[b] = bucket_start[b];
+  for (i = 0; i < n; i++)
+    members[order[hval2[i] % nbuckets]++] = i;
+
+  /* Sort the buckets by decreasing size.  */
+  size_start = XCALLOC (max_size + 2, size_t);
+  for (b = 0; b < nbuckets; b++)
+    size_start[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1]++;
+  for (k = 0; k <= max_size; k++)
+    size_start[k + 1] += size_start[k];
+  for (b = 0; b < nbuckets; b++)
+    order[size_start[max_size - (bucket_start[b + 1] - bucket_start[b])]++] =
+      b;
+  free (size_start);
+
+  /* When the table is nearly full, a bucket with a single string needs about
+     N attempts.  Give up after many more attempts than that; it means that
+     two strings in the same bucket have the same hash values.  */
+  max_disp = (n < 0x3ffffff ? 64 * (unsigned long int) n + 1024 : 0xffffffffUL);
+
+  slots = XNMALLOC (max_size, size_t);
+  ok = true;
+  for (k = 0; k < nbuckets; k++)
+    {
+      size_t start, size;
+      unsigned long int disp;
+
+      b = order[k];
+      start = bucket_start[b];
+      size = bucket_start[b + 1] - start;
+
+      for (disp = 0; ; disp++)
+        {
+          size_t m;
+
+          if (disp > max_disp)
+            {
+              ok = false;
+              goto done;
+            }
+          for (m = 0; m < size; m++)
+            {
+              size_t slot =
+                hash_string_slot (hval1[members[start + m]], disp, n);
+
+              if (taken[slot])
+                break;
+              taken[slot] = 1;
+              slots[m] = slot;
+            }
+          if (m == size)
+            break;
+          /* Undo the tentative assignment.  */
+          while (m > 0)
+            taken[slots[--m]] = 0;
+        }
+
+      buckets[b] = disp;
+      for (i = 0; i < size; i++)
+        {
+          tab[slots[i]].hash = hval2[members[start + i]];
+          tab[slots[i]].index = members[start + i];
+        }
+    }
+ done:
+
+  free (slots);
+  free (taken);
+  free (order);
+  free (members);
+  free (bucket_start);
+  free (hval2);
+  free (hval1);
+  return ok;
+}
+
+/* Builds a Bloom filter with NBLOCKS blocks for the N static string pairs in
+   ARR, following the rule described in gmo.h, and stores it in BLOOM.  */
+static void
+build_bloom_filter (const struct pre_message *arr, size_t n,
+                    size_t nblocks, nls_uint32 *bloom)
+{
+  size_t i;
+
+  memset (bloom, '\0', nblocks * (MO_BLOOM_BLOCK_BITS / 8));
+  for (i = 0; i < n; i++)
+    {
+      unsigned long int hval1, hval2;
+      nls_uint32 *block;
+      unsigned long int step;
+      unsigned long int bit;
+      int k;
+
+      hash_string_pair (arr[i].str[M_ID].pointer, &hval1, &hval2);
+      block = bloom + (hval1 % nblocks) * (MO_BLOOM_BLOCK_BITS / 32);
+      step = hash_string_bloom_step (hval2);
+      bit = hval2;
+      for (k = 0; k < MO_BLOOM_NBITS; k++)
+        {
+          nls_uint32 pos = bit % MO_BLOOM_BLOCK_BITS;
+
+          block[pos / 32] |= (nls_uint32) 1 << (pos % 32);
+          bit = (bit + step) & 0xffffffffUL;
+        }
+    }
+}
+
 /* Write the message list to the given open file.  */
 static void
 write_table (FILE *output_file, message_list_ty *mlp)
@@ -158,6 +423,12 @@ write_table (FILE *output_file, message_list_ty *mlp)
   int minor_revision;
   bool omit_hash_table;
   nls_uint32 hash_tab_size;
+  size_t n_phash_buckets;
+  nls_uint32 *phash_buckets;
+  struct phash_entry *phash_tab;
+  size_t phash_tab_size;
+  size_t n_bloom_blocks;
+  nls_uint32 *bloom;
   struct mo_file_header header; /* Header of the .mo file to be written.  */
   size_t header_size;
   size_t offset;
@@ -165,7 +436,8 @@ write_table (FILE *output_file, message_list_ty *mlp)
   struct string_desc *trans_tab;
   size_t sysdep_tab_offset = 0;
   size_t end_offset;
-  char *null;
+  struct mo_image image;
+  size_t strings_size;
   size_t j, m;
 
   /* First pass: Move the static string pairs into an array, for sorting,
@@ -366,8 +638,7 @@ write_table (FILE *output_file, message_list_ty *mlp)
     }
 
   /* Sort the table according to original string.  */
-  if (nstrings > 0)
-    qsort (msg_arr, nstrings, sizeof (struct pre_message), compare_id);
+  sort_by_id (msg_arr, nstrings, 0);
 
   /* We need major revision 1 if there are system dependent strings that use
      "I" because older versions of gettext() crash when this occurs in a .mo
@@ -375,10 +646,55 @@ write_table (FILE *output_file, message_list_ty *mlp)
   major_revision =
     (have_outdigits ? MO_REVISION_NUMBER_WITH_SYSDEP_I : MO_REVISION_NUMBER);
 
-  /* We need minor revision 1 if there are system dependent strings.
+  /* Build the perfect hash table, if requested.  Its lookup rule does not
+     cover the system dependent strings, which are only known at run time.  */
+  n_phash_buckets = 0;
+  phash_buckets = NULL;
+  phash_tab = NULL;
+  if (perfect_hash_table && n_sysdep_strings == 0 && nstrings > 0)
+    {
+      /* With 4 strings per bucket on average, the construction is fast, and
+         the buckets table takes 1 byte per string.  */
+      n_phash_buckets = nstrings / 4 + 1;
+      phash_buckets = XNMALLOC (n_phash_buckets, nls_uint32);
+      phash_tab = XNMALLOC (nstrings, struct phash_entry);
+      if (!build_perfect_hash (msg_arr, nstrings, n_phash_buckets,
+                               phash_buckets, phash_tab))
+        {
+          error (0, 0, _("warning: could not build a perfect hash table; "
+                         "omitting it"));
+          free (phash_tab);
+          free (phash_buckets);
+          n_phash_buckets = 0;
+          phash_buckets = NULL;
+          phash_tab = NULL;
+        }
+    }
+  phash_tab_size = (n_phash_buckets > 0 ? nstrings : 0);
+
+  /* Build the Bloom filter, if requested.  Like the perfect hash table, it
+     cannot describe the system dependent strings.  */
+  n_bloom_blocks = 0;
+  bloom = NULL;
+  if (bloom_filter && n_sysdep_strings == 0)
+    {
+      /* With 12 bits per string and 6 bits set per string, about 2% of the
+         strings that are not in the catalog pass the filter.  */
+      n_bloom_blocks = (nstrings * 12) / MO_BLOOM_BLOCK_BITS + 1;
+      bloom = XNMALLOC (n_bloom_blocks * (MO_BLOOM_BLOCK_BITS / 32),
+                        nls_uint32);
+      build_bloom_filter (msg_arr, nstrings, n_bloom_blocks, bloom);
+    }
+
+  /* We need minor revision 3 if there is a Bloom filter, minor revision 2 if
+     there is a perfect hash table, and minor revision 1 if there are system
+     dependent strings.
      Otherwise we choose minor revision 0 because it's supported by older
      versions of libintl and revision 1 isn't.  */
-  minor_revision = (n_sysdep_strings > 0 ? 1 : 0);
+  minor_revision =
+    (n_bloom_blocks > 0 ? 3 :
+     n_phash_buckets > 0 ? 2 :
+     n_sysdep_strings > 0 ? 1 : 0);
 
   /* In minor revision >= 1, the hash table is obligatory.  */
   omit_hash_table = (no_hash_table && minor_revision == 0);
@@ -425,6 +741,10 @@ write_table (FILE *output_file, message_list_ty *mlp)
   header_size =
     (minor_revision == 0
      ? offsetof (struct mo_file_header, n_sysdep_segments)
+     : minor_revision == 1
+     ? offsetof (struct mo_file_header, n_phash_buckets)
+     : minor_revision == 2
+     ? offsetof (struct mo_file_header, n_bloom_blocks)
      : sizeof (struct mo_file_header));
   offset = header_size;
 
@@ -475,8 +795,43 @@ write_table (FILE *output_file, message_list_ty *mlp)
                       * sizeof (struct segment_pair);
     }
 
+  if (minor_revision >= 2)
+    {
+      /* Number of buckets of the perfect hash table.  */
+      header.n_phash_buckets = n_phash_buckets;
+
+      /* Offset of table with the displacement values of the buckets.  */
+      header.phash_buckets_offset = offset;
+      offset += n_phash_buckets * sizeof (nls_uint32);
+
+      /* Offset of the perfect hash table.  */
+      header.phash_tab_offset = offset;
+      offset += phash_tab_size * sizeof (struct phash_entry);
+    }
+
+  if (minor_revision >= 3)
+    {
+      /* Number of blocks of the Bloom filter.  */
+      header.n_bloom_blocks = n_bloom_blocks;
+
+      /* Offset of the Bloom filter.  */
+      header.bloom_offset = offset;
+      offset += n_bloom_blocks * (MO_BLOOM_BLOCK_BITS / 8);
+    }
+
   end_offset = offset;
 
+  /* Allocate the image of the file.  The size of the strings part is known
+     up to the alignment padding.  */
+  strings_size = 0;
+  for (j = 0; j < nstrings; j++)
+    strings_size +=
+      msg_arr[j].str[M_ID].length + msg_arr[j].id_plural_len
+      + msg_arr[j].str[M_STR].length + 2 * alignment;
+  image.length = 0;
+  image.allocated = xsum (end_offset, strings_size);
+  image.data = XNMALLOC (image.allocated, char);
+
 
   /* Third pass: Write the non-string parts of the file.  At the same time,
      compute the offsets of each string, including the proper alignment.  */
@@ -499,8 +854,19 @@ write_table (FILE *output_file, message_list_ty *mlp)
           BSWAP32 (header.orig_sysdep_tab_offset);
           BSWAP32 (header.trans_sysdep_tab_offset);
         }
+      if (minor_revision >= 2)
+        {
+          BSWAP32 (header.n_phash_buckets);
+          BSWAP32 (header.phash_buckets_offset);
+          BSWAP32 (header.phash_tab_offset);
+        }
+      if (minor_revision >= 3)
+        {
+          BSWAP32 (header.n_bloom_blocks);
+          BSWAP32 (header.bloom_offset);
+        }
     }
-  fwrite (&header, header_size, 1, output_file);
+  image_append (&image, &header, header_size);
 
   /* Table for original string offsets.  */
   /* Here output_file is at position header.orig_tab_offset.  */
@@ -521,7 +887,7 @@ write_table (FILE *output_file, message_list_ty *mlp)
         BSWAP32 (orig_tab[j].length);
         BSWAP32 (orig_tab[j].offset);
       }
-  fwrite (orig_tab, nstrings * sizeof (struct string_desc), 1, output_file);
+  image_append (&image, orig_tab, nstrings * sizeof (struct string_desc));
 
   /* Table for translated string offsets.  */
   /* Here output_file is at position header.trans_tab_offset.  */
@@ -541,7 +907,7 @@ write_table (FILE *output_file, message_list_ty *mlp)
         BSWAP32 (trans_tab[j].length);
         BSWAP32 (trans_tab[j].offset);
       }
-  fwrite (trans_tab, nstrings * sizeof (struct string_desc), 1, output_file);
+  image_append (&image, trans_tab, nstrings * sizeof (struct string_desc));
 
   /* Skip this part when no hash table is needed.  */
   if (!omit_hash_table)
@@ -582,7 +948,7 @@ write_table (FILE *output_file, message_list_ty *mlp)
       if (byteswap)
         for (j = 0; j < hash_tab_size; j++)
           BSWAP32 (hash_tab[j]);
-      fwrite (hash_tab, hash_tab_size * sizeof (nls_uint32), 1, output_file);
+      image_append (&image, hash_tab, hash_tab_size * sizeof (nls_uint32));
 
       free (hash_tab);
     }
@@ -613,9 +979,8 @@ write_table (FILE *output_file, message_list_ty *mlp)
             BSWAP32 (sysdep_segments_tab[i].length);
             BSWAP32 (sysdep_segments_tab[i].offset);
           }
-      fwrite (sysdep_segments_tab,
-              n_sysdep_segments * sizeof (struct sysdep_segment), 1,
-              output_file);
+      image_append (&image, sysdep_segments_tab,
+                    n_sysdep_segments * sizeof (struct sysdep_segment));
 
       free (sysdep_segments_tab);
 
@@ -639,8 +1004,8 @@ write_table (FILE *output_file, message_list_ty *mlp)
           if (byteswap)
             for (j = 0; j < n_sysdep_strings; j++)
               BSWAP32 (sysdep_tab[j]);
-          fwrite (sysdep_tab, n_sysdep_strings * sizeof (nls_uint32), 1,
-                  output_file);
+          image_append (&image, sysdep_tab,
+                        n_sysdep_strings * sizeof (nls_uint32));
         }
 
       free (sysdep_tab);
@@ -680,15 +1045,49 @@ write_table (FILE *output_file, message_list_ty *mlp)
                     BSWAP32 (str->segments[i].sysdepref);
                   }
               }
-            fwrite (str,
-                    sizeof (struct sysdep_string)
-                    + pre->segmentcount * sizeof (struct segment_pair),
-                    1, output_file);
+            image_append (&image, str,
+                          sizeof (struct sysdep_string)
+                          + pre->segmentcount * sizeof (struct segment_pair));
 
             freea (str);
           }
     }
 
+  if (minor_revision >= 2)
+    {
+      /* Here output_file is at position header.phash_buckets_offset.  */
+
+      if (byteswap)
+        {
+          for (j = 0; j < n_phash_buckets; j++)
+            BSWAP32 (phash_buckets[j]);
+          for (j = 0; j < phash_tab_size; j++)
+            {
+              BSWAP32 (phash_tab[j].hash);
+              BSWAP32 (phash_tab[j].index);
+            }
+        }
+      image_append (&image, phash_buckets,
+                    n_phash_buckets * sizeof (nls_uint32));
+      image_append (&image, phash_tab,
+                    phash_tab_size * sizeof (struct phash_entry));
+
+      free (phash_tab);
+      free (phash_buckets);
+    }
+
+  if (minor_revision >= 3)
+    {
+      /* Here output_file is at position header.bloom_offset.  */
+
+      if (byteswap)
+        for (j = 0; j < n_bloom_blocks * (MO_BLOOM_BLOCK_BITS / 32); j++)
+          BSWAP32 (bloom[j]);
+      image_append (&image, bloom, n_bloom_blocks * (MO_BLOOM_BLOCK_BITS / 8));
+
+      free (bloom);
+    }
+
   /* Here output_file is at position end_offset.  */
 
   free (trans_tab);
@@ -699,32 +1098,27 @@ write_table (FILE *output_file, message_list_ty *mlp)
 
   offset = end_offset;
 
-  /* A few zero bytes for padding.  */
-  null = (char *) alloca (alignment);
-  memset (null, '\0', alignment);
-
   /* Now write the original strings.  */
   for (j = 0; j < nstrings; j++)
     {
-      fwrite (null, roundup (offset, alignment) - offset, 1, output_file);
+      image_append (&image, NULL, roundup (offset, alignment) - offset);
       offset = roundup (offset, alignment);
 
-      fwrite (msg_arr[j].str[M_ID].pointer, msg_arr[j].str[M_ID].length, 1,
-              output_file);
+      image_append (&image, msg_arr[j].str[M_ID].pointer,
+                    msg_arr[j].str[M_ID].length);
       if (msg_arr[j].id_plural_len > 0)
-        fwrite (msg_arr[j].id_plural, msg_arr[j].id_plural_len, 1,
-                output_file);
+        image_append (&image, msg_arr[j].id_plural, msg_arr[j].id_plural_len);
       offset += msg_arr[j].str[M_ID].length + msg_arr[j].id_plural_len;
     }
 
   /* Now write the translated strings.  */
   for (j = 0; j < nstrings; j++)
     {
-      fwrite (null, roundup (offset, alignment) - offset, 1, output_file);
+      image_append (&image, NULL, roundup (offset, alignment) - offset);
       offset = roundup (offset, alignment);
 
-      fwrite (msg_arr[j].str[M_STR].pointer, msg_arr[j].str[M_STR].length, 1,
-              output_file);
+      image_append (&image, msg_arr[j].str[M_STR].pointer,
+                    msg_arr[j].str[M_STR].length);
       offset += msg_arr[j].str[M_STR].length;
     }
 
@@ -734,12 +1128,12 @@ write_table (FILE *output_file, message_list_ty *mlp)
 
       for (i = 0; i < n_sysdep_segments; i++)
         {
-          fwrite (null, roundup (offset, alignment) - offset, 1, output_file);
+          image_append (&image, NULL, roundup (offset, alignment) - offset);
           offset = roundup (offset, alignment);
 
-          fwrite (sysdep_segments[i].pointer, sysdep_segments[i].length, 1,
-                  output_file);
-          fwrite (null, 1, 1, output_file);
+          image_append (&image, sysdep_segments[i].pointer,
+                        sysdep_segments[i].length);
+          image_append (&image, NULL, 1);
           offset += sysdep_segments[i].length + 1;
         }
 
@@ -749,19 +1143,18 @@ write_table (FILE *output_file, message_list_ty *mlp)
             struct pre_sysdep_message *msg = &sysdep_msg_arr[j];
             struct pre_sysdep_string *pre = msg->str[m];
 
-            fwrite (null, roundup (offset, alignment) - offset, 1,
-                    output_file);
+            image_append (&image, NULL, roundup (offset, alignment) - offset);
             offset = roundup (offset, alignment);
 
             for (i = 0; i <= pre->segmentcount; i++)
               {
-                fwrite (pre->segments[i].segptr, pre->segments[i].segsize, 1,
-                        output_file);
+                image_append (&image, pre->segments[i].segptr,
+                              pre->segments[i].segsize);
                 offset += pre->segments[i].segsize;
               }
             if (m == M_ID && msg->id_plural_len > 0)
               {
-                fwrite (msg->id_plural, msg->id_plural_len, 1, output_file);
+                image_append (&image, msg->id_plural, msg->id_plural_len);
                 offset += msg->id_plural_len;
               }
 
@@ -769,7 +1162,10 @@ write_table (FILE *output_file, message_list_ty *mlp)
           }
     }
 
-  freea (null);
+  /* Write the assembled file contents.  */
+  fwrite (image.data, image.length, 1, output_file);
+  free (image.data);
+
   for (j = 0; j < mlp->nitems; j++)
     free (msgctid_arr[j]);
   free (sysdep_msg_arr);
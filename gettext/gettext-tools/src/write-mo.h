@@ -33,6 +33,12 @@ extern bool byteswap;
 /* True if no hash table in .mo is wanted.  */
 extern bool no_hash_table;
 
+/* True if a perfect hash table in .mo is wanted.  */
+extern bool perfect_hash_table;
+
+/* True if a Bloom filter in .mo is wanted.  */
+extern bool bloom_filter;
+
 /* Write a GNU mo file.  mlp is a list containing the messages to be output.
    domain_name is the domain name, file_name is the desired file name.
    Return 0 if ok, nonzero on error.  */
@@ -34,16 +34,22 @@
 #if HAVE_ICONV
 # include <iconv.h>
 #endif
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 #include <textstyle.h>
 
 #include "c-ctype.h"
 #include "po-charset.h"
 #include "format.h"
+#include "unistr.h"
 #include "unilbrk.h"
 #include "msgl-ascii.h"
 #include "write-catalog.h"
+#include "xsize.h"
 #include "xalloc.h"
+#include "minmax.h"
 #include "xmalloca.h"
 #include "c-strstr.h"
 #include "xvasprintf.h"
@@ -65,12 +71,13 @@
 /* Convert IS_FORMAT in the context of programming language LANG to a flag
    string for use in #, flags.  */
 
-const char *
-make_format_description_string (enum is_format is_format, const char *lang,
-                                bool debug)
+/* Stores the flag string for IS_FORMAT in the context of programming
+   language LANG in RESULT.  */
+static void
+format_description_string (char result[100],
+                           enum is_format is_format, const char *lang,
+                           bool debug)
 {
-  static char result[100];
-
   switch (is_format)
     {
     case possible:
@@ -91,7 +98,15 @@ make_format_description_string (enum is_format is_format, const char *lang,
       /* The others have already been filtered out by significant_format_p.  */
       abort ();
     }
+}
 
+const char *
+make_format_description_string (enum is_format is_format, const char *lang,
+                                bool debug)
+{
+  static char result[100];
+
+  format_description_string (result, is_format, lang, debug);
   return result;
 }
 
@@ -458,15 +473,18 @@ message_print_comment_flags (const message_ty *mp, ostream_t stream, bool debug)
       for (i = 0; i < NFORMATS; i++)
         if (significant_format_p (mp->is_format[i]))
           {
+            /* Don't use make_format_description_string here, because its
+               result buffer is shared between threads.  */
+            char description[100];
+
             if (!first_flag)
               ostream_write_str (stream, ",");
 
             ostream_write_str (stream, " ");
             begin_css_class (stream, class_flag);
-            ostream_write_str (stream,
-                               make_format_description_string (mp->is_format[i],
-                                                               format_language[i],
-                                                               debug));
+            format_description_string (description, mp->is_format[i],
+                                       format_language[i], debug);
+            ostream_write_str (stream, description);
             end_css_class (stream, class_flag);
             first_flag = false;
           }
@@ -553,6 +571,29 @@ message_print_style_filepos (enum filepos_comment_type type)
 }
 
 
+/* This variable tells whether the stream passed to msgdomain_list_print_po
+   ignores the CSS classes, so that the messages can be formatted into
+   separate memory buffers and concatenated afterwards.  */
+static bool stream_unstyled = false;
+
+void
+message_print_stream_unstyled (bool flag)
+{
+  stream_unstyled = flag;
+}
+
+
+/* This variable tells whether the program allows msgdomain_list_print_po
+   to format the messages in several threads.  */
+static bool print_parallel = false;
+
+void
+message_print_parallel (bool flag)
+{
+  print_parallel = flag;
+}
+
+
 /* --add-location argument handling.  Return an error indicator.  */
 bool
 handle_filepos_comment_option (const char *option)
@@ -612,27 +653,45 @@ memset_small (void *dst, char c, size_t n)
 }
 
 
-static void
-wrap (const message_ty *mp, ostream_t stream,
-      const char *line_prefix, int extra_indent, const char *css_class,
-      const char *name, const char *value,
-      enum is_wrap do_wrap, size_t page_width,
-      const char *charset)
+/* The state of wrap() that is kept across the strings of a catalog, so that
+   the setup is not repeated for every msgid and msgstr.  */
+struct wrap_context
 {
+  /* True if a PO file in old format, with extraneous backslashes, shall be
+     written.  */
+  bool old_po_file_output;
+  /* The canonicalized PO file encoding, or NULL if it is invalid.  */
   const char *canon_charset;
-  char *fmtdir;
-  char *fmtdirattr;
-  const char *s;
-  bool first_line;
+  /* The encoding passed to the line breaking functions.  */
+  const char *linebreak_charset;
+  /* True if multibyte characters are parsed as UTF-8.  */
+  bool utf8;
 #if HAVE_ICONV
-  const char *envval;
+  /* Otherwise, a conversion descriptor for parsing multibyte characters, or
+     (iconv_t)(-1).  */
   iconv_t conv;
 #endif
+  /* True if multibyte characters have a CJK structure.  */
   bool weird_cjk;
+  /* Scratch memory for the portion, overrides, attributes, linebreaks arrays
+     of wrap().  */
+  char *buffer;
+  size_t buffer_size;
+  /* Scratch memory for the fmtdir, fmtdirattr arrays of wrap().  */
+  char *fmt_buffer;
+  size_t fmt_buffer_size;
+  /* True if diagnostics are not reported, because the output goes to a
+     memory buffer that may be thrown away.  */
+  bool defer_diagnostics;
+  /* True if a diagnostic was suppressed because of defer_diagnostics.  */
+  bool diagnostics_deferred;
+};
 
-  canon_charset = po_charset_canonicalize (charset);
+static void
+wrap_context_init (struct wrap_context *context)
+{
+  const char *envval;
 
-#if HAVE_ICONV
   /* The old Solaris/openwin msgfmt and GNU msgfmt <= 0.10.35 don't know
      about multibyte encodings, and require a spurious backslash after
      every multibyte character whose last byte is 0x5C.  Some programs,
@@ -640,47 +699,199 @@ wrap (const message_ty *mp, ostream_t stream,
      for such programs that GNU msgmerge continues to support this old
      PO file format when the Makefile requests it.  */
   envval = getenv ("OLD_PO_FILE_OUTPUT");
-  if (envval != NULL && *envval != '\0')
+  context->old_po_file_output = (envval != NULL && *envval != '\0');
+  context->canon_charset = NULL;
+  context->linebreak_charset = po_charset_ascii;
+  context->utf8 = false;
+#if HAVE_ICONV
+  context->conv = (iconv_t)(-1);
+#endif
+  context->weird_cjk = false;
+  context->buffer = NULL;
+  context->buffer_size = 0;
+  context->fmt_buffer = NULL;
+  context->fmt_buffer_size = 0;
+  context->defer_diagnostics = false;
+  context->diagnostics_deferred = false;
+}
+
+/* Prepares CONTEXT for the strings of a catalog in the given encoding.  */
+static void
+wrap_context_set_charset (struct wrap_context *context, const char *charset)
+{
+  const char *canon_charset = po_charset_canonicalize (charset);
+
+#if HAVE_ICONV
+  if (context->conv != (iconv_t)(-1))
+    {
+      iconv_close (context->conv);
+      context->conv = (iconv_t)(-1);
+    }
+#endif
+
+  context->canon_charset = canon_charset;
+  context->utf8 = false;
+
+  if (context->old_po_file_output)
     /* Write a PO file in old format, with extraneous backslashes.  */
-    conv = (iconv_t)(-1);
+    ;
+  else if (canon_charset == NULL)
+    /* Invalid PO file encoding.  */
+    ;
+  else if (canon_charset == po_charset_utf8)
+    /* Parse UTF-8 directly, without iconv().  */
+    context->utf8 = true;
+#if HAVE_ICONV
   else
-    if (canon_charset == NULL)
-      /* Invalid PO file encoding.  */
-      conv = (iconv_t)(-1);
-    else
-      /* Avoid glibc-2.1 bug with EUC-KR.  */
+    /* Avoid glibc-2.1 bug with EUC-KR.  */
 # if ((__GLIBC__ == 2 && __GLIBC_MINOR__ <= 1) && !defined __UCLIBC__) \
      && !defined _LIBICONV_VERSION
-      if (strcmp (canon_charset, "EUC-KR") == 0)
-        conv = (iconv_t)(-1);
-      else
+    if (strcmp (canon_charset, "EUC-KR") == 0)
+      ;
+    else
 # endif
-      /* Avoid Solaris 2.9 bug with GB2312, EUC-TW, BIG5, BIG5-HKSCS, GBK,
-         GB18030.  */
+    /* Avoid Solaris 2.9 bug with GB2312, EUC-TW, BIG5, BIG5-HKSCS, GBK,
+       GB18030.  */
 # if defined __sun && !defined _LIBICONV_VERSION
-      if (   strcmp (canon_charset, "GB2312") == 0
-          || strcmp (canon_charset, "EUC-TW") == 0
-          || strcmp (canon_charset, "BIG5") == 0
-          || strcmp (canon_charset, "BIG5-HKSCS") == 0
-          || strcmp (canon_charset, "GBK") == 0
-          || strcmp (canon_charset, "GB18030") == 0)
-        conv = (iconv_t)(-1);
-      else
+    if (   strcmp (canon_charset, "GB2312") == 0
+        || strcmp (canon_charset, "EUC-TW") == 0
+        || strcmp (canon_charset, "BIG5") == 0
+        || strcmp (canon_charset, "BIG5-HKSCS") == 0
+        || strcmp (canon_charset, "GBK") == 0
+        || strcmp (canon_charset, "GB18030") == 0)
+      ;
+    else
 # endif
-      /* Use iconv() to parse multibyte characters.  */
-      conv = iconv_open ("UTF-8", canon_charset);
+    /* Use iconv() to parse multibyte characters.  */
+    context->conv = iconv_open ("UTF-8", canon_charset);
+#endif
 
-  if (conv != (iconv_t)(-1))
-    weird_cjk = false;
-  else
+  if (context->utf8
+#if HAVE_ICONV
+      || context->conv != (iconv_t)(-1)
 #endif
+     )
+    context->weird_cjk = false;
+  else
     if (canon_charset == NULL)
-      weird_cjk = false;
+      context->weird_cjk = false;
     else
-      weird_cjk = po_is_charset_weird_cjk (canon_charset);
+      context->weird_cjk = po_is_charset_weird_cjk (canon_charset);
+
+  context->linebreak_charset =
+    (canon_charset != NULL ? canon_charset : po_charset_ascii);
+}
+
+static void
+wrap_context_free (struct wrap_context *context)
+{
+#if HAVE_ICONV
+  if (context->conv != (iconv_t)(-1))
+    iconv_close (context->conv);
+#endif
+  free (context->buffer);
+  free (context->fmt_buffer);
+}
+
+/* Reports a diagnostic about MP, like po_xerror does.  When CONTEXT defers
+   diagnostics, only records that there was one.  */
+static void
+wrap_context_xerror (struct wrap_context *context, int severity,
+                     const message_ty *mp, bool multiline_p,
+                     const char *message_text)
+{
+  if (context->defer_diagnostics)
+    context->diagnostics_deferred = true;
+  else
+    po_xerror (severity, mp, NULL, 0, 0, multiline_p, message_text);
+}
+
+/* Returns true if the multibyte characters in CONTEXT need to be parsed with
+   wrap_mbclen.  */
+static inline bool
+wrap_context_multibyte (const struct wrap_context *context)
+{
+  return context->utf8
+#if HAVE_ICONV
+         || context->conv != (iconv_t)(-1)
+#endif
+         ;
+}
+
+/* Returns the length of the multibyte character that starts at EP and ends
+   at ES at the latest.  Returns -1 for an invalid multibyte sequence, or -2
+   for an incomplete multibyte sequence.  */
+static int
+wrap_mbclen (struct wrap_context *context, const char *ep, const char *es)
+{
+  if ((unsigned char) *ep < 0x80)
+    /* In all PO file encodings, this is a single-byte character.  */
+    return 1;
+
+  if (context->utf8)
+    {
+      ucs4_t uc;
+
+      return u8_mbtoucr (&uc, (const uint8_t *) ep, es - ep);
+    }
+
+#if HAVE_ICONV
+  {
+    /* Skip over a complete multi-byte character.  Don't interpret the second
+       byte of a multi-byte character as ASCII.  This is needed for the BIG5,
+       BIG5-HKSCS, GBK, GB18030, SHIFT_JIS, JOHAB encodings.  */
+    char scratchbuf[64];
+    const char *inptr = ep;
+    size_t insize;
+    char *outptr = &scratchbuf[0];
+    size_t outsize = sizeof (scratchbuf);
+    size_t res;
+
+    res = (size_t)(-1);
+    for (insize = 1; inptr + insize <= es; insize++)
+      {
+        res = iconv (context->conv,
+                     (ICONV_CONST char **) &inptr, &insize,
+                     &outptr, &outsize);
+        if (!(res == (size_t)(-1) && errno == EINVAL))
+          break;
+        /* We expect that no input bytes have been consumed so far.  */
+        if (inptr != ep)
+          abort ();
+      }
+    if (res == (size_t)(-1))
+      {
+        if (errno == EILSEQ)
+          return -1;
+        else if (errno == EINVAL)
+          /* This could happen if an incomplete multibyte sequence at the end
+             of input bytes.  */
+          return -2;
+        else
+          abort ();
+      }
+    return inptr - ep;
+  }
+#else
+  abort ();
+#endif
+}
 
-  if (canon_charset == NULL)
-    canon_charset = po_charset_ascii;
+
+static void
+wrap (const message_ty *mp, ostream_t stream,
+      const char *line_prefix, int extra_indent, const char *css_class,
+      const char *name, const char *value,
+      enum is_wrap do_wrap, size_t page_width,
+      struct wrap_context *context)
+{
+  const char *canon_charset = context->linebreak_charset;
+  bool weird_cjk = context->weird_cjk;
+  bool multibyte = wrap_context_multibyte (context);
+  char *fmtdir;
+  char *fmtdirattr;
+  const char *s;
+  bool first_line;
 
   /* Determine the extent of format string directives.  */
   fmtdir = NULL;
@@ -703,14 +914,24 @@ wrap (const message_ty *mp, ostream_t stream,
             const char *fd_end;
             char *fdap;
 
-            fmtdir = XCALLOC (len, char);
+            if (context->fmt_buffer_size < len)
+              {
+                context->fmt_buffer_size =
+                  xmax (len, 2 * context->fmt_buffer_size);
+                free (context->fmt_buffer);
+                context->fmt_buffer =
+                  XNMALLOC (xtimes (context->fmt_buffer_size, 2), char);
+              }
+            fmtdir = context->fmt_buffer;
+            fmtdirattr = fmtdir + context->fmt_buffer_size;
+            memset (fmtdir, '\0', len);
             descr = parser->parse (value, is_msgstr, fmtdir, &invalid_reason);
             if (descr != NULL)
               parser->free (descr);
 
             /* Locate the FMTDIR_* bits and transform the array to an array
                of attributes.  */
-            fmtdirattr = XCALLOC (len, char);
+            memset (fmtdirattr, '\0', len);
             fd_end = fmtdir + len;
             for (fdp = fmtdir, fdap = fmtdirattr; fdp < fd_end; fdp++, fdap++)
               if (*fdp & FMTDIR_START)
@@ -777,59 +998,28 @@ wrap (const message_ty *mp, ostream_t stream,
             portion_len += 2;
           else
             {
-#if HAVE_ICONV
-              if (conv != (iconv_t)(-1))
+              if (multibyte && (unsigned char) c >= 0x80)
                 {
-                  /* Skip over a complete multi-byte character.  Don't
-                     interpret the second byte of a multi-byte character as
-                     ASCII.  This is needed for the BIG5, BIG5-HKSCS, GBK,
-                     GB18030, SHIFT_JIS, JOHAB encodings.  */
-                  char scratchbuf[64];
-                  const char *inptr = ep;
-                  size_t insize;
-                  char *outptr = &scratchbuf[0];
-                  size_t outsize = sizeof (scratchbuf);
-                  size_t res;
-
-                  res = (size_t)(-1);
-                  for (insize = 1; inptr + insize <= es; insize++)
+                  int insize = wrap_mbclen (context, ep, es);
+
+                  if (insize == -1)
                     {
-                      res = iconv (conv,
-                                   (ICONV_CONST char **) &inptr, &insize,
-                                   &outptr, &outsize);
-                      if (!(res == (size_t)(-1) && errno == EINVAL))
-                        break;
-                      /* We expect that no input bytes have been consumed
-                         so far.  */
-                      if (inptr != ep)
-                        abort ();
+                      wrap_context_xerror (context, PO_SEVERITY_ERROR, mp,
+                                           false,
+                                           _("invalid multibyte sequence"));
+                      continue;
                     }
-                  if (res == (size_t)(-1))
+                  else if (insize == -2)
                     {
-                      if (errno == EILSEQ)
-                        {
-                          po_xerror (PO_SEVERITY_ERROR, mp, NULL, 0, 0, false,
-                                     _("invalid multibyte sequence"));
-                          continue;
-                        }
-                      else if (errno == EINVAL)
-                        {
-                          /* This could happen if an incomplete
-                             multibyte sequence at the end of input
-                             bytes.  */
-                          po_xerror (PO_SEVERITY_ERROR, mp, NULL, 0, 0, false,
-                                     _("incomplete multibyte sequence"));
-                          continue;
-                        }
-                      else
-                        abort ();
+                      wrap_context_xerror (context, PO_SEVERITY_ERROR, mp,
+                                           false,
+                                           _("incomplete multibyte sequence"));
+                      continue;
                     }
-                  insize = inptr - ep;
                   portion_len += insize;
                   ep += insize - 1;
                 }
               else
-#endif
                 {
                   if (weird_cjk
                       /* Special handling of encodings with CJK structure.  */
@@ -845,9 +1035,16 @@ wrap (const message_ty *mp, ostream_t stream,
                 }
             }
         }
-      portion = XNMALLOC (portion_len, char);
-      overrides = XNMALLOC (portion_len, char);
-      attributes = XNMALLOC (portion_len, char);
+      if (context->buffer_size < portion_len)
+        {
+          context->buffer_size = xmax (portion_len, 2 * context->buffer_size);
+          free (context->buffer);
+          context->buffer = XNMALLOC (xtimes (context->buffer_size, 4), char);
+        }
+      portion = context->buffer;
+      overrides = portion + context->buffer_size;
+      attributes = overrides + context->buffer_size;
+      linebreaks = attributes + context->buffer_size;
       for (ep = s, pp = portion, op = overrides, ap = attributes; ep < es; ep++)
         {
           char c = *ep;
@@ -883,8 +1080,8 @@ wrap (const message_ty *mp, ostream_t stream,
                   char *error_message =
                     xasprintf (_("internationalized messages should not contain the '\\%c' escape sequence"),
                                c);
-                  po_xerror (PO_SEVERITY_WARNING, mp, NULL, 0, 0, false,
-                             error_message);
+                  wrap_context_xerror (context, PO_SEVERITY_WARNING, mp,
+                                       false, error_message);
                   free (error_message);
                 }
             }
@@ -914,45 +1111,20 @@ wrap (const message_ty *mp, ostream_t stream,
             }
           else
             {
-#if HAVE_ICONV
-              if (conv != (iconv_t)(-1))
+              if (multibyte && (unsigned char) c >= 0x80)
                 {
-                  /* Copy a complete multi-byte character.  Don't
-                     interpret the second byte of a multi-byte character as
-                     ASCII.  This is needed for the BIG5, BIG5-HKSCS, GBK,
-                     GB18030, SHIFT_JIS, JOHAB encodings.  */
-                  char scratchbuf[64];
-                  const char *inptr = ep;
-                  size_t insize;
-                  char *outptr = &scratchbuf[0];
-                  size_t outsize = sizeof (scratchbuf);
-                  size_t res;
-
-                  res = (size_t)(-1);
-                  for (insize = 1; inptr + insize <= es; insize++)
-                    {
-                      res = iconv (conv,
-                                   (ICONV_CONST char **) &inptr, &insize,
-                                   &outptr, &outsize);
-                      if (!(res == (size_t)(-1) && errno == EINVAL))
-                        break;
-                      /* We expect that no input bytes have been consumed
-                         so far.  */
-                      if (inptr != ep)
-                        abort ();
-                    }
-                  if (res == (size_t)(-1))
+                  /* Copy a complete multi-byte character.  */
+                  int insize = wrap_mbclen (context, ep, es);
+
+                  if (insize == -1)
                     {
-                      if (errno == EILSEQ)
-                        {
-                          po_xerror (PO_SEVERITY_ERROR, mp, NULL, 0, 0,
-                                     false, _("invalid multibyte sequence"));
-                          continue;
-                        }
-                      else
-                        abort ();
+                      wrap_context_xerror (context, PO_SEVERITY_ERROR, mp,
+                                           false,
+                                           _("invalid multibyte sequence"));
+                      continue;
                     }
-                  insize = inptr - ep;
+                  else if (insize < 1)
+                    abort ();
                   memcpy_small (pp, ep, insize);
                   pp += insize;
                   *op = brk;
@@ -963,7 +1135,6 @@ wrap (const message_ty *mp, ostream_t stream,
                   ep += insize - 1;
                 }
               else
-#endif
                 {
                   if (weird_cjk
                       /* Special handling of encodings with CJK structure.  */
@@ -993,8 +1164,6 @@ wrap (const message_ty *mp, ostream_t stream,
       if (es > s && es[-1] == '\n')
         overrides[portion_len - 2] = UC_BREAK_PROHIBITED;
 
-      linebreaks = XNMALLOC (portion_len, char);
-
       /* Subsequent lines after a break are all indented.
          See INDENT-S.  */
       startcol_after_break = (line_prefix ? strlen (line_prefix) : 0);
@@ -1030,9 +1199,15 @@ wrap (const message_ty *mp, ostream_t stream,
       /* Adjust for indentation of subsequent lines.  */
       startcol -= startcol_after_break;
 
-      /* Do line breaking on the portion.  */
-      ulc_width_linebreaks (portion, portion_len, width, startcol, 0,
-                            overrides, canon_charset, linebreaks);
+      /* Do line breaking on the portion.  No character is wider than its
+         number of bytes.  Therefore a portion that fits in the line with one
+         column per byte needs no line breaks, and we can skip the line
+         breaking algorithm.  */
+      if (startcol <= width && portion_len <= (size_t) (width - startcol))
+        memset (linebreaks, UC_BREAK_PROHIBITED, portion_len);
+      else
+        ulc_width_linebreaks (portion, portion_len, width, startcol, 0,
+                              overrides, canon_charset, linebreaks);
 
       /* If this is the first line, and we are not using the indented
          style, and the line would wrap, then use an empty first line
@@ -1199,7 +1374,18 @@ wrap (const message_ty *mp, ostream_t stream,
                     currattr |= ATTR_ESCAPE_SEQUENCE;
                   }
               }
-            ostream_write_mem (stream, &portion[i], 1);
+            /* Print the characters up to the next line break or change of
+               attributes in one call.  */
+            {
+              size_t j;
+
+              for (j = i + 1; j < portion_len; j++)
+                if (linebreaks[j] == UC_BREAK_POSSIBLE
+                    || attributes[j] != attributes[i])
+                  break;
+              ostream_write_mem (stream, &portion[i], j - i);
+              i = j - 1;
+            }
           }
 
         /* Change currattr so that it becomes 0.  */
@@ -1228,25 +1414,11 @@ wrap (const message_ty *mp, ostream_t stream,
         ostream_write_str (stream, "\n");
       }
 
-      free (linebreaks);
-      free (attributes);
-      free (overrides);
-      free (portion);
-
       s = es;
 #     undef is_escape
     }
   while (*s);
 
-  if (fmtdirattr != NULL)
-    free (fmtdirattr);
-  if (fmtdir != NULL)
-    free (fmtdir);
-
-#if HAVE_ICONV
-  if (conv != (iconv_t)(-1))
-    iconv_close (conv);
-#endif
 }
 
 
@@ -1266,8 +1438,8 @@ print_blank_line (ostream_t stream)
 
 static void
 message_print (const message_ty *mp, ostream_t stream,
-               const char *charset, size_t page_width, bool blank_line,
-               bool debug)
+               struct wrap_context *context, size_t page_width,
+               bool blank_line, bool debug)
 {
   int extra_indent;
 
@@ -1309,13 +1481,13 @@ message_print (const message_ty *mp, ostream_t stream,
   begin_css_class (stream, class_previous_comment);
   if (mp->prev_msgctxt != NULL)
     wrap (mp, stream, "#| ", 0, class_previous, "msgctxt", mp->prev_msgctxt,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   if (mp->prev_msgid != NULL)
     wrap (mp, stream, "#| ", 0, class_previous, "msgid", mp->prev_msgid,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   if (mp->prev_msgid_plural != NULL)
     wrap (mp, stream, "#| ", 0, class_previous, "msgid_plural",
-          mp->prev_msgid_plural, mp->do_wrap, page_width, charset);
+          mp->prev_msgid_plural, mp->do_wrap, page_width, context);
   end_css_class (stream, class_previous_comment);
   extra_indent = (mp->prev_msgctxt != NULL || mp->prev_msgid != NULL
                   || mp->prev_msgid_plural != NULL
@@ -1328,7 +1500,7 @@ message_print (const message_ty *mp, ostream_t stream,
      are as readable as possible.  If there is no recorded msgstr for
      this domain, emit an empty string.  */
   if (mp->msgctxt != NULL && !is_ascii_string (mp->msgctxt)
-      && po_charset_canonicalize (charset) != po_charset_utf8)
+      && context->canon_charset != po_charset_utf8)
     {
       char *warning_message =
         xasprintf (_("\
@@ -1336,11 +1508,12 @@ The following msgctxt contains non-ASCII characters.\n\
 This will cause problems to translators who use a character encoding\n\
 different from yours. Consider using a pure ASCII msgctxt instead.\n\
 %s\n"), mp->msgctxt);
-      po_xerror (PO_SEVERITY_WARNING, mp, NULL, 0, 0, true, warning_message);
+      wrap_context_xerror (context, PO_SEVERITY_WARNING, mp, true,
+                           warning_message);
       free (warning_message);
     }
   if (!is_ascii_string (mp->msgid)
-      && po_charset_canonicalize (charset) != po_charset_utf8)
+      && context->canon_charset != po_charset_utf8)
     {
       char *warning_message =
         xasprintf (_("\
@@ -1348,21 +1521,22 @@ The following msgid contains non-ASCII characters.\n\
 This will cause problems to translators who use a character encoding\n\
 different from yours. Consider using a pure ASCII msgid instead.\n\
 %s\n"), mp->msgid);
-      po_xerror (PO_SEVERITY_WARNING, mp, NULL, 0, 0, true, warning_message);
+      wrap_context_xerror (context, PO_SEVERITY_WARNING, mp, true,
+                           warning_message);
       free (warning_message);
     }
   if (mp->msgctxt != NULL)
     wrap (mp, stream, NULL, extra_indent, class_msgid, "msgctxt", mp->msgctxt,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   wrap (mp, stream, NULL, extra_indent, class_msgid, "msgid", mp->msgid,
-        mp->do_wrap, page_width, charset);
+        mp->do_wrap, page_width, context);
   if (mp->msgid_plural != NULL)
     wrap (mp, stream, NULL, extra_indent, class_msgid, "msgid_plural",
-          mp->msgid_plural, mp->do_wrap, page_width, charset);
+          mp->msgid_plural, mp->do_wrap, page_width, context);
 
   if (mp->msgid_plural == NULL)
     wrap (mp, stream, NULL, extra_indent, class_msgstr, "msgstr", mp->msgstr,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   else
     {
       char prefix_buf[20];
@@ -1375,7 +1549,7 @@ different from yours. Consider using a pure ASCII msgid instead.\n\
         {
           sprintf (prefix_buf, "msgstr[%u]", i);
           wrap (mp, stream, NULL, extra_indent, class_msgstr, prefix_buf, p,
-                mp->do_wrap, page_width, charset);
+                mp->do_wrap, page_width, context);
         }
     }
 
@@ -1392,8 +1566,8 @@ different from yours. Consider using a pure ASCII msgid instead.\n\
 
 static void
 message_print_obsolete (const message_ty *mp, ostream_t stream,
-                        const char *charset, size_t page_width, bool blank_line,
-                        bool debug)
+                        struct wrap_context *context, size_t page_width,
+                        bool blank_line, bool debug)
 {
   int extra_indent;
 
@@ -1478,13 +1652,13 @@ message_print_obsolete (const message_ty *mp, ostream_t stream,
   begin_css_class (stream, class_previous_comment);
   if (mp->prev_msgctxt != NULL)
     wrap (mp, stream, "#~| ", 0, class_previous, "msgctxt", mp->prev_msgctxt,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   if (mp->prev_msgid != NULL)
     wrap (mp, stream, "#~| ", 0, class_previous, "msgid", mp->prev_msgid,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   if (mp->prev_msgid_plural != NULL)
     wrap (mp, stream, "#~| ", 0, class_previous, "msgid_plural",
-          mp->prev_msgid_plural, mp->do_wrap, page_width, charset);
+          mp->prev_msgid_plural, mp->do_wrap, page_width, context);
   end_css_class (stream, class_previous_comment);
   extra_indent = (mp->prev_msgctxt != NULL || mp->prev_msgid != NULL
                   || mp->prev_msgid_plural != NULL
@@ -1496,7 +1670,7 @@ message_print_obsolete (const message_ty *mp, ostream_t stream,
   /* Print each of the message components.  Wrap them nicely so they
      are as readable as possible.  */
   if (mp->msgctxt != NULL && !is_ascii_string (mp->msgctxt)
-      && po_charset_canonicalize (charset) != po_charset_utf8)
+      && context->canon_charset != po_charset_utf8)
     {
       char *warning_message =
         xasprintf (_("\
@@ -1504,11 +1678,12 @@ The following msgctxt contains non-ASCII characters.\n\
 This will cause problems to translators who use a character encoding\n\
 different from yours. Consider using a pure ASCII msgctxt instead.\n\
 %s\n"), mp->msgctxt);
-      po_xerror (PO_SEVERITY_WARNING, mp, NULL, 0, 0, true, warning_message);
+      wrap_context_xerror (context, PO_SEVERITY_WARNING, mp, true,
+                           warning_message);
       free (warning_message);
     }
   if (!is_ascii_string (mp->msgid)
-      && po_charset_canonicalize (charset) != po_charset_utf8)
+      && context->canon_charset != po_charset_utf8)
     {
       char *warning_message =
         xasprintf (_("\
@@ -1516,21 +1691,22 @@ The following msgid contains non-ASCII characters.\n\
 This will cause problems to translators who use a character encoding\n\
 different from yours. Consider using a pure ASCII msgid instead.\n\
 %s\n"), mp->msgid);
-      po_xerror (PO_SEVERITY_WARNING, mp, NULL, 0, 0, true, warning_message);
+      wrap_context_xerror (context, PO_SEVERITY_WARNING, mp, true,
+                           warning_message);
       free (warning_message);
     }
   if (mp->msgctxt != NULL)
     wrap (mp, stream, "#~ ", extra_indent, class_msgid, "msgctxt", mp->msgctxt,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   wrap (mp, stream, "#~ ", extra_indent, class_msgid, "msgid", mp->msgid,
-        mp->do_wrap, page_width, charset);
+        mp->do_wrap, page_width, context);
   if (mp->msgid_plural != NULL)
     wrap (mp, stream, "#~ ", extra_indent, class_msgid, "msgid_plural",
-          mp->msgid_plural, mp->do_wrap, page_width, charset);
+          mp->msgid_plural, mp->do_wrap, page_width, context);
 
   if (mp->msgid_plural == NULL)
     wrap (mp, stream, "#~ ", extra_indent, class_msgstr, "msgstr", mp->msgstr,
-          mp->do_wrap, page_width, charset);
+          mp->do_wrap, page_width, context);
   else
     {
       char prefix_buf[20];
@@ -1543,7 +1719,7 @@ different from yours. Consider using a pure ASCII msgid instead.\n\
         {
           sprintf (prefix_buf, "msgstr[%u]", i);
           wrap (mp, stream, "#~ ", extra_indent, class_msgstr, prefix_buf, p,
-                mp->do_wrap, page_width, charset);
+                mp->do_wrap, page_width, context);
         }
     }
 
@@ -1551,12 +1727,157 @@ different from yours. Consider using a pure ASCII msgid instead.\n\
 }
 
 
+#if defined _OPENMP && defined GETTEXTDATADIR
+
+/* Number of messages that a thread formats into a memory buffer at once.  */
+#define PRINT_CHUNK_SIZE 256
+
+/* Writes the messages ITEMS[START..END-1] to STREAM.  The first NREGULAR
+   items are the non-obsolete messages.  */
+static void
+message_range_print (message_ty **items, size_t start, size_t end,
+                     size_t nregular, ostream_t stream,
+                     struct wrap_context *context, size_t page_width,
+                     bool blank_line, bool debug)
+{
+  size_t j;
+
+  for (j = start; j < end; j++)
+    {
+      if (j < nregular)
+        message_print (items[j], stream, context, page_width, blank_line,
+                       debug);
+      else
+        message_print_obsolete (items[j], stream, context, page_width,
+                                blank_line, debug);
+      blank_line = true;
+    }
+}
+
+/* Writes the messages of MLP, whose encoding is CHARSET, to STREAM, like
+   the loops in msgdomain_list_print_po do.  The messages are formatted by
+   several threads, in chunks, into memory buffers that are then written
+   in order.  This requires that STREAM ignores the CSS classes.
+   Diagnostics are not reported from the threads, because that would mix
+   up their order.  A chunk that produced a diagnostic is instead formatted
+   again, when it is its turn to be written.
+   The threads call the format string parsers, through wrap ().  This is
+   safe because the parsers keep their state in local variables and in the
+   descriptor they return; their only static data are the read-only parser
+   tables.  (The msgid descriptor cache in format.c is used only by the
+   format checks, not here.)  The one parser that relies on a library with
+   global state, the KDE KUIT parser with libxml2, serializes its calls.  */
+static void
+message_list_print_parallel (message_list_ty *mlp, ostream_t stream,
+                             const char *charset, size_t page_width,
+                             bool blank_line, bool debug)
+{
+  int nthreads = omp_get_max_threads ();
+  struct wrap_context *contexts = XNMALLOC (nthreads, struct wrap_context);
+  message_ty **items = XNMALLOC (mlp->nitems, message_ty *);
+  size_t nitems;
+  size_t nregular;
+  size_t nchunks;
+  /* The number of chunks that are formatted before they are written.  It
+     limits the amount of memory used for the buffers.  */
+  size_t round_size = 4 * (size_t) nthreads;
+  memory_ostream_t *buffers = XNMALLOC (round_size, memory_ostream_t);
+  bool *redo = XNMALLOC (round_size, bool);
+  size_t first;
+  size_t j;
+  int t;
+
+  for (t = 0; t < nthreads; t++)
+    {
+      wrap_context_init (&contexts[t]);
+      wrap_context_set_charset (&contexts[t], charset);
+      contexts[t].defer_diagnostics = true;
+    }
+
+  /* The non-obsolete messages come first, then the obsolete ones.  */
+  nitems = 0;
+  for (j = 0; j < mlp->nitems; j++)
+    if (!mlp->item[j]->obsolete)
+      items[nitems++] = mlp->item[j];
+  nregular = nitems;
+  for (j = 0; j < mlp->nitems; j++)
+    if (mlp->item[j]->obsolete)
+      items[nitems++] = mlp->item[j];
+
+  nchunks = (nitems + PRINT_CHUNK_SIZE - 1) / PRINT_CHUNK_SIZE;
+  for (first = 0; first < nchunks; first += round_size)
+    {
+      long int nn = MIN (round_size, nchunks - first);
+      long int jj;
+
+      /* Tell the OpenMP capable compiler to distribute this loop across
+         several threads.  The schedule is dynamic, because the messages
+         can differ a lot in size.  */
+      #pragma omp parallel for schedule(dynamic)
+      for (jj = 0; jj < nn; jj++)
+        {
+          struct wrap_context *context = &contexts[omp_get_thread_num ()];
+          size_t start = (first + jj) * PRINT_CHUNK_SIZE;
+          memory_ostream_t buffer = memory_ostream_create ();
+          noop_styled_ostream_t buffer_stream =
+            noop_styled_ostream_create (buffer, false);
+
+          context->diagnostics_deferred = false;
+          message_range_print (items, start,
+                               MIN (start + PRINT_CHUNK_SIZE, nitems),
+                               nregular, buffer_stream, context, page_width,
+                               blank_line || start > 0, debug);
+          ostream_free (buffer_stream);
+          buffers[jj] = buffer;
+          redo[jj] = context->diagnostics_deferred;
+        }
+
+      for (jj = 0; jj < nn; jj++)
+        {
+          if (redo[jj])
+            {
+              size_t start = (first + jj) * PRINT_CHUNK_SIZE;
+
+              contexts[0].defer_diagnostics = false;
+              message_range_print (items, start,
+                                   MIN (start + PRINT_CHUNK_SIZE, nitems),
+                                   nregular, stream, &contexts[0], page_width,
+                                   blank_line || start > 0, debug);
+              contexts[0].defer_diagnostics = true;
+            }
+          else
+            {
+              const void *contents;
+              size_t contents_length;
+
+              memory_ostream_contents (buffers[jj], &contents,
+                                       &contents_length);
+              ostream_write_mem (stream, contents, contents_length);
+            }
+          ostream_free (buffers[jj]);
+        }
+    }
+
+  free (redo);
+  free (buffers);
+  free (items);
+  for (t = 0; t < nthreads; t++)
+    wrap_context_free (&contexts[t]);
+  free (contexts);
+}
+
+#endif
+
+
 static void
 msgdomain_list_print_po (msgdomain_list_ty *mdlp, ostream_t stream,
                          size_t page_width, bool debug)
 {
   size_t j, k;
   bool blank_line;
+  struct wrap_context context;
+
+  wrap_context_init (&context);
 
   /* Write out the messages for each domain.  */
   blank_line = false;
@@ -1624,27 +1945,43 @@ msgdomain_list_print_po (msgdomain_list_ty *mdlp, ostream_t stream,
             }
         }
 
-      /* Write out each of the messages for this domain.  */
-      for (j = 0; j < mlp->nitems; ++j)
-        if (!mlp->item[j]->obsolete)
-          {
-            message_print (mlp->item[j], stream, charset, page_width,
-                           blank_line, debug);
-            blank_line = true;
-          }
+      wrap_context_set_charset (&context, charset);
 
-      /* Write out each of the obsolete messages for this domain.  */
-      for (j = 0; j < mlp->nitems; ++j)
-        if (mlp->item[j]->obsolete)
-          {
-            message_print_obsolete (mlp->item[j], stream, charset, page_width,
-                                    blank_line, debug);
-            blank_line = true;
-          }
+#if defined _OPENMP && defined GETTEXTDATADIR
+      if (print_parallel && stream_unstyled && omp_get_max_threads () > 1
+          && mlp->nitems > PRINT_CHUNK_SIZE)
+        {
+          message_list_print_parallel (mlp, stream, charset, page_width,
+                                       blank_line, debug);
+          blank_line = true;
+        }
+      else
+#endif
+        {
+          /* Write out each of the messages for this domain.  */
+          for (j = 0; j < mlp->nitems; ++j)
+            if (!mlp->item[j]->obsolete)
+              {
+                message_print (mlp->item[j], stream, &context, page_width,
+                               blank_line, debug);
+                blank_line = true;
+              }
+
+          /* Write out each of the obsolete messages for this domain.  */
+          for (j = 0; j < mlp->nitems; ++j)
+            if (mlp->item[j]->obsolete)
+              {
+                message_print_obsolete (mlp->item[j], stream, &context,
+                                        page_width, blank_line, debug);
+                blank_line = true;
+              }
+        }
 
       if (allocated_charset != NULL)
         freea (allocated_charset);
     }
+
+  wrap_context_free (&context);
 }
 
 
@@ -75,6 +75,17 @@ extern void
 extern void
        message_print_style_filepos (enum filepos_comment_type type);
 
+/* Tells 'output_format_po.print' whether its stream ignores the CSS classes.
+   Only then are the messages formatted by several threads.  */
+extern void
+       message_print_stream_unstyled (bool flag);
+
+/* Tells 'output_format_po.print' whether it may format the messages in
+   several threads.  Only programs that limit the number of threads through
+   jobs_init should enable this.  */
+extern void
+       message_print_parallel (bool flag);
+
 /* --add-location argument handling.  Return an error indicator.  */
 extern bool handle_filepos_comment_option (const char *option);
 
@@ -22,7 +22,6 @@
 /* Specification.  */
 #include "write-qt.h"
 
-#include <assert.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -241,103 +240,133 @@ append_u16 (struct obstack *mempool, unsigned short value)
   obstack_grow (mempool, data, 2);
 }
 
-/* Add a u32 (four bytes) to an obstack.  */
-static void
-append_u32 (struct obstack *mempool, unsigned int value)
+/* Store a u32 (four bytes) in memory.  */
+static inline unsigned char *
+put_u32 (unsigned char *p, unsigned int value)
 {
-  unsigned char data[4];
-
-  data[0] = (value >> 24) & 0xff;
-  data[1] = (value >> 16) & 0xff;
-  data[2] = (value >> 8) & 0xff;
-  data[3] = value & 0xff;
-
-  obstack_grow (mempool, data, 4);
+  p[0] = (value >> 24) & 0xff;
+  p[1] = (value >> 16) & 0xff;
+  p[2] = (value >> 8) & 0xff;
+  p[3] = value & 0xff;
+  return p + 4;
 }
 
-/* Add an ISO-8859-1 encoded string to an obstack.  */
-static void
-append_base_string (struct obstack *mempool, const char *string)
+/* Return the number of characters of an UTF-8 string, i.e. its length
+   after conversion to ISO-8859-1.  */
+static size_t
+iso_8859_1_length (const char *string)
 {
-  size_t length = strlen (string) + 1;
-  append_u32 (mempool, length);
-  obstack_grow (mempool, string, length);
-}
+  size_t length = 0;
 
-/* Add an UTF-16 encoded string to an obstack.  */
-static void
-append_unicode_string (struct obstack *mempool, const unsigned short *string,
-                       size_t length)
-{
-  append_u32 (mempool, length * 2);
-  for (; length > 0; string++, length--)
-    append_u16 (mempool, *string);
+  for (; *string != '\0'; string++)
+    /* Count all bytes except the continuation bytes.  */
+    if ((*string & 0xc0) != 0x80)
+      length++;
+  return length;
 }
 
-/* Retrieve a 4-byte integer from memory.  */
-static inline unsigned int
-peek_u32 (const unsigned char *p)
+/* Return the length of an UTF-8 string after conversion to UTF-16, in
+   UTF-16 units.  */
+static size_t
+utf16_length (const char *string)
 {
-  return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+  size_t length = 0;
+
+  for (; *string != '\0'; string++)
+    {
+      unsigned char c = *string;
+
+      /* Count all bytes except the continuation bytes.  Characters outside
+         the BMP take two UTF-16 units.  */
+      if ((c & 0xc0) != 0x80)
+        length += (c >= 0xf0 ? 2 : 1);
+    }
+  return length;
 }
 
-/* Convert an UTF-8 string to ISO-8859-1, without error checking.  */
-static char *
-conv_to_iso_8859_1 (const char *string)
+/* Store an UTF-8 string, converted to ISO-8859-1 without error checking,
+   as a NUL-terminated ISO-8859-1 string with a length prefix.
+   LENGTH is its iso_8859_1_length.  Return the address after it.  */
+static unsigned char *
+put_base_string (unsigned char *p, const char *string, size_t length)
 {
-  size_t length = strlen (string);
-  const char *str = string;
-  const char *str_limit = string + length;
-  /* Conversion to ISO-8859-1 can only reduce the number of bytes.  */
-  char *result = XNMALLOC (length + 1, char);
-  char *q = result;
-
-  while (str < str_limit)
+  const char *str_limit = string + strlen (string);
+
+  p = put_u32 (p, length + 1);
+  while (string < str_limit)
     {
-      ucs4_t uc;
-      str += u8_mbtouc (&uc, (const unsigned char *) str, str_limit - str);
-      /* It has already been verified that the string fits in ISO-8859-1.  */
-      if (!(uc < 0x100))
-        abort ();
-      /* Store as ISO-8859-1.  */
-      *q++ = (unsigned char) uc;
-    }
-  *q = '\0';
-  assert (q - result <= length);
+      unsigned char c = *string;
 
-  return result;
+      if (c < 0x80)
+        {
+          /* Fast path for ASCII characters.  */
+          *p++ = c;
+          string++;
+        }
+      else
+        {
+          ucs4_t uc;
+
+          string += u8_mbtouc (&uc, (const unsigned char *) string,
+                               str_limit - string);
+          /* It has already been verified that the string fits in
+             ISO-8859-1.  */
+          if (!(uc < 0x100))
+            abort ();
+          *p++ = (unsigned char) uc;
+        }
+    }
+  *p++ = '\0';
+  return p;
 }
 
-/* Convert an UTF-8 string to UTF-16, returning its size (number of UTF-16
-   codepoints) in *SIZEP.  */
-static unsigned short *
-conv_to_utf16 (const char *string, size_t *sizep)
+/* Store an UTF-8 string, converted to UTF-16, with a length prefix.
+   LENGTH is its utf16_length.  Return the address after it.  */
+static unsigned char *
+put_unicode_string (unsigned char *p, const char *string, size_t length)
 {
-  size_t length = strlen (string);
-  const char *str = string;
-  const char *str_limit = string + length;
-  /* Conversion to UTF-16 can at most double the number of bytes.  */
-  unsigned short *result = XNMALLOC (length, unsigned short);
-  unsigned short *q = result;
-
-  while (str < str_limit)
+  const char *str_limit = string + strlen (string);
+
+  p = put_u32 (p, length * 2);
+  while (string < str_limit)
     {
-      ucs4_t uc;
-      str += u8_mbtouc (&uc, (const unsigned char *) str, str_limit - str);
-      if (uc < 0x10000)
-        /* UCS-2 character.  */
-        *q++ = (unsigned short) uc;
+      unsigned char c = *string;
+
+      if (c < 0x80)
+        {
+          /* Fast path for ASCII characters.  */
+          p[0] = 0;
+          p[1] = c;
+          p += 2;
+          string++;
+        }
       else
         {
-          /* UTF-16 surrogate.  */
-          *q++ = 0xd800 + ((uc - 0x10000) >> 10);
-          *q++ = 0xdc00 + ((uc - 0x10000) & 0x3ff);
+          ucs4_t uc;
+
+          string += u8_mbtouc (&uc, (const unsigned char *) string,
+                               str_limit - string);
+          if (uc < 0x10000)
+            {
+              /* UCS-2 character.  */
+              p[0] = (uc >> 8) & 0xff;
+              p[1] = uc & 0xff;
+              p += 2;
+            }
+          else
+            {
+              /* UTF-16 surrogate.  */
+              unsigned int uc1 = 0xd800 + ((uc - 0x10000) >> 10);
+              unsigned int uc2 = 0xdc00 + ((uc - 0x10000) & 0x3ff);
+              p[0] = (uc1 >> 8) & 0xff;
+              p[1] = uc1 & 0xff;
+              p[2] = (uc2 >> 8) & 0xff;
+              p[3] = uc2 & 0xff;
+              p += 4;
+            }
         }
     }
-  assert (q - result <= 2 * length);
-
-  *sizep = q - result;
-  return result;
+  return p;
 }
 
 /* Return the Qt hash code of a string.  */
@@ -352,27 +381,72 @@ string_hashcode (const char *str)
   return h;
 }
 
-/* Compare two entries of the hashes section.  */
-static int
-cmp_hashes (const void *va, const void *vb)
+/* An entry of the hashes section.  */
+struct hash_entry
 {
-  const unsigned char *a = (const unsigned char *) va;
-  const unsigned char *b = (const unsigned char *) vb;
-  unsigned int a_hashcode = peek_u32 (a);
-  unsigned int b_hashcode = peek_u32 (b);
-
-  if (a_hashcode != b_hashcode)
-    return (a_hashcode >= b_hashcode ? 1 : -1);
-  else
+  unsigned int hashcode;
+  unsigned int offset;
+};
+
+/* Sort the entries of the hashes section by hashcode and, for equal
+   hashcodes, by offset.  The entries come in ascending order of offset, so a
+   stable radix sort on the hashcode does it, in linear time.  */
+static void
+sort_hash_entries (struct hash_entry *entries, size_t n)
+{
+  size_t counts[4][256];
+  struct hash_entry *tmp;
+  struct hash_entry *from;
+  struct hash_entry *to;
+  unsigned int pass;
+  size_t i;
+
+  memset (counts, 0, sizeof (counts));
+  for (i = 0; i < n; i++)
     {
-      unsigned int a_offset = peek_u32 (a + 4);
-      unsigned int b_offset = peek_u32 (b + 4);
+      unsigned int h = entries[i].hashcode;
 
-      if (a_offset != b_offset)
-        return (a_offset >= b_offset ? 1 : -1);
-      else
-        return 0;
+      counts[0][h & 0xff]++;
+      counts[1][(h >> 8) & 0xff]++;
+      counts[2][(h >> 16) & 0xff]++;
+      counts[3][(h >> 24) & 0xff]++;
+    }
+
+  tmp = XNMALLOC (n, struct hash_entry);
+  from = entries;
+  to = tmp;
+  for (pass = 0; pass < 4; pass++)
+    {
+      unsigned int shift = 8 * pass;
+      size_t *count = counts[pass];
+      size_t sum;
+      unsigned int d;
+
+      /* Skip the pass if all entries have the same byte here.  */
+      if (count[(from[0].hashcode >> shift) & 0xff] == n)
+        continue;
+
+      /* Turn the counts into start positions.  */
+      sum = 0;
+      for (d = 0; d < 256; d++)
+        {
+          size_t c = count[d];
+          count[d] = sum;
+          sum += c;
+        }
+
+      for (i = 0; i < n; i++)
+        to[count[(from[i].hashcode >> shift) & 0xff]++] = from[i];
+
+      {
+        struct hash_entry *swap = from;
+        from = to;
+        to = swap;
+      }
     }
+  if (from != entries)
+    memcpy (entries, from, n * sizeof (struct hash_entry));
+  free (tmp);
 }
 
 
@@ -399,14 +473,20 @@ write_qm (FILE *output_file, message_list_ty *mlp)
       0x3C, 0xB8, 0x64, 0x18, 0xCA, 0xEF, 0x9C, 0x95,
       0xCD, 0x21, 0x1C, 0xBF, 0x60, 0xA1, 0xBD, 0xDD
     };
-  struct obstack hashes_pool;
-  struct obstack messages_pool;
+  size_t nstrings;
+  size_t hashes_size;
+  size_t messages_size;
+  size_t image_size;
+  unsigned char *image;
+  unsigned char *hashes_start;
+  unsigned char *messages_start;
+  struct hash_entry *hash_entries;
   size_t j;
 
-  obstack_init (&hashes_pool);
-  obstack_init (&messages_pool);
-
-  /* Prepare the hashes section and the messages section.  */
+  /* Compute the size of the hashes section and of the messages section,
+     so that the image of the file can be built in a single buffer.  */
+  nstrings = 0;
+  messages_size = 0;
   for (j = 0; j < mlp->nitems; j++)
     {
       message_ty *mp = mlp->item[j];
@@ -414,61 +494,108 @@ write_qm (FILE *output_file, message_list_ty *mlp)
       /* No need to emit the header entry, it's not needed at runtime.  */
       if (!is_header (mp))
         {
-          char *msgctxt_as_iso_8859_1 =
-            conv_to_iso_8859_1 (mp->msgctxt != NULL ? mp->msgctxt : "");
-          char *msgid_as_iso_8859_1 = conv_to_iso_8859_1 (mp->msgid);
-          size_t msgstr_len;
-          unsigned short *msgstr_as_utf16 =
-            conv_to_utf16 (mp->msgstr, &msgstr_len);
-          unsigned int hashcode = string_hashcode (msgid_as_iso_8859_1);
-          unsigned int offset = obstack_object_size (&messages_pool);
+          nstrings++;
+          /* The subsections 03, 08, 06, 07, 05, 01.  */
+          messages_size +=
+            (1 + 4 + 2 * utf16_length (mp->msgstr))
+            + (1 + 4 + 1)
+            + (1 + 4 + iso_8859_1_length (mp->msgid) + 1)
+            + (1 + 4 + (mp->msgctxt != NULL
+                        ? iso_8859_1_length (mp->msgctxt) : 0) + 1)
+            + (1 + 4)
+            + 1;
+        }
+    }
+  hashes_size = 8 * nstrings;
 
-          /* Add a record to the hashes section.  */
-          append_u32 (&hashes_pool, hashcode);
-          append_u32 (&hashes_pool, offset);
+  /* A section can be omitted if it is empty.  */
+  image_size = sizeof (magic)
+               + (hashes_size > 0 ? 1 + 4 + hashes_size : 0)
+               + (messages_size > 0 ? 1 + 4 + messages_size : 0);
+  image = XNMALLOC (image_size, unsigned char);
+
+  memcpy (image, magic, sizeof (magic));
+  hashes_start = image + sizeof (magic);
+  messages_start = hashes_start;
+  if (hashes_size > 0)
+    {
+      hashes_start[0] = 0x42;
+      put_u32 (hashes_start + 1, hashes_size);
+      hashes_start += 1 + 4;
+      messages_start = hashes_start + hashes_size;
+    }
+  if (messages_size > 0)
+    {
+      messages_start[0] = 0x69;
+      put_u32 (messages_start + 1, messages_size);
+      messages_start += 1 + 4;
+    }
 
-          /* Add a record to the messages section.  */
+  /* Fill the messages section.  */
+  hash_entries = XNMALLOC (nstrings, struct hash_entry);
+  {
+    unsigned char *p = messages_start;
+    size_t k = 0;
 
-          append_u8 (&messages_pool, 0x03);
-          append_unicode_string (&messages_pool, msgstr_as_utf16, msgstr_len);
+    for (j = 0; j < mlp->nitems; j++)
+      {
+        message_ty *mp = mlp->item[j];
 
-          append_u8 (&messages_pool, 0x08);
-          append_base_string (&messages_pool, "");
+        if (!is_header (mp))
+          {
+            const char *msgctxt = (mp->msgctxt != NULL ? mp->msgctxt : "");
+            unsigned int offset = p - messages_start;
+            const char *msgid_as_iso_8859_1;
+            unsigned int hashcode;
 
-          append_u8 (&messages_pool, 0x06);
-          append_base_string (&messages_pool, msgid_as_iso_8859_1);
+            *p++ = 0x03;
+            p = put_unicode_string (p, mp->msgstr, utf16_length (mp->msgstr));
 
-          append_u8 (&messages_pool, 0x07);
-          append_base_string (&messages_pool, msgctxt_as_iso_8859_1);
+            *p++ = 0x08;
+            p = put_u32 (p, 1);
+            *p++ = '\0';
 
-          append_u8 (&messages_pool, 0x05);
-          append_u32 (&messages_pool, hashcode);
+            *p++ = 0x06;
+            msgid_as_iso_8859_1 = (const char *) p + 4;
+            p = put_base_string (p, mp->msgid, iso_8859_1_length (mp->msgid));
+            /* The hash code is computed on the NUL-terminated ISO-8859-1
+               encoded msgid, that was just stored.  */
+            hashcode = string_hashcode (msgid_as_iso_8859_1);
 
-          append_u8 (&messages_pool, 0x01);
+            *p++ = 0x07;
+            p = put_base_string (p, msgctxt, iso_8859_1_length (msgctxt));
 
-          free (msgstr_as_utf16);
-          free (msgid_as_iso_8859_1);
-          free (msgctxt_as_iso_8859_1);
-        }
-    }
+            *p++ = 0x05;
+            p = put_u32 (p, hashcode);
 
-  /* Sort the hashes section.  */
-  {
-    size_t nstrings = obstack_object_size (&hashes_pool) / 8;
-    if (nstrings > 0)
-      qsort (obstack_base (&hashes_pool), nstrings, 8, cmp_hashes);
+            *p++ = 0x01;
+
+            hash_entries[k].hashcode = hashcode;
+            hash_entries[k].offset = offset;
+            k++;
+          }
+      }
+    if (!(k == nstrings && p == messages_start + messages_size))
+      abort ();
   }
 
-  /* Write the magic number.  */
-  fwrite (magic, sizeof (magic), 1, output_file);
+  /* Sort and fill the hashes section.  */
+  if (nstrings > 0)
+    {
+      unsigned char *p = hashes_start;
 
-  /* Write the hashes section.  */
-  write_section (output_file, 0x42, obstack_base (&hashes_pool),
-                 obstack_object_size (&hashes_pool));
+      sort_hash_entries (hash_entries, nstrings);
+      for (j = 0; j < nstrings; j++)
+        {
+          p = put_u32 (p, hash_entries[j].hashcode);
+          p = put_u32 (p, hash_entries[j].offset);
+        }
+    }
+  free (hash_entries);
 
-  /* Write the messages section.  */
-  write_section (output_file, 0x69, obstack_base (&messages_pool),
-                 obstack_object_size (&messages_pool));
+  /* Write the magic number, the hashes section and the messages section.  */
+  fwrite (image, image_size, 1, output_file);
+  free (image);
 
   /* Decide whether to write a contexts section.  */
   {
@@ -639,8 +766,6 @@ write_qm (FILE *output_file, message_list_ty *mlp)
       }
   }
 
-  obstack_free (&messages_pool, NULL);
-  obstack_free (&hashes_pool, NULL);
 }
 
 
@@ -25,96 +25,303 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "error.h"
 #include "xerror.h"
-#include "relocatable.h"
-#include "csharpexec.h"
-#include "spawn-pipe.h"
-#include "wait-process.h"
 #include "message.h"
 #include "msgfmt.h"
 #include "msgl-iconv.h"
 #include "msgl-header.h"
 #include "po-charset.h"
+#include "unistr.h"
 #include "xalloc.h"
-#include "concat-filename.h"
+#include "obstack.h"
+#include "binary-io.h"
 #include "fwriteerror.h"
 #include "gettext.h"
 
 #define _(str) gettext (str)
 
 
-/* A .resources file has such a complex format that it's most easily generated
-   through the C# class ResourceWriter.  So we start a C# process to execute
-   the WriteResource program, sending it the msgid/msgstr pairs as
-   NUL-terminated UTF-8 encoded strings.  */
-
-struct locals
+/* The .resources format is the one of the System.Resources.ResourceWriter
+   class, version 2.  We write it directly, so that no C# runtime is needed.
+   The file consists of
+     - the ResourceManager header: magic number, version, and the names of
+       the reader and resource set classes,
+     - the RuntimeResourceSet header: version, number of resources, number of
+       types (0, since all values are strings),
+     - padding to a multiple of 8 bytes,
+     - the hash codes of the names, sorted, and the positions of the names in
+       the name section, in the same order,
+     - the position of the data section,
+     - the name section: for each resource, its name in UTF-16 and the
+       position of its value in the data section,
+     - the data section: for each resource, the type code of a string and
+       the value in UTF-8.
+   Strings are preceded by their length in bytes, in 7-bit encoding.  The
+   resources are stored in the ordinal order of their names.  */
+
+#define obstack_chunk_alloc xmalloc
+#define obstack_chunk_free free
+
+/* The 32-bit magic number of .resources files.  */
+#define RESOURCES_MAGIC 0xbeefcace
+
+/* Type code of string values.  */
+#define RESOURCES_TYPE_STRING 1
+
+/* A resource, with its name in UTF-16.  */
+struct resource
 {
-  /* IN */
-  message_list_ty *mlp;
+  uint16_t *name;
+  size_t name_len;
+  const char *value;
+  unsigned int hash;
+  unsigned int name_position;
 };
 
-static bool
-execute_writing_input (const char *progname,
-                       const char *prog_path, char **prog_argv,
-                       void *private_data)
+static void
+append_u8 (struct obstack *mempool, unsigned char value)
 {
-  struct locals *l = (struct locals *) private_data;
-  pid_t child;
-  int fd[1];
-  FILE *fp;
-  int exitstatus;
+  obstack_1grow (mempool, value);
+}
 
-  /* Open a pipe to the C# execution engine.  */
-  child = create_pipe_out (progname, prog_path, prog_argv, NULL, false,
-                           true, true, fd);
+/* Add a 32-bit integer, in little-endian byte order.  */
+static void
+append_u32 (struct obstack *mempool, unsigned int value)
+{
+  unsigned char data[4];
 
-  fp = fdopen (fd[0], "wb");
-  if (fp == NULL)
-    error (EXIT_FAILURE, errno, _("fdopen() failed"));
+  data[0] = value & 0xff;
+  data[1] = (value >> 8) & 0xff;
+  data[2] = (value >> 16) & 0xff;
+  data[3] = (value >> 24) & 0xff;
+  obstack_grow (mempool, data, 4);
+}
 
-  /* Write the message list.  */
-  {
-    message_list_ty *mlp = l->mlp;
-    size_t j;
+/* Add an integer in 7-bit encoding.  */
+static void
+append_7bit (struct obstack *mempool, size_t value)
+{
+  while (value >= 0x80)
+    {
+      append_u8 (mempool, (value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+  append_u8 (mempool, value);
+}
 
-    for (j = 0; j < mlp->nitems; j++)
-      {
-        message_ty *mp = mlp->item[j];
+/* Return the number of bytes of an integer in 7-bit encoding.  */
+static size_t
+size_7bit (size_t value)
+{
+  size_t n = 1;
 
-        fwrite (mp->msgid, 1, strlen (mp->msgid) + 1, fp);
-        fwrite (mp->msgstr, 1, strlen (mp->msgstr) + 1, fp);
-      }
-  }
+  while (value >= 0x80)
+    {
+      value >>= 7;
+      n++;
+    }
+  return n;
+}
+
+/* Add a UTF-8 string, preceded by its length.  */
+static void
+append_utf8_string (struct obstack *mempool, const char *str)
+{
+  size_t len = strlen (str);
+
+  append_7bit (mempool, len);
+  obstack_grow (mempool, str, len);
+}
+
+/* Add a UTF-16 string in little-endian byte order, preceded by its length
+   in bytes.  */
+static void
+append_utf16_string (struct obstack *mempool, const uint16_t *str, size_t len)
+{
+  size_t i;
 
-  if (fwriteerror (fp))
-    error (EXIT_FAILURE, 0, _("error while writing to %s subprocess"),
-           progname);
-
-  /* Remove zombie process from process list, and retrieve exit status.  */
-  /* He we can ignore SIGPIPE because WriteResource either writes to a file
-     - then it never gets SIGPIPE - or to standard output, and in the latter
-     case it has no side effects other than writing to standard output.  */
-  exitstatus =
-    wait_subprocess (child, progname, true, false, true, true, NULL);
-  if (exitstatus != 0)
-    error (EXIT_FAILURE, 0, _("%s subprocess failed with exit code %d"),
-           progname, exitstatus);
-
-  return false;
+  append_7bit (mempool, 2 * len);
+  for (i = 0; i < len; i++)
+    {
+      append_u8 (mempool, str[i] & 0xff);
+      append_u8 (mempool, str[i] >> 8);
+    }
 }
 
+/* Convert a UTF-8 string to UTF-16.  */
+static uint16_t *
+utf8_to_utf16 (const char *str, size_t *lenp)
+{
+  const char *str_limit = str + strlen (str);
+  uint16_t *result = XNMALLOC (str_limit - str + 1, uint16_t);
+  uint16_t *q = result;
+
+  while (str < str_limit)
+    {
+      ucs4_t uc;
+
+      str += u8_mbtouc (&uc, (const unsigned char *) str, str_limit - str);
+      if (uc < 0x10000)
+        *q++ = uc;
+      else
+        {
+          /* UTF-16 surrogate pair.  */
+          *q++ = 0xd800 + ((uc - 0x10000) >> 10);
+          *q++ = 0xdc00 + ((uc - 0x10000) & 0x3ff);
+        }
+    }
+  *lenp = q - result;
+  return result;
+}
+
+/* The hash function of the ResourceReader class.  */
+static unsigned int
+resource_name_hash (const uint16_t *str, size_t len)
+{
+  unsigned int hash = 5381;
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    hash = ((hash << 5) + hash) ^ str[i];
+  return hash & 0xffffffffU;
+}
+
+/* Compare two resources by name, like String.CompareOrdinal.  */
+static int
+cmp_by_name (const void *pval1, const void *pval2)
+{
+  const struct resource *r1 = (const struct resource *) pval1;
+  const struct resource *r2 = (const struct resource *) pval2;
+  size_t len = (r1->name_len < r2->name_len ? r1->name_len : r2->name_len);
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if (r1->name[i] != r2->name[i])
+      return (r1->name[i] < r2->name[i] ? -1 : 1);
+  return (r1->name_len < r2->name_len ? -1 : r1->name_len > r2->name_len);
+}
+
+/* Compare two resources by hash code, as signed 32-bit integers.  */
+static int
+cmp_by_hash (const void *pval1, const void *pval2)
+{
+  const struct resource *r1 = (const struct resource *) pval1;
+  const struct resource *r2 = (const struct resource *) pval2;
+  int h1 = (int) r1->hash;
+  int h2 = (int) r2->hash;
+
+  if (h1 != h2)
+    return (h1 < h2 ? -1 : 1);
+  /* Keep the order of the name section.  */
+  return (r1->name_position < r2->name_position ? -1 : 1);
+}
+
+/* Write the messages of MLP, which are in UTF-8, as a .resources file.  */
+static void
+write_resources (FILE *output_file, message_list_ty *mlp)
+{
+  static const char reader_type[] =
+    "System.Resources.ResourceReader, mscorlib, Version=4.0.0.0, "
+    "Culture=neutral, PublicKeyToken=b77a5c561934e089";
+  static const char set_type[] = "System.Resources.RuntimeResourceSet";
+  size_t n = mlp->nitems;
+  struct resource *resources = XNMALLOC (n, struct resource);
+  struct obstack header_pool;
+  struct obstack names_pool;
+  struct obstack data_pool;
+  size_t header_size;
+  size_t names_size;
+  size_t data_size;
+  char *header;
+  char *names;
+  char *data;
+  size_t j;
+
+  for (j = 0; j < n; j++)
+    {
+      message_ty *mp = mlp->item[j];
+      struct resource *r = &resources[j];
+
+      r->name = utf8_to_utf16 (mp->msgid, &r->name_len);
+      r->value = mp->msgstr;
+      r->hash = resource_name_hash (r->name, r->name_len);
+    }
+
+  /* The name and data sections.  */
+  qsort (resources, n, sizeof (struct resource), cmp_by_name);
+  obstack_init (&names_pool);
+  obstack_init (&data_pool);
+  for (j = 0; j < n; j++)
+    {
+      struct resource *r = &resources[j];
+
+      r->name_position = obstack_object_size (&names_pool);
+      append_utf16_string (&names_pool, r->name, r->name_len);
+      append_u32 (&names_pool, obstack_object_size (&data_pool));
+      append_7bit (&data_pool, RESOURCES_TYPE_STRING);
+      append_utf8_string (&data_pool, r->value);
+    }
+  names_size = obstack_object_size (&names_pool);
+  names = (char *) obstack_finish (&names_pool);
+  data_size = obstack_object_size (&data_pool);
+  data = (char *) obstack_finish (&data_pool);
+
+  /* The headers and the lookup tables.  */
+  obstack_init (&header_pool);
+  append_u32 (&header_pool, RESOURCES_MAGIC);
+  append_u32 (&header_pool, 1);
+  append_u32 (&header_pool,
+              size_7bit (sizeof (reader_type) - 1) + sizeof (reader_type) - 1
+              + size_7bit (sizeof (set_type) - 1) + sizeof (set_type) - 1);
+  append_utf8_string (&header_pool, reader_type);
+  append_utf8_string (&header_pool, set_type);
+  append_u32 (&header_pool, 2);
+  append_u32 (&header_pool, n);
+  append_u32 (&header_pool, 0);
+  {
+    static const char pad[3] = { 'P', 'A', 'D' };
+    size_t i;
+
+    for (i = 0; obstack_object_size (&header_pool) % 8 != 0; i++)
+      append_u8 (&header_pool, pad[i % 3]);
+  }
+  qsort (resources, n, sizeof (struct resource), cmp_by_hash);
+  for (j = 0; j < n; j++)
+    append_u32 (&header_pool, resources[j].hash);
+  for (j = 0; j < n; j++)
+    append_u32 (&header_pool, resources[j].name_position);
+  append_u32 (&header_pool,
+              obstack_object_size (&header_pool) + 4 + names_size);
+  header_size = obstack_object_size (&header_pool);
+  header = (char *) obstack_finish (&header_pool);
+
+  fwrite (header, 1, header_size, output_file);
+  fwrite (names, 1, names_size, output_file);
+  fwrite (data, 1, data_size, output_file);
+
+  obstack_free (&header_pool, NULL);
+  obstack_free (&data_pool, NULL);
+  obstack_free (&names_pool, NULL);
+  for (j = 0; j < n; j++)
+    free (resources[j].name);
+  free (resources);
+}
+
+
 int
 msgdomain_write_csharp_resources (message_list_ty *mlp,
                                   const char *canon_encoding,
                                   const char *domain_name,
                                   const char *file_name)
 {
+  FILE *output_file;
+
   /* If no entry for this domain don't even create the file.  */
   if (mlp->nitems != 0)
     {
@@ -163,37 +370,28 @@ but the C# .resources format doesn't support plural handling\n")));
          between builds in the same conditions.  */
       message_list_delete_header_field (mlp, "POT-Creation-Date:");
 
-      /* Execute the WriteResource program.  */
-      {
-        const char *args[2];
-        const char *gettextexedir;
-        char *assembly_path;
-        struct locals locals;
-
-        /* Prepare arguments.  */
-        args[0] = file_name;
-        args[1] = NULL;
-
-        /* Make it possible to override the .exe location.  This is
-           necessary for running the testsuite before "make install".  */
-        gettextexedir = getenv ("GETTEXTCSHARPEXEDIR");
-        if (gettextexedir == NULL || gettextexedir[0] == '\0')
-          gettextexedir = relocate (LIBDIR "/gettext");
-
-        assembly_path =
-          xconcatenated_filename (gettextexedir, "msgfmt.net", ".exe");
-
-        locals.mlp = mlp;
-
-        if (execute_csharp_program (assembly_path, NULL, 0,
-                                    args,
-                                    verbose > 0, false,
-                                    execute_writing_input, &locals))
-          /* An error message should already have been provided.  */
-          exit (EXIT_FAILURE);
-
-        free (assembly_path);
-      }
+      if (strcmp (file_name, "-") == 0)
+        {
+          output_file = stdout;
+          SET_BINARY (fileno (output_file));
+        }
+      else
+        {
+          output_file = fopen (file_name, "wb");
+          if (output_file == NULL)
+            {
+              error (0, errno, _("error while opening \"%s\" for writing"),
+                     file_name);
+              return 1;
+            }
+        }
+
+      write_resources (output_file, mlp);
+
+      /* Make sure nothing went wrong.  */
+      if (fwriteerror (output_file))
+        error (EXIT_FAILURE, errno, _("error while writing \"%s\" file"),
+               file_name);
     }
 
   return 0;
@@ -81,14 +81,12 @@ write_tcl_string (FILE *stream, const char *str)
             fprintf (stream, "\\\\");
           else if (uc == 0x005d)
             fprintf (stream, "\\]");
-          /* No need to escape '{' and '}' because we don't have opening
-             braces outside the strings.  */
-#if 0
+          /* Escape '{' and '}', because the strings are written inside
+             the braces of a ::msgcat::mcmset list.  */
           else if (uc == 0x007b)
             fprintf (stream, "\\{");
           else if (uc == 0x007d)
             fprintf (stream, "\\}");
-#endif
           else if (uc >= 0x0020 && uc < 0x007f)
             fprintf (stream, "%c", (int) uc);
           else
@@ -111,27 +109,48 @@ write_tcl_string (FILE *stream, const char *str)
 static void
 write_msg (FILE *output_file, message_list_ty *mlp, const char *locale_name)
 {
+  bool has_messages;
   size_t j;
 
   /* We don't care about esthetic formattic of the output (like respecting
      a maximum line width, or including the translator comments) because
      the \unnnn notation is unesthetic anyway.  Translators shall edit
      the PO file.  */
+  has_messages = false;
   for (j = 0; j < mlp->nitems; j++)
     {
       message_ty *mp = mlp->item[j];
 
       if (is_header (mp))
-        /* Tcl's msgcat unit ignores this, but msgunfmt needs it.  */
-        fprintf (output_file, "set ::msgcat::header ");
+        {
+          /* Tcl's msgcat unit ignores this, but msgunfmt needs it.  */
+          fprintf (output_file, "set ::msgcat::header ");
+          write_tcl_string (output_file, mp->msgstr);
+          fprintf (output_file, "\n");
+        }
       else
+        has_messages = true;
+    }
+
+  /* Set all messages through a single ::msgcat::mcmset command.  Tcl loads
+     this several times faster than one ::msgcat::mcset command per
+     message, because it has to parse and evaluate only one command.  */
+  if (has_messages)
+    {
+      fprintf (output_file, "::msgcat::mcmset %s {\n", locale_name);
+      for (j = 0; j < mlp->nitems; j++)
         {
-          fprintf (output_file, "::msgcat::mcset %s ", locale_name);
-          write_tcl_string (output_file, mp->msgid);
-          fprintf (output_file, " ");
+          message_ty *mp = mlp->item[j];
+
+          if (!is_header (mp))
+            {
+              write_tcl_string (output_file, mp->msgid);
+              fprintf (output_file, " ");
+              write_tcl_string (output_file, mp->msgstr);
+              fprintf (output_file, "\n");
+            }
         }
-      write_tcl_string (output_file, mp->msgstr);
-      fprintf (output_file, "\n");
+      fprintf (output_file, "}\n");
     }
 }
 
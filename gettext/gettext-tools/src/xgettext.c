@@ -73,6 +73,7 @@
 #include "msgl-ascii.h"
 #include "msgl-check.h"
 #include "po-time.h"
+#include "time-report.h"
 #include "write-catalog.h"
 #include "write-po.h"
 #include "write-properties.h"
@@ -268,6 +269,7 @@ static const struct option long_options[] =
   { "string-limit", required_argument, NULL, 'l' },
   { "stringtable-output", no_argument, NULL, CHAR_MAX + 7 },
   { "style", required_argument, NULL, CHAR_MAX + 15 },
+  { "time-report", optional_argument, NULL, CHAR_MAX + 21 },
   { "trigraphs", no_argument, NULL, 'T' },
   { "verbose", no_argument, NULL, 'v' },
   { "version", no_argument, NULL, 'V' },
@@ -672,6 +674,17 @@ main (int argc, char *argv[])
         add_itstool_comments = true;
         break;
 
+      case CHAR_MAX + 21: /* --time-report */
+        {
+          enum time_report_format format;
+
+          if (!time_report_parse_format (optarg, &format))
+            error (EXIT_FAILURE, 0, _("time report format '%s' unknown"),
+                   optarg);
+          time_report_request (format);
+        }
+        break;
+
       default:
         usage (EXIT_FAILURE);
         /* NOTREACHED */
@@ -832,9 +845,13 @@ xgettext cannot work without keywords to look for"));
       void *saved_directory_list = dir_list_save_reset ();
       extractor_ty po_extractor = { extract_po, NULL, NULL, NULL };
 
+      time_report_begin ("parse");
       extract_from_file (file_name, po_extractor, mdlp);
+      time_report_end ("parse");
+      time_report_begin ("charset conversion");
       if (!is_ascii_msgdomain_list (mdlp))
         mdlp = iconv_msgdomain_list (mdlp, "UTF-8", true, file_name);
+      time_report_end ("charset conversion");
 
       dir_list_restore (saved_directory_list);
     }
@@ -974,6 +991,7 @@ xgettext cannot work without keywords to look for"));
           free (reduced);
         }
 
+      time_report_begin ("extract");
       if (its_rules != NULL)
         {
           /* Extract the strings from the file, using ITS.  */
@@ -983,6 +1001,7 @@ xgettext cannot work without keywords to look for"));
       else
         /* Extract the strings from the file.  */
         extract_from_file (filename, this_file_extractor, mdlp);
+      time_report_end ("extract");
     }
   string_list_free (file_list);
 
@@ -999,20 +1018,24 @@ xgettext cannot work without keywords to look for"));
 #endif
 
   /* Sorting the list of messages.  */
+  time_report_begin ("sort");
   if (sort_by_filepos)
     msgdomain_list_sort_by_filepos (mdlp);
   else if (sort_by_msgid)
     msgdomain_list_sort_by_msgid (mdlp);
+  time_report_end ("sort");
 
   /* Check syntax of messages.  */
   {
     int nerrors = 0;
 
+    time_report_begin ("syntax checks");
     for (i = 0; i < mdlp->nitems; i++)
       {
         message_list_ty *mlp = mdlp->item[i]->messages;
         nerrors = syntax_check_message_list (mlp);
       }
+    time_report_end ("syntax checks");
 
     /* Exit with status 1 on any error.  */
     if (nerrors > 0)
@@ -1023,7 +1046,9 @@ xgettext cannot work without keywords to look for"));
   }
 
   /* Write the PO file.  */
+  time_report_begin ("output");
   msgdomain_list_print (mdlp, file_name, output_syntax, force_po, do_debug);
+  time_report_end ("output");
 
   if (its_locating_rules)
     locating_rule_list_free (its_locating_rules);
@@ -1238,6 +1263,9 @@ Informative output:\n"));
   -V, --version               output version information and exit\n"));
       printf (_("\
   -v, --verbose               increase verbosity level\n"));
+      printf (_("\
+      --time-report[=FORMAT]  report the time spent in each phase at exit;\n\
+                              FORMAT may be 'text' (default) or 'json'\n"));
       printf ("\n");
       /* TRANSLATORS: The first placeholder is the web address of the Savannah
          project of this package.  The second placeholder is the bug-reporting
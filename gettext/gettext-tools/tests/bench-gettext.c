@@ -0,0 +1,339 @@
+/* Benchmark program for libintl lookups, used by "make bench".
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Usage: bench-gettext LABELS LOCALEDIR IDSFILE ITERATIONS THREADS...
+
+   LOCALEDIR must contain the catalogs bench/LC_MESSAGES/bench.mo and
+   bench/LC_MESSAGES/bench2.mo, and the environment must contain
+   LANGUAGE=bench.  IDSFILE lists the msgids of the catalog, one per line:
+     S<TAB>msgid
+     P<TAB>msgid<TAB>msgid_plural
+   For each number of threads in THREADS, every thread performs ITERATIONS
+   lookups with gettext, then ITERATIONS lookups with ngettext, cycling
+   through the msgids.
+
+   The results are written to standard output as JSON objects, one per line,
+   each starting with the LABELS.  Exit status 77 means that the benchmark
+   cannot run here.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#if USE_POSIX_THREADS
+# include <pthread.h>
+#endif
+
+#if USE_SYSTEM_LIBINTL
+# include <libintl.h>
+#else
+/* Make sure we use the included libintl, not the system's one. */
+# undef _LIBINTL_H
+# include "libgnuintl.h"
+#endif
+
+#include "read-file.h"
+
+/* The msgids, read from IDSFILE.  */
+static const char **singular_ids;
+static size_t n_singular;
+static const char **plural_ids;
+static const char **plural_ids2;
+static size_t n_plural;
+
+static const char *labels;
+static unsigned long iterations;
+
+/* Return the current time, in seconds.  */
+static double
+now (void)
+{
+#if defined CLOCK_MONOTONIC
+  struct timespec ts;
+
+  if (clock_gettime (CLOCK_MONOTONIC, &ts) == 0)
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+  {
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+}
+
+/* Read the msgids from FILENAME.  */
+static void
+read_ids (const char *filename)
+{
+  size_t length;
+  char *contents = read_file (filename, 0, &length);
+  char *line;
+  size_t n_lines;
+  size_t i;
+
+  if (contents == NULL)
+    {
+      fprintf (stderr, "bench-gettext: cannot read %s\n", filename);
+      exit (1);
+    }
+
+  n_lines = 0;
+  for (i = 0; i < length; i++)
+    if (contents[i] == '\n')
+      n_lines++;
+  singular_ids = (const char **) malloc ((n_lines + 1) * sizeof (char *));
+  plural_ids = (const char **) malloc ((n_lines + 1) * sizeof (char *));
+  plural_ids2 = (const char **) malloc ((n_lines + 1) * sizeof (char *));
+  if (singular_ids == NULL || plural_ids == NULL || plural_ids2 == NULL)
+    {
+      fprintf (stderr, "bench-gettext: memory exhausted\n");
+      exit (1);
+    }
+
+  n_singular = 0;
+  n_plural = 0;
+  for (line = contents; line < contents + length; )
+    {
+      char *end = strchr (line, '\n');
+      char *id = line + 2;
+
+      if (end == NULL)
+        break;
+      *end = '\0';
+      if (line[0] == 'S' && line[1] == '\t')
+        singular_ids[n_singular++] = id;
+      else if (line[0] == 'P' && line[1] == '\t')
+        {
+          char *tab = strchr (id, '\t');
+
+          if (tab != NULL)
+            {
+              *tab = '\0';
+              plural_ids[n_plural] = id;
+              plural_ids2[n_plural] = tab + 1;
+              n_plural++;
+            }
+        }
+      line = end + 1;
+    }
+  /* The contents stay allocated until the end of the program.  */
+
+  if (n_singular == 0 || n_plural == 0)
+    {
+      fprintf (stderr, "bench-gettext: %s has no singular or no plural msgids\n",
+               filename);
+      exit (1);
+    }
+}
+
+/* Arguments and results of one benchmark thread.  */
+struct thread_data
+{
+  size_t start;
+  unsigned long misses;
+};
+
+static void *
+gettext_loop (void *arg)
+{
+  struct thread_data *td = (struct thread_data *) arg;
+  size_t k = td->start % n_singular;
+  unsigned long i;
+
+  for (i = 0; i < iterations; i++)
+    {
+      const char *msgid = singular_ids[k];
+
+      if (gettext (msgid) == msgid)
+        td->misses++;
+      if (++k == n_singular)
+        k = 0;
+    }
+  return NULL;
+}
+
+static void *
+ngettext_loop (void *arg)
+{
+  struct thread_data *td = (struct thread_data *) arg;
+  size_t k = td->start % n_plural;
+  unsigned long i;
+
+  for (i = 0; i < iterations; i++)
+    {
+      const char *msgid = plural_ids[k];
+      const char *msgid_plural = plural_ids2[k];
+      const char *result = ngettext (msgid, msgid_plural, i % 32);
+
+      if (result == msgid || result == msgid_plural)
+        td->misses++;
+      if (++k == n_plural)
+        k = 0;
+    }
+  return NULL;
+}
+
+/* Run LOOP in NTHREADS threads, and print the time per lookup.  */
+static void
+run (const char *function, void * (*loop) (void *), unsigned int nthreads)
+{
+  struct thread_data *td =
+    (struct thread_data *) calloc (nthreads, sizeof (struct thread_data));
+  unsigned long misses;
+  double start_time;
+  double elapsed;
+  unsigned int t;
+
+  if (td == NULL)
+    {
+      fprintf (stderr, "bench-gettext: memory exhausted\n");
+      exit (1);
+    }
+  for (t = 0; t < nthreads; t++)
+    td[t].start = (size_t) t * 7919;
+
+  start_time = now ();
+#if USE_POSIX_THREADS
+  if (nthreads > 1)
+    {
+      pthread_t *threads =
+        (pthread_t *) malloc (nthreads * sizeof (pthread_t));
+
+      if (threads == NULL)
+        {
+          fprintf (stderr, "bench-gettext: memory exhausted\n");
+          exit (1);
+        }
+      for (t = 0; t < nthreads; t++)
+        if (pthread_create (&threads[t], NULL, loop, &td[t]) != 0)
+          {
+            fprintf (stderr, "bench-gettext: cannot create thread\n");
+            exit (1);
+          }
+      for (t = 0; t < nthreads; t++)
+        pthread_join (threads[t], NULL);
+      free (threads);
+    }
+  else
+#endif
+    loop (&td[0]);
+  elapsed = now () - start_time;
+
+  misses = 0;
+  for (t = 0; t < nthreads; t++)
+    misses += td[t].misses;
+  if (misses > 0)
+    {
+      fprintf (stderr, "bench-gettext: %lu lookups with %s found no translation\n",
+               misses, function);
+      exit (1);
+    }
+
+  /* Wall-clock time per lookup, as seen by one thread.  */
+  printf ("{ %s, \"bench\": \"lookup\", \"function\": \"%s\", \"threads\": %u, \"ns_per_op\": %.1f }\n",
+          labels, function, nthreads, elapsed * 1e9 / iterations);
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *locale_dir;
+  double start_time;
+  double load_time;
+  int i;
+
+  if (argc < 6)
+    {
+      fprintf (stderr,
+               "Usage: bench-gettext LABELS LOCALEDIR IDSFILE ITERATIONS THREADS...\n");
+      exit (1);
+    }
+  labels = argv[1];
+  locale_dir = argv[2];
+  read_ids (argv[3]);
+  iterations = strtoul (argv[4], NULL, 10);
+  if (iterations == 0)
+    iterations = 1;
+
+  /* libintl ignores LANGUAGE in the "C" locale.  Use a locale in which the
+     catalogs are looked up.  */
+  setlocale (LC_ALL, "");
+  {
+    const char *name = setlocale (LC_MESSAGES, NULL);
+
+    if (name == NULL || strcmp (name, "C") == 0 || strcmp (name, "POSIX") == 0)
+      if (setlocale (LC_ALL, "C.UTF-8") == NULL
+          && setlocale (LC_ALL, "C.utf8") == NULL
+          && setlocale (LC_ALL, "en_US.UTF-8") == NULL
+          && setlocale (LC_ALL, "en_US.utf8") == NULL)
+        {
+          fprintf (stderr, "bench-gettext: no suitable locale\n");
+          exit (77);
+        }
+  }
+
+  bindtextdomain ("bench", locale_dir);
+  bindtextdomain ("bench2", locale_dir);
+
+  /* The first lookup in the process loads the catalog, and initializes the
+     locale dependent state of libintl.  */
+  textdomain ("bench");
+  start_time = now ();
+  if (gettext (singular_ids[0]) == singular_ids[0])
+    {
+      fprintf (stderr, "bench-gettext: catalog not found\n");
+      exit (1);
+    }
+  load_time = now () - start_time;
+  printf ("{ %s, \"bench\": \"load\", \"kind\": \"cold\", \"us\": %.1f }\n",
+          labels, load_time * 1e6);
+
+  /* The first lookup in a second domain loads another catalog, with the
+     libintl state already initialized.  */
+  start_time = now ();
+  if (dgettext ("bench2", singular_ids[0]) == singular_ids[0])
+    {
+      fprintf (stderr, "bench-gettext: catalog not found\n");
+      exit (1);
+    }
+  load_time = now () - start_time;
+  printf ("{ %s, \"bench\": \"load\", \"kind\": \"warm\", \"us\": %.1f }\n",
+          labels, load_time * 1e6);
+
+  for (i = 5; i < argc; i++)
+    {
+      unsigned int nthreads = atoi (argv[i]);
+
+      if (nthreads == 0)
+        continue;
+#if !USE_POSIX_THREADS
+      if (nthreads > 1)
+        continue;
+#endif
+      run ("gettext", gettext_loop, nthreads);
+      run ("ngettext", ngettext_loop, nthreads);
+    }
+
+  return 0;
+}
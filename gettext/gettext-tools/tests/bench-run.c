@@ -0,0 +1,98 @@
+/* Measure the resources used by a program, used by "make bench".
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Usage: bench-run LABELS PROGRAM [ARGUMENT...]
+
+   Executes PROGRAM with the given arguments, and writes its wall-clock
+   time, CPU time and peak resident set size to standard output, as a JSON
+   object that starts with the LABELS.  The exit status is that of
+   PROGRAM.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int
+main (int argc, char *argv[])
+{
+  struct timeval start_time;
+  struct timeval end_time;
+  struct rusage usage;
+  pid_t child;
+  int status;
+  long maxrss_kb;
+
+  if (argc < 3)
+    {
+      fprintf (stderr, "Usage: bench-run LABELS PROGRAM [ARGUMENT...]\n");
+      exit (1);
+    }
+
+  gettimeofday (&start_time, NULL);
+  child = fork ();
+  if (child < 0)
+    {
+      fprintf (stderr, "bench-run: fork failed: %s\n", strerror (errno));
+      exit (1);
+    }
+  if (child == 0)
+    {
+      execvp (argv[2], argv + 2);
+      fprintf (stderr, "bench-run: cannot execute %s: %s\n",
+               argv[2], strerror (errno));
+      _exit (127);
+    }
+  if (wait4 (child, &status, 0, &usage) != child)
+    {
+      fprintf (stderr, "bench-run: wait4 failed: %s\n", strerror (errno));
+      exit (1);
+    }
+  gettimeofday (&end_time, NULL);
+
+  if (!WIFEXITED (status))
+    {
+      fprintf (stderr, "bench-run: %s terminated abnormally\n", argv[2]);
+      exit (1);
+    }
+  if (WEXITSTATUS (status) != 0)
+    exit (WEXITSTATUS (status));
+
+#if defined __APPLE__ && defined __MACH__
+  /* On macOS, ru_maxrss is in bytes, not in kilobytes.  */
+  maxrss_kb = usage.ru_maxrss / 1024;
+#else
+  maxrss_kb = usage.ru_maxrss;
+#endif
+
+  printf ("{ %s, \"wall_s\": %.3f, \"user_s\": %.3f, \"sys_s\": %.3f, \"maxrss_kb\": %ld }\n",
+          argv[1],
+          (end_time.tv_sec - start_time.tv_sec)
+          + (end_time.tv_usec - start_time.tv_usec) * 1e-6,
+          usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6,
+          usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6,
+          maxrss_kb);
+
+  return 0;
+}
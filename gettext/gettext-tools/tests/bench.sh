@@ -0,0 +1,133 @@
+#! /bin/sh
+. "${srcdir=.}/init.sh"; path_prepend_ . ../src
+
+# Benchmarks, run by "make bench".  Not part of "make check".
+#
+# For each catalog size in $BENCH_SIZES, generates a synthetic catalog and
+# measures
+#   - the lookup time of gettext and ngettext, for each number of threads in
+#     $BENCH_THREADS, and the time of the first lookup (which loads the
+#     catalog),
+#   - the wall-clock time, CPU time and peak RSS of msgfmt, msgunfmt, msgcat,
+#     xgettext and msgmerge.
+# The results are written to standard output in JSON format.
+#
+# The catalogs have msgids of varying lengths, half of them with plural forms
+# (with 3 plural forms), and exist in UTF-8 and in ISO-8859-1.  10% of the
+# msgids in the POT file passed to msgmerge are modified.  msgmerge with fuzzy
+# matching is only run for sizes up to $BENCH_FUZZY_MAX.
+
+: ${BENCH_SIZES='10000 100000 2000000'}
+: ${BENCH_THREADS='1 2 4 8'}
+: ${BENCH_ITERATIONS=1000000}
+: ${BENCH_FUZZY_MAX=10000}
+
+: ${MSGFMT=msgfmt}
+: ${MSGUNFMT=msgunfmt}
+: ${MSGCAT=msgcat}
+: ${MSGCONV=msgconv}
+: ${MSGMERGE=msgmerge}
+: ${XGETTEXT=xgettext}
+
+# gen_catalog SIZE
+# creates bench.po, bench.ids (the msgids, for bench-gettext) and prog.c
+# (the source of the POT file for msgmerge).
+gen_catalog ()
+{
+  ${AWK-awk} -v n="$1" '
+    BEGIN {
+      lorem = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor incididunt ut labore et dolore magna aliqua ut enim ad minim veniam quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat"
+      po = "bench.po"; ids = "bench.ids"; src = "prog.c"
+      print "msgid \"\"" > po
+      print "msgstr \"\"" > po
+      print "\"Content-Type: text/plain; charset=UTF-8\\n\"" > po
+      print "\"Plural-Forms: nplurals=3; plural=(n==1 ? 0 : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1 : 2);\\n\"" > po
+      print "" > po
+      print "void f (int n)" > src
+      print "{" > src
+      for (i = 0; i < n; i++) {
+        # msgids of 10 to 200 characters.
+        filler = substr (lorem, 1, (i * 7919) % 190)
+        changed = (i % 10 == 5 ? " (new)" : "")
+        if (i % 2) {
+          id = "%d file " i " " filler
+          idp = "%d files " i " " filler
+          print "msgid \"" id "\"" > po
+          print "msgid_plural \"" idp "\"" > po
+          print "msgstr[0] \"%d Datei " i " \303\244 " filler "\"" > po
+          print "msgstr[1] \"%d Dateien " i " \303\266 " filler "\"" > po
+          print "msgstr[2] \"%d Dateien " i " \303\274 " filler "\"" > po
+          print "P\t" id "\t" idp > ids
+          print "  ngettext (\"" id changed "\", \"" idp changed "\", n);" > src
+        } else {
+          id = "Message " i " " filler
+          print "msgid \"" id "\"" > po
+          print "msgstr \"Nachricht " i " \303\251 " filler "\"" > po
+          print "S\t" id > ids
+          print "  gettext (\"" id changed "\");" > src
+        }
+        print "" > po
+      }
+      print "}" > src
+    }' </dev/null
+}
+
+# run LABELS PROGRAM [ARGUMENT...]
+# measures a program and appends the result to results.json.
+run ()
+{
+  ../bench-run "$@" >> results.json || Exit 1
+}
+
+: > results.json
+for size in $BENCH_SIZES; do
+  rm -rf loc
+  gen_catalog $size || Exit 1
+  ${MSGCONV} -t ISO-8859-1 -o bench-latin1.po bench.po || Exit 1
+
+  labels="\"size\": $size"
+
+  run "$labels, \"tool\": \"msgfmt\", \"charset\": \"UTF-8\"" \
+    ${MSGFMT} -o bench.mo bench.po
+  run "$labels, \"tool\": \"msgfmt\", \"charset\": \"ISO-8859-1\"" \
+    ${MSGFMT} -o bench-latin1.mo bench-latin1.po
+  run "$labels, \"tool\": \"msgunfmt\"" \
+    ${MSGUNFMT} -o out.po bench.mo
+  run "$labels, \"tool\": \"msgcat\"" \
+    ${MSGCAT} -o out.po bench.po bench-latin1.po
+  run "$labels, \"tool\": \"xgettext\"" \
+    ${XGETTEXT} --omit-header -o ref.pot prog.c
+  run "$labels, \"tool\": \"msgmerge\", \"compendium\": false, \"fuzzy\": false" \
+    ${MSGMERGE} -q --no-fuzzy-matching -o out.po bench.po ref.pot
+  run "$labels, \"tool\": \"msgmerge\", \"compendium\": true, \"fuzzy\": false" \
+    ${MSGMERGE} -q --no-fuzzy-matching --compendium=bench-latin1.po -o out.po \
+      /dev/null ref.pot
+  if test $size -le $BENCH_FUZZY_MAX; then
+    run "$labels, \"tool\": \"msgmerge\", \"compendium\": false, \"fuzzy\": true" \
+      ${MSGMERGE} -q -o out.po bench.po ref.pot
+    run "$labels, \"tool\": \"msgmerge\", \"compendium\": true, \"fuzzy\": true" \
+      ${MSGMERGE} -q --compendium=bench-latin1.po -o out.po /dev/null ref.pot
+  fi
+
+  # Lookups in the included libintl.
+  mkdir loc loc/bench loc/bench/LC_MESSAGES
+  cp bench.mo loc/bench/LC_MESSAGES/bench.mo
+  cp bench.mo loc/bench/LC_MESSAGES/bench2.mo
+  LANGUAGE=bench \
+  ../bench-gettext "$labels" loc bench.ids $BENCH_ITERATIONS $BENCH_THREADS \
+    >> results.json
+  case $? in
+    0 | 77) ;;
+    *) Exit 1 ;;
+  esac
+done
+
+version=`${MSGFMT} --version | sed -n -e '1s/^.* //p'`
+echo '{'
+echo "  \"version\": \"$version\","
+echo '  "results": ['
+sed -e 's/^/    /' -e '$!s/$/,/' results.json
+echo '  ]'
+echo '}'
+
+Exit 0
@@ -417,6 +417,85 @@ main (int argc, char *argv[])
     po_file_free (file);
   }
 
+  /* Test po_file_read_readonly.  */
+  {
+    po_file_t file =
+      po_file_read_readonly ("/nonexist/ent", &my_xerror_handler);
+    ASSERT (file == NULL);
+  }
+
+  {
+    po_file_t file =
+      po_file_read_readonly (input_filename, &my_xerror_handler);
+    po_message_iterator_t iter;
+    po_message_t msg;
+
+    ASSERT (file != NULL);
+    ASSERT (po_file_write (file, "gtpo-1-readonly.po", &my_xerror_handler)
+            == file);
+
+    /* Test po_file_make_mutable.  */
+    po_file_make_mutable (file);
+    iter = po_message_iterator (file, NULL);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    po_message_set_msgstr (msg, "Ah, ich bin gekommen");
+    ASSERT (strcmp (po_message_msgstr (msg), "Ah, ich bin gekommen") == 0);
+    po_message_iterator_free (iter);
+
+    po_file_free (file);
+  }
+
+  {
+    po_file_t file =
+      po_file_read_readonly (input_filename, &my_xerror_handler);
+    po_file_t other =
+      po_file_read_readonly (input_filename, &my_xerror_handler);
+    po_message_iterator_t iter;
+    po_message_t msg;
+    const char *msgid;
+
+    ASSERT (file != NULL);
+    ASSERT (other != NULL);
+
+    /* Test that the setters work without po_file_make_mutable, also when
+       their argument points into the file's contents.  */
+    iter = po_message_iterator (file, NULL);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    msgid = po_message_msgid (msg);
+    po_message_set_msgstr (msg, msgid);
+    ASSERT (strcmp (po_message_msgstr (msg), "cannot restore fd %d: dup2 failed") == 0);
+    po_message_set_msgid (msg, msgid);
+    ASSERT (strcmp (po_message_msgid (msg), "cannot restore fd %d: dup2 failed") == 0);
+    po_message_set_comments (msg, "A comment.\n");
+    ASSERT (strcmp (po_message_comments (msg), "A comment.\n") == 0);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    po_message_set_msgstr (msg, "");
+    ASSERT (strcmp (po_message_msgstr (msg), "") == 0);
+    po_message_iterator_free (iter);
+
+    /* Test that modifying the messages of one file leaves the messages of
+       another file read-only, and that they can be modified later.  */
+    iter = po_message_iterator (other, NULL);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    msg = po_next_message (iter);
+    ASSERT (msg != NULL);
+    ASSERT (strcmp (po_message_comments (msg), "A comment.\n") != 0);
+    po_file_free (file);
+    po_message_set_comments (msg, "Another comment.\n");
+    ASSERT (strcmp (po_message_comments (msg), "Another comment.\n") == 0);
+    po_message_iterator_free (iter);
+
+    po_file_free (other);
+  }
+
   /* Test po_file_create.  */
   {
     po_file_t file = po_file_create ();
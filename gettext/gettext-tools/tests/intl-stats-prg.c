@@ -0,0 +1,105 @@
+/* Test program, used by the intl-stats test.
+   Copyright (C) 2020 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#if USE_POSIX_THREADS
+# include <pthread.h>
+#endif
+
+#include "xsetenv.h"
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#if USE_POSIX_THREADS
+/* Number of threads that look up a message and terminate.  */
+# define THREADS 20
+
+static void *
+thread_execution (void *arg)
+{
+  gettext ("cheese");
+  return NULL;
+}
+#endif
+
+int
+main (int argc, char *argv[])
+{
+  const char *dir = argv[1];
+  const char *locale = argv[2];
+  struct libintl_stats stats;
+  int i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("OUTPUT_CHARSET");
+
+  textdomain ("tstprog");
+
+  xsetenv ("LC_ALL", locale, 1);
+  if (setlocale (LC_ALL, "") == NULL)
+    setlocale (LC_ALL, "C");
+
+  bindtextdomain ("tstprog", dir);
+
+  /* The first lookup loads the catalog.  The other ones are answered from
+     the cache of known translations.  */
+  for (i = 0; i < 3; i++)
+    printf ("%s\n", gettext ("cheese"));
+
+  if (libintl_get_stats (&stats))
+    {
+#if USE_POSIX_THREADS
+      /* The lookups of the threads that have terminated stay in the
+         totals.  */
+      unsigned long int cache_hits = stats.cache_hits;
+
+      for (i = 0; i < THREADS; i++)
+        {
+          pthread_t thread;
+
+          if (pthread_create (&thread, NULL, &thread_execution, NULL)
+              || pthread_join (thread, NULL))
+            abort ();
+        }
+      libintl_get_stats (&stats);
+      if (stats.cache_hits != cache_hits + THREADS)
+        printf ("threads added %lu cache hits\n",
+                stats.cache_hits - cache_hits);
+      stats.cache_hits = cache_hits;
+#endif
+      printf ("cache_hits %lu\n", stats.cache_hits);
+      printf ("cache_misses %lu\n", stats.cache_misses);
+      printf ("catalogs_loaded %lu\n", stats.catalogs_loaded);
+      if (stats.catalog_bytes == 0)
+        printf ("catalog_bytes is 0\n");
+      if (stats.catalog_searches < stats.cache_misses)
+        printf ("catalog_searches is %lu\n", stats.catalog_searches);
+      if (stats.catalog_candidates < stats.catalogs_loaded)
+        printf ("catalog_candidates is %lu\n", stats.catalog_candidates);
+    }
+  else
+    printf ("statistics are not collected\n");
+
+  return 0;
+}
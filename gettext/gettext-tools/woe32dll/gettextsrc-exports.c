@@ -85,4 +85,5 @@ VARIABLE(po_multiline_warning)
 VARIABLE(po_xerror)
 VARIABLE(po_xerror2)
 VARIABLE(syntax_check_name)
+VARIABLE(time_report_enabled)
 VARIABLE(use_first)